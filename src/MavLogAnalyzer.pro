@@ -19,6 +19,10 @@
 # adjust the path to the MavLink headers. You can get them from https://github.com/mavlink/mavlink
 MAVLINK_COMMON=$$_PRO_FILE_PWD_/../external/mavlink/gen/common
 #message("MavLink headers expected at" $$MAVLINK_COMMON)
+# the XML which the MavLink headers were generated from; all its messages get a decoder
+MAVLINK_XML=$$_PRO_FILE_PWD_/../external/mavlink/message_definitions/v1.0/common.xml
+# the interpreter which generates the decoders from it; override with qmake PYTHON=...
+isEmpty(PYTHON): PYTHON=python3
 
 # adjust the path to Qwt installation here, if necessary
 unix {
@@ -54,6 +58,9 @@ TEMPLATE = app
 !exists($$MAVLINK_COMMON/mavlink.h) {
 	error("MavLink files not found. Please configure project file correctly.")
 }
+!exists($$MAVLINK_XML) {
+	warning("MavLink message definitions not found. Building without the generated decoders.")
+}
 !exists($$QWT_INCPATH/qwt_plot_seriesitem.h) {
 	error("Qwt files not found. Please configure project file correctly.") 	
 }
@@ -74,6 +81,8 @@ QMAKE_CXXFLAGS_DEBUG += -O0
 #QMAKE_CXXFLAGS_DEBUG += -pg -p
 #QMAKE_LFLAGS_DEBUG += -pg
 #QMAKE_CXXFLAGS += -Werror
+# 64bit file offsets (ftello, stat) also on 32bit systems, for logs over 2GB
+unix: DEFINES += _FILE_OFFSET_BITS=64
 RESOURCES=app.qrc
 LIBS+= -lqwt # -lcsv_parser now "inline"
 
@@ -89,6 +98,8 @@ SOURCES += main.cpp\
     datatreeviewmodel.cpp \
     treeitem.cpp \
     mavplot.cpp \
+    mavplotcurve.cpp \
+    mavplotevents.cpp \
     filefun.cpp \
     dialogdatadetails.cpp \
     time_fun.cpp \
@@ -109,11 +120,32 @@ SOURCES += main.cpp\
     onboardlogparser_px4.cpp \
     onboardlogparser.cpp \
     onboardlogparser_ulg.cpp \
-    onboardlogparserfactory.cpp
+    onboardlogparser_bin.cpp \
+    onboardlogparserfactory.cpp \
+    bytesource.cpp \
+    benchmark.cpp \
+    mavlinkchunkedparser.cpp \
+    mavlinkindex.cpp \
+    onboardcolumns.cpp \
+    texttokenizer.cpp \
+    mavlinkdecoders.cpp \
+    fileloader.cpp
 
-# add CSV parser
+# CSV parser; only the baseline in the benchmark
 SOURCES += csv_parser/csv_parser.cpp
 
+# decoders for all MavLink messages, see mavlinkdecoders.h
+exists($$MAVLINK_XML) {
+	mavdecoders.input = MAVLINK_XML
+	mavdecoders.output = mavlinkdecoders_gen.cpp
+	mavdecoders.commands = $$PYTHON $$_PRO_FILE_PWD_/mavlink_gen_decoders.py ${QMAKE_FILE_IN} ${QMAKE_FILE_OUT}
+	mavdecoders.depends = $$_PRO_FILE_PWD_/mavlink_gen_decoders.py
+	mavdecoders.variable_out = SOURCES
+	QMAKE_EXTRA_COMPILERS += mavdecoders
+} else {
+	DEFINES += WITHOUT_GENERATED_DECODERS
+}
+
 HEADERS  += mainwindow.h \
     cmdlineargs.h \
     mavlinkparser.h \
@@ -126,6 +158,8 @@ HEADERS  += mainwindow.h \
     datatreeviewmodel.h \
     treeitem.h \
     mavplot.h \
+    mavplotcurve.h \
+    mavplotevents.h \
     Zoomer.h \
     Panner.h \
     data_event.h \
@@ -157,10 +191,23 @@ HEADERS  += mainwindow.h \
     data_untimed.h \
     onboardlogparserfactory.h \
     onboardlogparser.h \
-    onboardlogparser_ulg.h
+    onboardlogparser_ulg.h \
+    onboardlogparser_bin.h \
+    bytesource.h \
+    benchmark.h \
+    mavlinkchunkedparser.h \
+    mavlinkindex.h \
+    onboardcolumns.h \
+    texttokenizer.h \
+    mavlinkdecoders.h \
+    fileloader.h \
+    segmentedvector.h \
+    resampler.h \
+    summarypyramid.h
 
 FORMS    += mainwindow.ui \
 	filterwindow.ui
 
 OTHER_FILES += \
-    darkorange.stylesheet
+    darkorange.stylesheet \
+    mavlink_gen_decoders.py
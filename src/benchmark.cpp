@@ -0,0 +1,1563 @@
+/**
+ * @file benchmark.cpp
+ * @brief Headless throughput measurements of the parsers and data
+ * structures, invoked with --benchmark.
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sstream>
+#include <algorithm>
+#include "benchmark.h"
+#include "mavlinkparser.h"
+#include "mavlinkchunkedparser.h"
+#include "mavlinkdecoders.h"
+#include "onboardlogparser_ulg.h"
+#include "onboardlogparser_px4.h"
+#include "onboardlogparser_apm.h"
+#include "data_timeseries.h"
+#include "data_event.h"
+#include "resampler.h"
+#include <csv_parser/csv_parser.hpp>
+#include "bytesource.h"
+#include "filefun.h"
+#include "time_fun.h"
+
+using namespace std;
+
+Benchmark::Benchmark(const CmdlineArgs *args) : _args(args) {}
+
+Benchmark::~Benchmark() {
+    for (vector<string>::const_iterator it = _tmpfiles.begin(); it != _tmpfiles.end(); ++it) {
+        remove(it->c_str());
+    }
+}
+
+int Benchmark::run() {
+    const string & what = _args->benchmark;
+    const bool all = (what == "all");
+    bool ok = true;
+    bool known = false;
+
+    if (all || what == "tlog") {
+        known = true;
+        ok &= _bench_tlog();
+    }
+    if (all || what == "tlog-parallel") {
+        known = true;
+        ok &= _bench_tlog_parallel();
+    }
+
+    if (all || what == "ulog") {
+        known = true;
+        ok &= _bench_ulog();
+    }
+
+    if (all || what == "px4log") {
+        known = true;
+        ok &= _bench_px4log();
+    }
+
+    if (all || what == "apmlog") {
+        known = true;
+        ok &= _bench_apmlog();
+    }
+
+    if (all || what == "ingest") {
+        known = true;
+        ok &= _bench_ingest();
+    }
+
+    if (all || what == "mavlink-decode") {
+        known = true;
+        ok &= _bench_mavlink_decode();
+    }
+
+    if (all || what == "merge") {
+        known = true;
+        ok &= _bench_merge();
+    }
+
+    if (all || what == "merge-series") {
+        known = true;
+        ok &= _bench_merge_series();
+    }
+
+    if (all || what == "resample") {
+        known = true;
+        ok &= _bench_resample();
+    }
+
+    if (all || what == "stats-window") {
+        known = true;
+        ok &= _bench_stats_window();
+    }
+
+    if (all || what == "plot-lod") {
+        known = true;
+        ok &= _bench_plot_lod();
+    }
+
+    if (!known) {
+        fprintf(stderr, "Unknown benchmark: %s\n", what.c_str());
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
+
+void Benchmark::_report_header(const std::string &title) const {
+    printf("\n%s\n", title.c_str());
+    printf("  %-28s %10s %9s %11s %12s\n", "variant", "MB", "sec", "MB/s", "items");
+}
+
+void Benchmark::_report(const result_t &r) const {
+    const double mb = r.bytes / (1024.*1024.);
+    const double rate = r.sec > 0. ? mb / r.sec : 0.;
+    printf("  %-28s %10.1f %9.2f %11.1f %12lu\n", r.name.c_str(), mb, r.sec, rate, r.items);
+    fflush(stdout);
+}
+
+std::string Benchmark::_tmpfile(const std::string &ext) {
+    const char*tmpdir = getenv("TMPDIR");
+#if defined(WIN32) || defined(__WIN32) || defined(__WIN32__)
+    if (!tmpdir) tmpdir = getenv("TEMP");
+    if (!tmpdir) tmpdir = ".";
+#else
+    if (!tmpdir) tmpdir = "/tmp";
+#endif
+    stringstream fname_ss;
+    fname_ss << tmpdir << "/mavloganalyzer_benchmark" << _tmpfiles.size() << "." << ext;
+    const string fname = fname_ss.str();
+    _tmpfiles.push_back(fname);
+    return fname;
+}
+
+std::string Benchmark::_get_input(const std::string &ext, unsigned int max_mb) {
+    for (list<string>::const_iterator it = _args->filenames.begin(); it != _args->filenames.end(); ++it) {
+        string e = getExtension(*it);
+        if (lcase(e) == ext) return *it;
+    }
+
+    // nothing given -> make one up
+    string fname = _tmpfile(ext);
+    unsigned int size_mb = _args->benchmark_size_mb;
+    if (max_mb > 0 && size_mb > max_mb) size_mb = max_mb;
+    const uint64_t nbytes = ((uint64_t)size_mb) * 1024 * 1024;
+    printf("Synthesizing %u MB of %s data in %s...\n", size_mb, ext.c_str(), fname.c_str());
+    fflush(stdout);
+    bool ok = false;
+    if (ext == "tlog") {
+        ok = _synthesize_tlog(fname, nbytes);
+    } else if (ext == "ulg") {
+        ok = _synthesize_ulog(fname, nbytes);
+    } else if (ext == "px4log") {
+        ok = _synthesize_px4log(fname, nbytes);
+    } else if (ext == "log") {
+        ok = _synthesize_apmlog(fname, nbytes);
+    }
+    if (!ok) {
+        fprintf(stderr, "ERROR: could not write %s\n", fname.c_str());
+        return "";
+    }
+    return fname;
+}
+
+/**
+ * @brief writes a telemetry log as the GCSs do: each message is preceded
+ * by a big-endian 64bit timestamp in usec. Contents resemble a vehicle sending
+ * attitude at 100Hz, HUD at 10Hz and heartbeat+system time at 1Hz.
+ */
+bool Benchmark::_synthesize_tlog(const std::string &filename, uint64_t nbytes) {
+    FILE*fp = fopen(filename.c_str(), "wb");
+    if (!fp) return false;
+
+    const size_t BUFLEN = 1024*1024;
+    vector<uint8_t> buf(BUFLEN);
+    size_t fill = 0;
+    uint64_t written = 0;
+    mavlink_message_t msg;
+    const uint64_t t0_usec = 1500000000ULL * 1000000ULL;
+
+    for (unsigned long tick = 0; written < nbytes; ++tick) {
+        const uint32_t t_ms = tick * 10;
+        const uint64_t t_usec = t0_usec + ((uint64_t)t_ms) * 1000;
+        const float phase = t_ms / 1000.f;
+
+        for (int k=0; k < 4; ++k) {
+            switch (k) {
+            case 0:
+                mavlink_msg_attitude_pack(1, 1, &msg, t_ms, sinf(phase), cosf(phase), phase, 0.1f, 0.2f, 0.3f);
+                break;
+            case 1:
+                if (tick % 10) continue;
+                mavlink_msg_vfr_hud_pack(1, 1, &msg, 12.f, 11.f, (int16_t)(t_ms % 360), 50, 100.f + sinf(phase), 0.5f);
+                break;
+            case 2:
+                if (tick % 100) continue;
+                mavlink_msg_heartbeat_pack(1, 1, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_ARDUPILOTMEGA, MAV_MODE_FLAG_SAFETY_ARMED, 0, MAV_STATE_ACTIVE);
+                break;
+            case 3:
+                if (tick % 100) continue;
+                mavlink_msg_system_time_pack(1, 1, &msg, t_usec, t_ms);
+                break;
+            }
+            if (fill + 8 + MAVLINK_MAX_PACKET_LEN > BUFLEN) {
+                if (fwrite(&buf[0], 1, fill, fp) != fill) {
+                    fclose(fp);
+                    return false;
+                }
+                written += fill;
+                fill = 0;
+            }
+            for (int b=0; b < 8; ++b) {
+                buf[fill++] = (uint8_t)(t_usec >> (8*(7-b)));
+            }
+            fill += mavlink_msg_to_send_buffer(&buf[fill], &msg);
+        }
+    }
+    if (fill > 0) {
+        fwrite(&buf[0], 1, fill, fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+static void put_ulog_msg(std::vector<uint8_t> &buf, char type, const void*payload, uint16_t len) {
+    buf.push_back((uint8_t)(len & 0xFF));
+    buf.push_back((uint8_t)(len >> 8));
+    buf.push_back((uint8_t)type);
+    const uint8_t*p = (const uint8_t*)payload;
+    buf.insert(buf.end(), p, p + len);
+}
+
+static void put_ulog_str(std::vector<uint8_t> &buf, char type, const std::string &str) {
+    put_ulog_msg(buf, type, str.data(), (uint16_t)str.size());
+}
+
+template <typename T>
+static void put_le(std::vector<uint8_t> &buf, T val) {
+    uint8_t b[sizeof(T)];
+    memcpy(b, &val, sizeof(T)); // ULog is little endian, and so are we
+    buf.insert(buf.end(), b, b + sizeof(T));
+}
+
+/**
+ * @brief writes a ULog as PX4 does. Contents resemble a vehicle logging sensors at 250Hz,
+ * attitude at 100Hz, and GPS with UTC time at 10Hz.
+ */
+bool Benchmark::_synthesize_ulog(const std::string &filename, uint64_t nbytes) {
+    FILE*fp = fopen(filename.c_str(), "wb");
+    if (!fp) return false;
+
+    vector<uint8_t> buf;
+    buf.reserve(1024*1024 + 1024);
+
+    // header, flags and definitions
+    const uint8_t magic[] = {'U','L','o','g',0x01,0x12,0x35,0x01};
+    buf.insert(buf.end(), magic, magic + sizeof(magic));
+    put_le<uint64_t>(buf, 0);
+    const uint8_t flags[40] = {0};
+    put_ulog_msg(buf, 'B', flags, sizeof(flags));
+    put_ulog_str(buf, 'F', "sensor_combined:uint64_t timestamp;float[3] gyro_rad;uint32_t gyro_integral_dt;"
+                           "int32_t accelerometer_timestamp_relative;float[3] accelerometer_m_s2;"
+                           "uint32_t accelerometer_integral_dt;uint8_t accelerometer_clipping;uint8_t[7] _padding0;");
+    put_ulog_str(buf, 'F', "vehicle_attitude:uint64_t timestamp;float rollspeed;float pitchspeed;float yawspeed;float[4] q;");
+    put_ulog_str(buf, 'F', "vehicle_gps_position:uint64_t timestamp;uint64_t time_utc_usec;int32_t lat;int32_t lon;"
+                           "int32_t alt;float eph;float epv;float vel_m_s;uint8_t fix_type;uint8_t satellites_used;uint8_t[6] _padding0;");
+    const char*const topics[] = {"sensor_combined", "vehicle_attitude", "vehicle_gps_position"};
+    for (uint16_t k=0; k < 3; ++k) {
+        vector<uint8_t> p;
+        p.push_back(0);
+        put_le<uint16_t>(p, k);
+        p.insert(p.end(), topics[k], topics[k] + strlen(topics[k]));
+        put_ulog_msg(buf, 'A', &p[0], (uint16_t)p.size());
+    }
+
+    // data; trailing padding is not logged
+    uint64_t written = 0;
+    const uint64_t t0_utc_usec = 1500000000ULL * 1000000ULL;
+    vector<uint8_t> p;
+    for (unsigned long tick = 0; written + buf.size() < nbytes; ++tick) {
+        const uint64_t t_usec = 1000000ULL + tick * 4000ULL;
+        const float phase = t_usec / 1E6f;
+
+        p.clear();
+        put_le<uint16_t>(p, 0);
+        put_le<uint64_t>(p, t_usec);
+        for (int j=0; j < 3; ++j) put_le<float>(p, sinf(phase + j));
+        put_le<uint32_t>(p, 4000);
+        put_le<int32_t>(p, -12);
+        for (int j=0; j < 3; ++j) put_le<float>(p, cosf(phase + j));
+        put_le<uint32_t>(p, 4000);
+        p.push_back(0);
+        put_ulog_msg(buf, 'D', &p[0], (uint16_t)p.size());
+
+        if (0 == tick % 2) {
+            p.clear();
+            put_le<uint16_t>(p, 1);
+            put_le<uint64_t>(p, t_usec);
+            for (int j=0; j < 3; ++j) put_le<float>(p, 0.1f*sinf(phase*j));
+            for (int j=0; j < 4; ++j) put_le<float>(p, 0.5f);
+            put_ulog_msg(buf, 'D', &p[0], (uint16_t)p.size());
+        }
+        if (0 == tick % 25) {
+            p.clear();
+            put_le<uint16_t>(p, 2);
+            put_le<uint64_t>(p, t_usec);
+            put_le<uint64_t>(p, t0_utc_usec + t_usec);
+            put_le<int32_t>(p, 481234567 + (int32_t)(tick / 25));
+            put_le<int32_t>(p, 115678901);
+            put_le<int32_t>(p, 500000);
+            put_le<float>(p, 0.8f);
+            put_le<float>(p, 1.2f);
+            put_le<float>(p, 3.f);
+            p.push_back(3);
+            p.push_back(12);
+            put_ulog_msg(buf, 'D', &p[0], (uint16_t)p.size());
+        }
+
+        if (buf.size() >= 1024*1024) {
+            if (fwrite(&buf[0], 1, buf.size(), fp) != buf.size()) {
+                fclose(fp);
+                return false;
+            }
+            written += buf.size();
+            buf.clear();
+        }
+    }
+    if (!buf.empty()) {
+        fwrite(&buf[0], 1, buf.size(), fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+static void put_px4_fmt(std::vector<uint8_t> &buf, uint8_t type, const char*name, const char*format, const char*labels) {
+    const uint8_t head[] = {0xA3, 0x95, 0x80};
+    buf.insert(buf.end(), head, head + sizeof(head));
+    const size_t pos = buf.size();
+    buf.resize(pos + 2 + 4 + 16 + 64, 0);
+    buf[pos] = type;
+    // length is the header plus all fields
+    unsigned int len = 3;
+    for (const char*c = format; *c; ++c) {
+        switch (*c) {
+        case 'b': case 'B': case 'M': len += 1; break;
+        case 'h': case 'H': case 'c': case 'C': len += 2; break;
+        case 'q': case 'Q': len += 8; break;
+        case 'n': len += 4; break;
+        case 'N': len += 16; break;
+        case 'Z': len += 64; break;
+        default: len += 4; break;
+        }
+    }
+    buf[pos + 1] = (uint8_t) len;
+    memcpy(&buf[pos + 2], name, std::min<size_t>(strlen(name), 4));
+    memcpy(&buf[pos + 6], format, std::min<size_t>(strlen(format), 16));
+    memcpy(&buf[pos + 22], labels, std::min<size_t>(strlen(labels), 64));
+}
+
+static void put_px4_head(std::vector<uint8_t> &buf, uint8_t type) {
+    const uint8_t head[] = {0xA3, 0x95, type};
+    buf.insert(buf.end(), head, head + sizeof(head));
+}
+
+/**
+ * @brief writes a px4log as sdlog2 does. Contents resemble a vehicle logging IMU at 250Hz,
+ * attitude at 100Hz, GPS at 10Hz and the time at 1Hz.
+ */
+bool Benchmark::_synthesize_px4log(const std::string &filename, uint64_t nbytes) {
+    FILE*fp = fopen(filename.c_str(), "wb");
+    if (!fp) return false;
+
+    vector<uint8_t> buf;
+    buf.reserve(1024*1024 + 1024);
+    put_px4_fmt(buf, 0x80, "FMT", "BBnNZ", "Type,Length,Name,Format,Labels");
+    put_px4_fmt(buf, 129, "TIME", "Q", "StartTime");
+    put_px4_fmt(buf, 130, "ATT", "fffffffff", "qw,qx,qy,qz,Roll,Pitch,Yaw,RollRate,PitchRate");
+    put_px4_fmt(buf, 131, "IMU", "fffffffff", "AccX,AccY,AccZ,GyroX,GyroY,GyroZ,MagX,MagY,MagZ");
+    put_px4_fmt(buf, 132, "GPS", "QBffLLfffffBHHH", "GPSTime,Fix,EPH,EPV,Lat,Lon,Alt,VelN,VelE,VelD,Cog,nSat,SNR,N,J");
+    put_px4_fmt(buf, 133, "VER", "NZ", "Arch,FwGit");
+    put_px4_head(buf, 133);
+    const size_t pos = buf.size();
+    buf.resize(pos + 16 + 64, 0);
+    memcpy(&buf[pos], "PX4FMU_V2", 9);
+    memcpy(&buf[pos + 16], "0123456789abcdef", 16);
+
+    uint64_t written = 0;
+    const uint64_t t0_usec = 1500000000ULL * 1000000ULL;
+    for (unsigned long tick = 0; written + buf.size() < nbytes; ++tick) {
+        const uint64_t t_usec = tick * 4000ULL;
+        const float phase = t_usec / 1E6f;
+
+        put_px4_head(buf, 131);
+        for (int j=0; j < 9; ++j) put_le<float>(buf, sinf(phase + j));
+
+        if (0 == tick % 2) {
+            put_px4_head(buf, 130);
+            for (int j=0; j < 9; ++j) put_le<float>(buf, 0.1f*cosf(phase*j));
+        }
+        if (0 == tick % 25) {
+            put_px4_head(buf, 132);
+            put_le<uint64_t>(buf, t0_usec + t_usec);
+            buf.push_back(3);
+            put_le<float>(buf, 0.8f);
+            put_le<float>(buf, 1.2f);
+            put_le<int32_t>(buf, 481234567 + (int32_t)(tick / 25));
+            put_le<int32_t>(buf, 115678901);
+            for (int j=0; j < 5; ++j) put_le<float>(buf, (float) j);
+            buf.push_back(12);
+            put_le<uint16_t>(buf, 40);
+            put_le<uint16_t>(buf, 0);
+            put_le<uint16_t>(buf, 0);
+        }
+        if (0 == tick % 250) {
+            put_px4_head(buf, 129);
+            put_le<uint64_t>(buf, t_usec);
+        }
+
+        if (buf.size() >= 1024*1024) {
+            if (fwrite(&buf[0], 1, buf.size(), fp) != buf.size()) {
+                fclose(fp);
+                return false;
+            }
+            written += buf.size();
+            buf.clear();
+        }
+    }
+    if (!buf.empty()) {
+        fwrite(&buf[0], 1, buf.size(), fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+/**
+ * @brief writes a text log as MissionPlanner does when it converts a dataflash log. Contents
+ * resemble a copter logging IMU and attitude at 50Hz and GPS at 5Hz.
+ */
+bool Benchmark::_synthesize_apmlog(const std::string &filename, uint64_t nbytes) {
+    FILE*fp = fopen(filename.c_str(), "wb");
+    if (!fp) return false;
+
+    string buf;
+    buf.reserve(1024*1024 + 1024);
+    buf += "FMT, 128, 89, FMT, BBnNZ, Type,Length,Name,Format,Columns\r\n";
+    buf += "FMT, 129, 23, PARM, Nf, Name,Value\r\n";
+    buf += "FMT, 130, 45, GPS, BIHBcLLeeEefI, Status,TimeMS,Week,NSats,HDop,Lat,Lng,RelAlt,Alt,Spd,GCrs,VZ,T\r\n";
+    buf += "FMT, 131, 31, IMU, Iffffff, TimeMS,GyrX,GyrY,GyrZ,AccX,AccY,AccZ\r\n";
+    buf += "FMT, 132, 23, ATT, IccccCCCC, TimeMS,DesRoll,Roll,DesPitch,Pitch,DesYaw,Yaw,ErrRP,ErrYaw\r\n";
+    buf += "FMT, 145, 31, MSG, Z, Message\r\n";
+    buf += "PARM, SYSID_THISMAV, 1\r\n";
+    buf += "PARM, RATE_RLL_P, 0.15\r\n";
+    buf += "MSG, ArduCopter V3.2\r\n";
+
+    char line[256];
+    uint64_t written = 0;
+    for (unsigned long tick = 0; written + buf.size() < nbytes; ++tick) {
+        const unsigned long t_ms = 100000UL + tick * 20;
+        const double phase = t_ms / 1000.;
+
+        snprintf(line, sizeof(line), "IMU, %lu, %.6f, %.6f, %.6f, %.4f, %.4f, %.4f\r\n", t_ms,
+                 0.01*sin(phase), 0.01*cos(phase), -0.002, 0.3*sin(phase), 0.2*cos(phase), -9.81 + 0.1*sin(3*phase));
+        buf += line;
+        snprintf(line, sizeof(line), "ATT, %lu, %.2f, %.2f, %.2f, %.2f, %u, %u, %.2f, %.2f\r\n", t_ms,
+                 5*sin(phase), 5*sin(phase) + 0.1, 3*cos(phase), 3*cos(phase) - 0.1,
+                 (unsigned)(tick / 50) % 360, (unsigned)(tick / 50) % 360, 0.02, 0.01);
+        buf += line;
+        if (0 == tick % 10) {
+            snprintf(line, sizeof(line), "GPS, 3, %lu, 1800, 10, 1.21, %.7f, %.7f, %.2f, %.2f, %.2f, %.2f, %.2f, %lu\r\n",
+                     t_ms, -35.3632621 + 1E-5*sin(phase), 149.1652374 + 1E-5*cos(phase), 10 + sin(phase),
+                     594.2 + sin(phase), 2.5, 45.0, -0.1, t_ms);
+            buf += line;
+        }
+
+        if (buf.size() >= 1024*1024) {
+            if (fwrite(buf.data(), 1, buf.size(), fp) != buf.size()) {
+                fclose(fp);
+                return false;
+            }
+            written += buf.size();
+            buf.clear();
+        }
+    }
+    if (!buf.empty()) {
+        fwrite(buf.data(), 1, buf.size(), fp);
+    }
+    fclose(fp);
+    return true;
+}
+
+bool Benchmark::_bench_tlog() {
+    const string fname = _get_input("tlog");
+    if (fname.empty()) return false;
+
+    typedef struct {
+        const char* name;
+        ByteSource::sourcetype_e type;
+        size_t chunksize;
+    } variant_t;
+    const variant_t variants[] = {
+        {"per-byte fread (old)", ByteSource::SOURCE_BUFFERED, 1},
+        {"buffered 64kB",        ByteSource::SOURCE_BUFFERED, 64*1024},
+        {"buffered 1MB",         ByteSource::SOURCE_BUFFERED, 1024*1024},
+        {"mmap",                 ByteSource::SOURCE_MMAP,     0},
+    };
+
+    _report_header("MAVLink parsing of " + fname);
+    bool ok = true;
+    unsigned long n_ref = 0;
+    for (unsigned int v=0; v < sizeof(variants)/sizeof(variants[0]); ++v) {
+        MavlinkParser parser(fname, variants[v].type, variants[v].chunksize);
+        if (!parser.valid) {
+            printf("  %-28s n/a\n", variants[v].name);
+            continue;
+        }
+        mavlink_message_t msg;
+        unsigned long n = 0;
+        const double t0 = get_time_secs();
+        while (parser.get_next_msg(msg)) {
+            ++n;
+        }
+        result_t r;
+        r.name = variants[v].name;
+        r.sec = get_time_secs() - t0;
+        r.bytes = parser.get_bytes_total();
+        r.items = n;
+        _report(r);
+
+        if (0 == v) {
+            n_ref = n;
+        } else if (n != n_ref) {
+            fprintf(stderr, "ERROR: %s found %lu messages instead of %lu\n", variants[v].name, n, n_ref);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+std::string Benchmark::_fingerprint(const MavlinkScenario &scenario) {
+    stringstream ss;
+    scenario.dump_overview(ss);
+    const vector<const MavSystem*> systems = scenario.getSystems();
+    for (vector<const MavSystem*>::const_iterator it = systems.begin(); it != systems.end(); ++it) {
+        (*it)->describe_data(ss);
+    }
+    return ss.str();
+}
+
+bool Benchmark::_bench_tlog_parallel() {
+    // the scenario keeps all data in memory, so don't make up too much
+    const string fname = _get_input("tlog", 256);
+    if (fname.empty()) return false;
+
+    _report_header("MAVLink ingestion into a scenario of " + fname);
+    bool ok = true;
+
+    // reference: the way it has always been done
+    string ref;
+    {
+        MavlinkScenario scenario(_args);
+        MavlinkParser parser(fname);
+        if (!parser.valid) return false;
+        mavlink_message_t msg;
+        const double t0 = get_time_secs();
+        while (parser.get_next_msg(msg)) {
+            scenario.add_mavlink_message(msg);
+        }
+        result_t r;
+        r.name = "sequential";
+        r.sec = get_time_secs() - t0;
+        r.bytes = parser.get_bytes_total();
+        r.items = parser.get_num_messages();
+        _report(r);
+        ref = _fingerprint(scenario);
+    }
+
+    const unsigned int threads[] = {1, 2, 4, 8, 16};
+    for (unsigned int v=0; v < sizeof(threads)/sizeof(threads[0]); ++v) {
+        MavlinkScenario scenario(_args);
+        MavlinkChunkedParser parser(fname, threads[v]);
+        if (!parser.valid) return false;
+        const double t0 = get_time_secs();
+        parser.parse(scenario);
+        result_t r;
+        stringstream name;
+        name << threads[v] << " threads, " << parser.get_num_chunks() << " pcs, " << parser.get_num_fallbacks() << " fb";
+        r.name = name.str();
+        r.sec = get_time_secs() - t0;
+        r.bytes = parser.get_bytes_total();
+        r.items = parser.get_num_messages();
+        _report(r);
+
+        if (_fingerprint(scenario) != ref) {
+            fprintf(stderr, "ERROR: %u threads give a different result than sequential parsing\n", threads[v]);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool Benchmark::_bench_ulog() {
+    // the scenario keeps all data in memory, so don't make up too much
+    const string fname = _get_input("ulg", 256);
+    if (fname.empty()) return false;
+
+    struct stat st;
+    if (stat(fname.c_str(), &st) != 0) return false;
+
+    _report_header("ULog ingestion into a scenario of " + fname);
+    string ref;
+    typedef struct {
+        const char*  name;
+        unsigned int threads; ///< 0 means message by message
+    } variant_t;
+    const variant_t variants[] = {
+        {"message by message (old)", 0},
+        {"columns",                  1},
+        {"columns, 2 threads",       2},
+        {"columns, 4 threads",       4},
+        {"columns, 8 threads",       8},
+    };
+    bool ok = true;
+    for (unsigned int v=0; v < sizeof(variants)/sizeof(variants[0]); ++v) {
+        MavlinkScenario scenario(_args);
+        scenario.begin_onboard_log("ulg");
+
+        OnboardLogParserULG parser;
+        const double t0 = get_time_secs();
+        if (!parser.Load(fname, scenario.getLogChannel())) return false;
+        unsigned long n = 0;
+        if (0 == variants[v].threads) {
+            OnboardData d;
+            while (parser.has_more_data()) {
+                parser.get_data(d);
+                if (d.is_valid()) {
+                    scenario.add_onboard_message(d);
+                    ++n;
+                }
+            }
+        } else {
+            OnboardColumns cols;
+            parser.set_threads(variants[v].threads);
+            while (parser.has_more_data()) {
+                cols.clear();
+                const bool parsed = parser.get_columns(cols, 262144);
+                scenario.add_onboard_columns(cols);
+                n += cols.size();
+                if (!parsed) break;
+            }
+        }
+        result_t r;
+        r.name = variants[v].name;
+        r.sec = get_time_secs() - t0;
+        r.bytes = st.st_size;
+        r.items = n;
+        _report(r);
+
+        if (0 == v) {
+            ref = _fingerprint(scenario);
+        } else if (_fingerprint(scenario) != ref) {
+            fprintf(stderr, "ERROR: %s give a different result than the old way\n", variants[v].name);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool Benchmark::_bench_px4log() {
+    const string fname = _get_input("px4log");
+    if (fname.empty()) return false;
+
+    struct stat st;
+    if (stat(fname.c_str(), &st) != 0) return false;
+
+    typedef struct {
+        const char* name;
+        ByteSource::sourcetype_e type;
+        size_t chunksize;
+        bool columns;
+    } variant_t;
+    const variant_t variants[] = {
+        {"per-byte fread (old)",    ByteSource::SOURCE_BUFFERED, 1,         false},
+        {"buffered 1MB",            ByteSource::SOURCE_BUFFERED, 1024*1024, false},
+        {"mmap",                    ByteSource::SOURCE_MMAP,     0,         false},
+        {"mmap, columns",           ByteSource::SOURCE_MMAP,     0,         true},
+    };
+
+    _report_header("PX4 log decoding of " + fname);
+    bool ok = true;
+    unsigned long n_ref = 0;
+    for (unsigned int v=0; v < sizeof(variants)/sizeof(variants[0]); ++v) {
+        OnboardLogParserPX4 parser;
+        parser.set_source_type(variants[v].type, variants[v].chunksize);
+        const double t0 = get_time_secs();
+        if (!parser.Load(fname)) {
+            printf("  %-28s n/a\n", variants[v].name);
+            continue;
+        }
+        unsigned long n = 0;
+        if (!variants[v].columns) {
+            OnboardData d;
+            while (parser.has_more_data()) {
+                parser.get_data(d);
+                if (d.is_valid()) ++n;
+            }
+        } else {
+            OnboardColumns cols;
+            while (parser.has_more_data()) {
+                cols.clear();
+                const bool parsed = parser.get_columns(cols, 262144);
+                n += cols.size();
+                if (!parsed) break;
+            }
+        }
+        result_t r;
+        r.name = variants[v].name;
+        r.sec = get_time_secs() - t0;
+        r.bytes = st.st_size;
+        r.items = n;
+        _report(r);
+
+        if (0 == v) {
+            n_ref = n;
+        } else if (n != n_ref) {
+            fprintf(stderr, "ERROR: %s found %lu messages instead of %lu\n", variants[v].name, n, n_ref);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool Benchmark::_bench_apmlog() {
+    const string fname = _get_input("log");
+    if (fname.empty()) return false;
+
+    struct stat st;
+    if (stat(fname.c_str(), &st) != 0) return false;
+
+    _report_header("APM text log decoding of " + fname);
+    bool ok = true;
+
+    // what the parser was built on before: fgetc() and one string per field
+    unsigned long n_ref = 0;
+    {
+        csv_parser csv;
+        const double t0 = get_time_secs();
+        if (csv.init(fname.c_str())) {
+            csv.set_enclosed_char('"', ENCLOSURE_NONE);
+            csv.set_field_term_char(',');
+            csv.set_line_term_char('\n');
+            double sum = 0.;
+            while (csv.has_more_rows()) {
+                const csv_row row = csv.get_row();
+                if (row.empty() || row[0] == "FMT") continue;
+                for (unsigned int k=1; k < row.size(); ++k) {
+                    sum += atof(row[k].c_str());
+                }
+                ++n_ref;
+            }
+            result_t r;
+            r.name = "csv_parser rows (old)";
+            r.sec = get_time_secs() - t0;
+            r.bytes = st.st_size;
+            r.items = n_ref;
+            _report(r);
+            volatile double sink = sum; // keep the conversions
+            (void) sink;
+        } else {
+            printf("  %-28s n/a\n", "csv_parser rows (old)");
+        }
+    }
+
+    typedef struct {
+        const char* name;
+        ByteSource::sourcetype_e type;
+        size_t chunksize;
+        bool columns;
+    } variant_t;
+    const variant_t variants[] = {
+        {"get_data, mmap",          ByteSource::SOURCE_MMAP,     0,         false},
+        {"columns, buffered 1MB",   ByteSource::SOURCE_BUFFERED, 1024*1024, true},
+        {"columns, mmap",           ByteSource::SOURCE_MMAP,     0,         true},
+    };
+    for (unsigned int v=0; v < sizeof(variants)/sizeof(variants[0]); ++v) {
+        OnboardLogParserAPM parser;
+        parser.set_source_type(variants[v].type, variants[v].chunksize);
+        const double t0 = get_time_secs();
+        if (!parser.Load(fname)) {
+            printf("  %-28s n/a\n", variants[v].name);
+            continue;
+        }
+        unsigned long n = 0;
+        if (!variants[v].columns) {
+            OnboardData d;
+            while (parser.has_more_data()) {
+                parser.get_data(d);
+                if (d.is_valid()) ++n;
+            }
+        } else {
+            OnboardColumns cols;
+            while (parser.has_more_data()) {
+                cols.clear();
+                const bool parsed = parser.get_columns(cols, 262144);
+                n += cols.size();
+                if (!parsed) break;
+            }
+        }
+        result_t r;
+        r.name = variants[v].name;
+        r.sec = get_time_secs() - t0;
+        r.bytes = st.st_size;
+        r.items = n;
+        _report(r);
+
+        if (n_ref > 0 && n != n_ref) {
+            fprintf(stderr, "ERROR: %s found %lu messages instead of %lu\n", variants[v].name, n, n_ref);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool Benchmark::_bench_ingest() {
+    // like IMU: a timestamp and nine floats
+    const char*const names[] = {"AccX", "AccY", "AccZ", "GyroX", "GyroY", "GyroZ", "MagX", "MagY", "MagZ"};
+    const unsigned int nvalues = sizeof(names)/sizeof(names[0]);
+    OnboardSchema schema("IMU", "Airstate/IMU");
+    const unsigned int id_time = schema.add_field("TimeUS", OnboardSchema::FIELD_UINT);
+    unsigned int ids[nvalues];
+    for (unsigned int k=0; k < nvalues; ++k) {
+        ids[k] = schema.add_field(names[k], OnboardSchema::FIELD_FLOAT);
+    }
+
+    // every sample is kept with its time; the scenario keeps all in memory
+    unsigned int size_mb = _args->benchmark_size_mb;
+    if (size_mb > 256) size_mb = 256;
+    const uint64_t sample_bytes = sizeof(float) + sizeof(double);
+    const unsigned long nmsgs = (unsigned long) (((uint64_t) size_mb) * 1024 * 1024 / sample_bytes / (nvalues + 1));
+    const unsigned long nsamples = nmsgs * (nvalues + 1);
+
+    _report_header("Onboard message ingestion, one message type");
+    unsigned long n_ref = 0;
+    {
+        // what add_onboard_message() did before: build the path and look up the series for every sample
+        MavSystem sys(1);
+        const double t0 = get_time_secs();
+        const std::string stem = "onboard log/" + schema.get_message_name() + "/";
+        std::string fullname = stem;
+        for (unsigned long j=0; j < nmsgs; ++j) {
+            const uint64_t timeus = 1000000ULL + j*1000ULL;
+            sys.update_rel_time(timeus, true);
+            fullname.erase(stem.size());
+            fullname.append("TimeUS");
+            sys.track_generic_timeseries<unsigned int>(fullname, (unsigned int) timeus);
+            for (unsigned int k=0; k < nvalues; ++k) {
+                fullname.erase(stem.size());
+                fullname.append(names[k]);
+                sys.track_generic_timeseries<float>(fullname, (float) (j + k));
+            }
+        }
+        result_t r;
+        r.name = "path + map lookup (old)";
+        r.sec = get_time_secs() - t0;
+        r.bytes = nsamples * sample_bytes;
+        r.items = nsamples;
+        _report(r);
+        printf("  %-28s %10.1f ns per sample\n", "", r.sec * 1E9 / nsamples);
+        const DataTimeseries<float>*const d = sys.get_data<DataTimeseries<float> >(stem + names[0]);
+        n_ref = d ? d->size() : 0;
+    }
+
+    double sec_floor = 0.;
+    {
+        // lower bound: nothing but appending to the series, which costs the same in both paths
+        std::vector<DataTimeseries<float>*> series;
+        DataTimeseries<unsigned int> times("TimeUS");
+        for (unsigned int k=0; k < nvalues; ++k) {
+            series.push_back(new DataTimeseries<float>(names[k]));
+        }
+        const double t0 = get_time_secs();
+        for (unsigned long j=0; j < nmsgs; ++j) {
+            const uint64_t timeus = 1000000ULL + j*1000ULL;
+            const double t = timeus * 1E-6;
+            times.add_elem((unsigned int) timeus, t);
+            for (unsigned int k=0; k < nvalues; ++k) {
+                series[k]->add_elem((float) (j + k), t);
+            }
+        }
+        result_t r;
+        r.name = "append only (floor)";
+        r.sec = sec_floor = get_time_secs() - t0;
+        r.bytes = nsamples * sample_bytes;
+        r.items = nsamples;
+        _report(r);
+        printf("  %-28s %10.1f ns per sample\n", "", r.sec * 1E9 / nsamples);
+        for (unsigned int k=0; k < nvalues; ++k) {
+            delete series[k];
+        }
+    }
+
+    bool ok = true;
+    {
+        MavlinkScenario scenario(_args);
+        scenario.begin_onboard_log("px4");
+        OnboardData d;
+        const double t0 = get_time_secs();
+        for (unsigned long j=0; j < nmsgs; ++j) {
+            d.reset(&schema);
+            d.set_uint(id_time, 1000000ULL + j*1000ULL);
+            for (unsigned int k=0; k < nvalues; ++k) {
+                d.set_float(ids[k], (float) (j + k));
+            }
+            d._valid = true;
+            scenario.add_onboard_message(d);
+        }
+        result_t r;
+        r.name = "cached series";
+        r.sec = get_time_secs() - t0;
+        r.bytes = nsamples * sample_bytes;
+        r.items = nsamples;
+        _report(r);
+        printf("  %-28s %10.1f ns per sample\n", "", r.sec * 1E9 / nsamples);
+        printf("  %-28s %10.1f ns per sample above the floor\n", "", (r.sec - sec_floor) * 1E9 / nsamples);
+
+        const std::vector<const MavSystem*> systems = scenario.getSystems();
+        const DataTimeseries<float>*const s = systems.empty() ? NULL :
+            systems[0]->get_data<DataTimeseries<float> >("onboard log/" + schema.get_message_name() + "/" + names[0]);
+        if (!s || s->size() != n_ref) {
+            fprintf(stderr, "ERROR: cached series got %lu samples instead of %lu\n", (unsigned long) (s ? s->size() : 0), n_ref);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool Benchmark::_bench_mavlink_decode() {
+    const MavlinkDecoders::message_t*const info = MavlinkDecoders::find_message(MAVLINK_MSG_ID_ATTITUDE);
+    if (!info) {
+        fprintf(stderr, "ERROR: no decoder for ATTITUDE\n");
+        return false;
+    }
+
+    // 7 fields per message; the scenario keeps them all in memory
+    unsigned int size_mb = _args->benchmark_size_mb;
+    if (size_mb > 256) size_mb = 256;
+    const uint64_t msg_bytes = info->n_series * (sizeof(float) + sizeof(double));
+    const unsigned long nmsgs = (unsigned long) (((uint64_t) size_mb) * 1024 * 1024 / msg_bytes);
+    mavlink_message_t msg;
+
+    _report_header("MavLink message decoding into series, ATTITUDE");
+    unsigned long n_ref = 0;
+    {
+        // like the hand-written cases in MavlinkScenario::add_mavlink_message()
+        MavSystem sys(1);
+        const double t0 = get_time_secs();
+        for (unsigned long j=0; j < nmsgs; ++j) {
+            const uint32_t t_ms = (uint32_t) j;
+            mavlink_msg_attitude_pack(1, 1, &msg, t_ms, 0.1f, 0.2f, (float) j, 0.1f, 0.2f, 0.3f);
+            sys.update_rel_time(((uint64_t) t_ms)*1000, true);
+            const string fullname = "mavlink/ATTITUDE/";
+            sys.track_generic_timeseries<unsigned int>(fullname + "time_boot_ms", mavlink_msg_attitude_get_time_boot_ms(&msg), "ms");
+            sys.track_generic_timeseries<float>(fullname + "roll", mavlink_msg_attitude_get_roll(&msg), "rad");
+            sys.track_generic_timeseries<float>(fullname + "pitch", mavlink_msg_attitude_get_pitch(&msg), "rad");
+            sys.track_generic_timeseries<float>(fullname + "yaw", mavlink_msg_attitude_get_yaw(&msg), "rad");
+            sys.track_generic_timeseries<float>(fullname + "rollspeed", mavlink_msg_attitude_get_rollspeed(&msg), "rad/s");
+            sys.track_generic_timeseries<float>(fullname + "pitchspeed", mavlink_msg_attitude_get_pitchspeed(&msg), "rad/s");
+            sys.track_generic_timeseries<float>(fullname + "yawspeed", mavlink_msg_attitude_get_yawspeed(&msg), "rad/s");
+        }
+        result_t r;
+        r.name = "track_generic (old)";
+        r.sec = get_time_secs() - t0;
+        r.bytes = nmsgs * msg_bytes;
+        r.items = nmsgs;
+        _report(r);
+        printf("  %-28s %10.1f ns per message\n", "", r.sec * 1E9 / nmsgs);
+        const DataTimeseries<float>*const d = sys.get_data<DataTimeseries<float> >("mavlink/ATTITUDE/yaw");
+        n_ref = d ? d->size() : 0;
+    }
+
+    bool ok = true;
+    {
+        MavSystem sys(1);
+        MavlinkDecoders decoders;
+        const double t0 = get_time_secs();
+        for (unsigned long j=0; j < nmsgs; ++j) {
+            const uint32_t t_ms = (uint32_t) j;
+            mavlink_msg_attitude_pack(1, 1, &msg, t_ms, 0.1f, 0.2f, (float) j, 0.1f, 0.2f, 0.3f);
+            sys.update_rel_time(((uint64_t) t_ms)*1000, true);
+            decoders.decode(&sys, msg);
+        }
+        result_t r;
+        r.name = "generated decoder";
+        r.sec = get_time_secs() - t0;
+        r.bytes = nmsgs * msg_bytes;
+        r.items = nmsgs;
+        _report(r);
+        printf("  %-28s %10.1f ns per message\n", "", r.sec * 1E9 / nmsgs);
+
+        const DataTimeseries<float>*const d = sys.get_data<DataTimeseries<float> >("mavlink/ATTITUDE/yaw");
+        if (!d || d->size() != n_ref || d->get_last().second != (float) (nmsgs - 1)) {
+            fprintf(stderr, "ERROR: generated decoder got %lu samples instead of %lu\n", (unsigned long) (d ? d->size() : 0), n_ref);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool Benchmark::_load_scenarios(const std::string &fname, unsigned int n, double shift_sec,
+                                std::vector<MavlinkScenario *> &scenarios, uint64_t &bytes, unsigned long &items) const {
+    bytes = 0;
+    items = 0;
+    for (unsigned int k=0; k < n; ++k) {
+        MavlinkScenario*scenario = new MavlinkScenario(_args);
+        scenarios.push_back(scenario);
+        MavlinkParser parser(fname);
+        if (!parser.valid) {
+            for (vector<MavlinkScenario*>::iterator it = scenarios.begin(); it != scenarios.end(); ++it) {
+                delete *it;
+            }
+            scenarios.clear();
+            return false;
+        }
+        mavlink_message_t msg;
+        while (parser.get_next_msg(msg)) {
+            scenario->add_mavlink_message(msg);
+        }
+        scenario->process();
+        if (k > 0) scenario->shift_time(k*shift_sec);
+        bytes += parser.get_bytes_total();
+        items += parser.get_num_messages();
+    }
+    return true;
+}
+
+bool Benchmark::_bench_merge() {
+    // the logs of one day, each a few MB; the scenarios keep all data in memory
+    const unsigned int nfiles = 16;
+    unsigned int size_mb = _args->benchmark_size_mb;
+    if (size_mb > 256) size_mb = 256;
+    if (size_mb < nfiles) size_mb = nfiles;
+    const string fname = _tmpfile("tlog");
+    printf("Synthesizing %u MB of tlog data in %s...\n", size_mb / nfiles, fname.c_str());
+    fflush(stdout);
+    if (!_synthesize_tlog(fname, ((uint64_t) (size_mb / nfiles)) * 1024 * 1024)) {
+        fprintf(stderr, "ERROR: could not write %s\n", fname.c_str());
+        return false;
+    }
+
+    bool ok = true;
+    for (unsigned int overlap=0; overlap < 2; ++overlap) {
+        // one flight after another, or all at the same time (worst case)
+        const double shift_sec = overlap ? 0. : 3600.;
+        vector<MavlinkScenario*> scenarios;
+        uint64_t bytes;
+        unsigned long items;
+        if (!_load_scenarios(fname, nfiles, shift_sec, scenarios, bytes, items)) return false;
+        stringstream title;
+        title << "Merging " << nfiles << " scenarios of " << fname << ", " << (overlap ? "at the same time" : "one after another");
+        _report_header(title.str());
+
+        // reference: one by one, as before
+        string ref;
+        {
+            MavlinkScenario target(_args);
+            const double t0 = get_time_secs();
+            for (unsigned int k=0; k < nfiles; ++k) {
+                target.merge_in(*scenarios[k]);
+            }
+            result_t r;
+            r.name = "merge_in one by one";
+            r.sec = get_time_secs() - t0;
+            r.bytes = bytes;
+            r.items = items;
+            _report(r);
+            ref = _fingerprint(target);
+        }
+        {
+            MavlinkScenario target(_args);
+            const double t0 = get_time_secs();
+            target.merge_in_all(vector<const MavlinkScenario*>(scenarios.begin(), scenarios.end()));
+            result_t r;
+            r.name = "merge_in_all";
+            r.sec = get_time_secs() - t0;
+            r.bytes = bytes;
+            r.items = items;
+            _report(r);
+            if (_fingerprint(target) != ref) {
+                fprintf(stderr, "ERROR: merge_in_all gives a different result than merge_in one by one\n");
+                ok = false;
+            }
+        }
+        {
+            // moves the data out of the scenarios, so this one goes last
+            MavlinkScenario target(_args);
+            const double t0 = get_time_secs();
+            target.take_in_all(scenarios);
+            for (vector<MavlinkScenario*>::iterator it = scenarios.begin(); it != scenarios.end(); ++it) {
+                delete *it;
+            }
+            scenarios.clear();
+            result_t r;
+            r.name = "take_in_all + delete";
+            r.sec = get_time_secs() - t0;
+            r.bytes = bytes;
+            r.items = items;
+            _report(r);
+            if (_fingerprint(target) != ref) {
+                fprintf(stderr, "ERROR: take_in_all gives a different result than merge_in one by one\n");
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief one sample, for the reference merge below
+ */
+typedef std::pair<double, float> sample_t;
+static bool sample_before(const sample_t & a, const sample_t & b) {
+    return a.first < b.first;
+}
+
+/**
+ * @brief whether two containers hold the same elements
+ */
+template <typename A, typename B>
+static bool same_elems(const A & a, const B & b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+bool Benchmark::_bench_merge_series() {
+    // two sensors of the same kind, sampled alternately, one of them starting a bit later
+    const unsigned int n = 5000000;
+    const unsigned long epoch = 1500000000UL * 1000000UL;
+    DataTimeseries<float> a("a");
+    DataTimeseries<float> b("b");
+    DataEvent<float> ea("a");
+    DataEvent<float> eb("b");
+    a.set_epoch_datastart(epoch);
+    ea.set_epoch_datastart(epoch);
+    b.set_epoch_datastart(epoch + 500000);
+    eb.set_epoch_datastart(epoch + 500000);
+    for (unsigned int k=0; k < n; ++k) {
+        const double t = k*0.01;
+        a.add_elem((float)k, t);
+        ea.add_elem((float)k, t);
+        const double tb = (k % 4) ? t + 0.005 : t; // some at the same time as a
+        b.add_elem(-(float)k, tb);
+        eb.add_elem(-(float)k, tb);
+    }
+    const uint64_t bytes = 2ULL*n*(sizeof(double) + sizeof(float));
+    const unsigned long items = 2UL*n;
+
+    _report_header("Merging two overlapping series of 5M samples each");
+    bool ok = true;
+
+    // reference: the way it was done before, via an array of samples and std::merge
+    vector<double> ref_time;
+    vector<float> ref_data;
+    {
+        const double t0 = get_time_secs();
+        const double offset = 0.5;
+        vector<sample_t> sa, sb, merged;
+        sa.reserve(n);
+        sb.reserve(n);
+        for (unsigned int k=0; k < n; ++k) {
+            sa.push_back(sample_t(a.get_time()[k], a.get_data()[k]));
+            sb.push_back(sample_t(b.get_time()[k] + offset, b.get_data()[k]));
+        }
+        merged.resize(2*n);
+        std::merge(sa.begin(), sa.end(), sb.begin(), sb.end(), merged.begin(), sample_before);
+        ref_time.reserve(2*n);
+        ref_data.reserve(2*n);
+        for (vector<sample_t>::const_iterator it = merged.begin(); it != merged.end(); ++it) {
+            ref_time.push_back(it->first);
+            ref_data.push_back(it->second);
+        }
+        result_t r;
+        r.name = "samples + std::merge";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+    }
+
+    {
+        DataTimeseries<float> target(a);
+        const double t0 = get_time_secs();
+        target.merge_in(&b);
+        result_t r;
+        r.name = "DataTimeseries::merge_in";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+        if (!same_elems(target.get_time(), ref_time) || !same_elems(target.get_data(), ref_data)) {
+            fprintf(stderr, "ERROR: DataTimeseries::merge_in gives a different result\n");
+            ok = false;
+        }
+    }
+    {
+        DataTimeseries<float> target(a);
+        DataTimeseries<float>*src = new DataTimeseries<float>(b);
+        const double t0 = get_time_secs();
+        target.take_in_all(vector<Data*>(1, src));
+        delete src;
+        result_t r;
+        r.name = "DataTimeseries::take_in_all";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+        if (!same_elems(target.get_time(), ref_time) || !same_elems(target.get_data(), ref_data)) {
+            fprintf(stderr, "ERROR: DataTimeseries::take_in_all gives a different result\n");
+            ok = false;
+        }
+    }
+    {
+        DataEvent<float> target(ea);
+        const double t0 = get_time_secs();
+        target.merge_in(&eb);
+        result_t r;
+        r.name = "DataEvent::merge_in";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+        if (!same_elems(target.get_time(), ref_time) || !same_elems(target.get_data(), ref_data)) {
+            fprintf(stderr, "ERROR: DataEvent::merge_in gives a different result\n");
+            ok = false;
+        }
+    }
+    {
+        // the log of the day before: goes in front, nothing overlaps
+        DataTimeseries<float> target(a);
+        DataTimeseries<float> earlier("b");
+        const unsigned long day = 86400UL * 1000000UL;
+        earlier.set_epoch_datastart(epoch - day);
+        for (unsigned int k=0; k < n; ++k) {
+            earlier.add_elem(b.get_data()[k], b.get_time()[k]);
+        }
+        const double t0 = get_time_secs();
+        target.merge_in(&earlier);
+        result_t r;
+        r.name = "DataTimeseries, day before";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+        bool same = target.size() == 2*n && target.get_epoch_datastart() == epoch - day;
+        for (unsigned int k=0; same && k < n; ++k) {
+            same = target.get_time()[k] == b.get_time()[k] && target.get_data()[k] == b.get_data()[k] &&
+                   target.get_time()[n + k] == a.get_time()[k] + day/1E6 && target.get_data()[n + k] == a.get_data()[k];
+        }
+        if (!same) {
+            fprintf(stderr, "ERROR: DataTimeseries::merge_in of an earlier series gives a different result\n");
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool Benchmark::_bench_resample() {
+    // voltage and current of a battery, sampled independently at different rates
+    const unsigned int n = 2000000;
+    DataTimeseries<float> volt("volt");
+    DataTimeseries<float> amps("amps");
+    for (unsigned int k=0; k < n; ++k) {
+        volt.add_elem(12.f - k*1E-6f, k*0.1);
+        amps.add_elem((float)(k % 100), k*0.07 + 0.003);
+    }
+    const uint64_t bytes = 2ULL*n*(sizeof(double) + sizeof(float));
+    const unsigned long items = n;
+
+    _report_header("Sampling current at the times of 2M voltage samples");
+    bool ok = true;
+
+    // reference: one lookup per sample
+    vector<float> ref(n, NAN);
+    {
+        const double t0 = get_time_secs();
+        for (unsigned int k=0; k < n; ++k) {
+            float a;
+            if (amps.get_data_at_time(volt.get_time()[k], a)) ref[k] = a;
+        }
+        result_t r;
+        r.name = "get_data_at_time";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+    }
+
+    {
+        vector<float> res(n, NAN);
+        const double t0 = get_time_secs();
+        DataTimeseries<float>::Cursor cur(&amps);
+        for (unsigned int k=0; k < n; ++k) {
+            float a;
+            if (cur.get_data_at_time(volt.get_time()[k], a)) res[k] = a;
+        }
+        result_t r;
+        r.name = "DataTimeseries::Cursor";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+        if (memcmp(&res[0], &ref[0], n*sizeof(float)) != 0) {
+            fprintf(stderr, "ERROR: DataTimeseries::Cursor gives a different result\n");
+            ok = false;
+        }
+    }
+    {
+        vector<float> res(n, NAN);
+        const double t0 = get_time_secs();
+        Resampler<float> rs;
+        rs.add_series(&amps);
+        rs.set_grid_series(&volt);
+        if (!rs.run()) {
+            fprintf(stderr, "ERROR: Resampler has no grid\n");
+            return false;
+        }
+        const vector<double> & col = rs.get_column(0);
+        for (unsigned int k=0; k < col.size(); ++k) {
+            res[k] = col[k];
+        }
+        result_t r;
+        r.name = "Resampler, grid of volt";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+        if (memcmp(&res[0], &ref[0], n*sizeof(float)) != 0) {
+            fprintf(stderr, "ERROR: Resampler gives a different result\n");
+            ok = false;
+        }
+    }
+    {
+        const double t0 = get_time_secs();
+        Resampler<float> rs;
+        rs.add_series(&volt);
+        rs.add_series(&amps);
+        rs.run();
+        result_t r;
+        r.name = "Resampler, union of both";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = rs.size();
+        _report(r);
+    }
+    return ok;
+}
+
+bool Benchmark::_bench_stats_window() {
+    const unsigned int n = 10000000;
+    const unsigned int nwin = 100;
+    const unsigned long epoch = 1500000000UL * 1000000UL;
+    DataTimeseries<float> a("a");
+    a.set_epoch_datastart(epoch);
+    for (unsigned int k=0; k < n; ++k) {
+        a.add_elem((float)((k*7919) % 1000) - 500.f, k*0.01);
+    }
+    const uint64_t bytes = (uint64_t)nwin*n/2*(sizeof(double) + sizeof(float)); // windows are half of it on average
+    const unsigned long items = (unsigned long)nwin*n/2;
+
+    // windows in absolute time, random but the same for all variants
+    vector<pair<double, double> > win;
+    srand(1);
+    for (unsigned int w=0; w < nwin; ++w) {
+        const double t0 = epoch/1E6 + (rand() % n)*0.01 * 0.5 + 0.003;
+        win.push_back(make_pair(t0, t0 + (n/2)*0.01));
+    }
+
+    _report_header("Statistics of 100 windows in a series of 10M samples");
+    bool ok = true;
+
+    // reference: going over all samples of each window
+    vector<Data::data_stats> ref(nwin);
+    {
+        const double t0 = get_time_secs();
+        for (unsigned int w=0; w < nwin; ++w) {
+            const double tmin = win[w].first - epoch/1E6, tmax = win[w].second - epoch/1E6;
+            double mn = INFINITY, mx = -INFINITY, sum = 0.;
+            unsigned int cnt = 0;
+            for (unsigned int k=0; k < n; ++k) {
+                const double t = a.get_time()[k];
+                if (t < tmin || t > tmax) continue;
+                const double v = a.get_data()[k];
+                if (v < mn) mn = v;
+                if (v > mx) mx = v;
+                sum += v;
+                cnt++;
+            }
+            ref[w].n_samples = cnt;
+            ref[w].min = mn;
+            ref[w].max = mx;
+            ref[w].avg = sum / cnt; // without the interpolated ends
+        }
+        result_t r;
+        r.name = "all samples (reference)";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+    }
+
+    {
+        const double t0 = get_time_secs();
+        double tb, te, vb, ve;
+        a.get_bounds(tb, te, vb, ve);
+        result_t r;
+        r.name = "building the summary";
+        r.sec = get_time_secs() - t0;
+        r.bytes = (uint64_t)n*(sizeof(double) + sizeof(float));
+        r.items = n;
+        _report(r);
+    }
+
+    {
+        vector<Data::data_stats> res(nwin);
+        const double t0 = get_time_secs();
+        for (unsigned int w=0; w < nwin; ++w) {
+            a.get_stats_timewindow(win[w].first, win[w].second, res[w]);
+        }
+        result_t r;
+        r.name = "get_stats_timewindow";
+        r.sec = get_time_secs() - t0;
+        r.bytes = bytes;
+        r.items = items;
+        _report(r);
+        for (unsigned int w=0; w < nwin; ++w) {
+            // the ends are interpolated, and they are within the range of the others here
+            if (res[w].n_samples != ref[w].n_samples || res[w].min != ref[w].min || res[w].max != ref[w].max ||
+                fabs(res[w].avg - ref[w].avg) > 1.) {
+                fprintf(stderr, "ERROR: get_stats_timewindow gives a different result\n");
+                ok = false;
+                break;
+            }
+        }
+    }
+    return ok;
+}
+
+bool Benchmark::_bench_plot_lod() {
+    const unsigned int n = 10000000;
+    const unsigned int nview = 100;
+    const unsigned int width = 1000; // pixels
+    const unsigned long epoch = 1500000000UL * 1000000UL;
+    DataTimeseries<float> a("a");
+    a.set_epoch_datastart(epoch);
+    for (unsigned int k=0; k < n; ++k) {
+        a.add_elem((float)((k*7919) % 1000) - 500.f, k*0.0025); // 400Hz
+    }
+
+    // views in absolute time, zooming in from all to a few samples; the same for all variants
+    vector<pair<double, double> > view;
+    const double tspan = (n - 1)*0.0025;
+    for (unsigned int v=0; v < nview; ++v) {
+        const double len = tspan / pow(1.15, (double)v);
+        const double t0 = epoch/1E6 + (tspan - len)*0.5;
+        view.push_back(make_pair(t0, t0 + len));
+    }
+
+    _report_header("Samples to draw for 100 views of a series of 10M samples, 1000 pixels wide");
+    bool ok = true;
+
+    // reference: all visible samples, converted for the plot
+    vector<double> ref_min(nview), ref_max(nview);
+    uint64_t ref_items = 0;
+    {
+        const double t0 = get_time_secs();
+        vector<double> x, y;
+        for (unsigned int v=0; v < nview; ++v) {
+            const double tmin = view[v].first - epoch/1E6, tmax = view[v].second - epoch/1E6;
+            x.clear();
+            y.clear();
+            double mn = INFINITY, mx = -INFINITY;
+            for (unsigned int k=0; k < n; ++k) {
+                const double t = a.get_time()[k];
+                if (t < tmin || t > tmax) continue;
+                x.push_back(t + epoch/1E6);
+                y.push_back(a.get_data()[k]);
+                if (y.back() < mn) mn = y.back();
+                if (y.back() > mx) mx = y.back();
+            }
+            ref_items += x.size();
+            ref_min[v] = mn;
+            ref_max[v] = mx;
+        }
+        result_t r;
+        r.name = "all samples (reference)";
+        r.sec = get_time_secs() - t0;
+        r.bytes = (uint64_t)nview*n*(sizeof(double) + sizeof(float));
+        r.items = ref_items;
+        _report(r);
+    }
+
+    {
+        const double t0 = get_time_secs();
+        double tb, te, vb, ve;
+        a.get_bounds(tb, te, vb, ve);
+        result_t r;
+        r.name = "building the summary";
+        r.sec = get_time_secs() - t0;
+        r.bytes = (uint64_t)n*(sizeof(double) + sizeof(float));
+        r.items = n;
+        _report(r);
+    }
+
+    {
+        const double t0 = get_time_secs();
+        vector<size_t> idx;
+        uint64_t items = 0;
+        for (unsigned int v=0; v < nview && ok; ++v) {
+            a.get_lod_indices(view[v].first, view[v].second, width, idx);
+            items += idx.size();
+
+            // the lines between the picked samples must reach as far up and down
+            const double tmin = view[v].first - epoch/1E6, tmax = view[v].second - epoch/1E6;
+            double mn = INFINITY, mx = -INFINITY;
+            for (size_t j=0; j < idx.size(); ++j) {
+                const double t = a.get_time()[idx[j]];
+                if (t < tmin || t > tmax) continue;
+                const double y = a.get_data()[idx[j]];
+                if (y < mn) mn = y;
+                if (y > mx) mx = y;
+            }
+            if (mn != ref_min[v] || mx != ref_max[v] || idx.size() > 4*width + 2) {
+                fprintf(stderr, "ERROR: get_lod_indices misses samples\n");
+                ok = false;
+            }
+        }
+        result_t r;
+        r.name = "per pixel (get_lod_indices)";
+        r.sec = get_time_secs() - t0;
+        r.bytes = items*(sizeof(double) + sizeof(float));
+        r.items = items;
+        _report(r);
+    }
+    return ok;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file benchmark.h
+ * @brief Headless throughput measurements of the parsers and data
+ * structures, invoked with --benchmark.
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <inttypes.h>
+#include "cmdlineargs.h"
+#include "mavlinkscenario.h"
+
+class Benchmark {
+public:
+    Benchmark(const CmdlineArgs*args);
+    ~Benchmark();
+
+    /**
+     * @brief run the benchmark(s) selected on the command line
+     * @return exit code for main()
+     */
+    int run(void);
+
+private:
+    /**
+     * @brief one line of the report
+     */
+    typedef struct result_s {
+        std::string   name;
+        double        sec;
+        uint64_t      bytes;
+        unsigned long items; ///< messages, samples,... whatever the benchmark processes
+    } result_t;
+
+    void _report_header(const std::string & title) const;
+    void _report(const result_t & r) const;
+
+    /**
+     * @brief parse a tlog byte-by-byte, buffered and mmap'd
+     */
+    bool _bench_tlog(void);
+
+    /**
+     * @brief read a tlog into a scenario sequentially and with several threads,
+     * and check that the results are the same
+     */
+    bool _bench_tlog_parallel(void);
+
+    /**
+     * @brief read a ULog into a scenario message by message and in columns,
+     * and check that the results are the same
+     */
+    bool _bench_ulog(void);
+
+    /**
+     * @brief decode a px4log message by message with different readers, and into columns
+     */
+    bool _bench_px4log(void);
+
+    /**
+     * @brief tokenize and decode an APM text log (MissionPlanner .log)
+     */
+    bool _bench_apmlog(void);
+
+    /**
+     * @brief append onboard messages to a scenario, compared to looking up each series by name
+     */
+    bool _bench_ingest(void);
+
+    /**
+     * @brief store the fields of MavLink messages with the generated decoder, compared to
+     * looking up each series by name
+     */
+    bool _bench_mavlink_decode(void);
+
+    /**
+     * @brief merge the scenarios of several logfiles one after another, compared to all at once
+     */
+    bool _bench_merge(void);
+
+    /**
+     * @brief merge two overlapping series of 10M samples in total
+     */
+    bool _bench_merge_series(void);
+
+    /**
+     * @brief sample one series at the times of another, by lookups and with Resampler
+     */
+    bool _bench_resample(void);
+
+    /**
+     * @brief statistics of time windows in a long series
+     */
+    bool _bench_stats_window(void);
+
+    /**
+     * @brief samples to draw for several views of a long series, all of them and per pixel
+     */
+    bool _bench_plot_lod(void);
+
+    /**
+     * @brief returns the first given file with that extension, or synthesizes one
+     * @param max_mb if not zero, synthesize at most that many MB
+     * @return filename, empty on error
+     */
+    std::string _get_input(const std::string & ext, unsigned int max_mb = 0);
+    std::string _tmpfile(const std::string & ext);
+    static bool _synthesize_tlog(const std::string & filename, uint64_t nbytes);
+    static bool _synthesize_ulog(const std::string & filename, uint64_t nbytes);
+    static bool _synthesize_px4log(const std::string & filename, uint64_t nbytes);
+    static bool _synthesize_apmlog(const std::string & filename, uint64_t nbytes);
+
+    /**
+     * @brief textual description of all data in a scenario, for comparison
+     */
+    static std::string _fingerprint(const MavlinkScenario & scenario);
+
+    /**
+     * @brief parses a tlog n times, each into its own processed scenario, which is
+     * shifted by k*shift_sec. The caller owns the scenarios.
+     * @return false on error; scenarios is empty then
+     */
+    bool _load_scenarios(const std::string & fname, unsigned int n, double shift_sec,
+                         std::vector<MavlinkScenario*> & scenarios, uint64_t & bytes, unsigned long & items) const;
+
+    /****************************************
+     *     DATA MEMBERS
+     ****************************************/
+    const CmdlineArgs*       _args;
+    std::vector<std::string> _tmpfiles; ///< synthetic inputs, deleted in dtor
+};
+
+#endif // BENCHMARK_H
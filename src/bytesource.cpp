@@ -0,0 +1,193 @@
+/**
+ * @file bytesource.cpp
+ * @brief Hands out the contents of a (log)file as contiguous spans of bytes,
+ * either from a memory-mapped file or from a large read-ahead buffer.
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bytesource.h"
+
+#if defined(WIN32) || defined(__WIN32) || defined(__WIN32__)
+    #define BYTESOURCE_NO_MMAP
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+ByteSource* ByteSource::open(const std::string &filename, sourcetype_e type, size_t chunksize) {
+    if (type != SOURCE_BUFFERED) {
+        ByteSourceMmap*src = new ByteSourceMmap(filename);
+        if (src->valid || type == SOURCE_MMAP) return src;
+        delete src; // fall back
+    }
+    return new ByteSourceBuffered(filename, chunksize);
+}
+
+/********************************************
+ *   BUFFERED
+ ********************************************/
+ByteSourceBuffered::ByteSourceBuffered(const std::string &filename, size_t chunksize) :
+    _fp(NULL), _buf(NULL), _chunksize(chunksize > 0 ? chunksize : 1) {
+
+    _fp = fopen(filename.c_str(), "rb");
+    if (!_fp) return;
+
+    // ftell() returns a long, which is 32bit on Windows
+#if defined(WIN32) || defined(__WIN32) || defined(__WIN32__)
+    if (0 == _fseeki64(_fp, 0, SEEK_END)) {
+        const __int64 sz = _ftelli64(_fp);
+        if (sz > 0) _size = (uint64_t) sz;
+        _fseeki64(_fp, 0, SEEK_SET);
+    }
+#else
+    if (0 == fseeko(_fp, 0, SEEK_END)) {
+        const off_t sz = ftello(_fp);
+        if (sz > 0) _size = (uint64_t) sz;
+        fseeko(_fp, 0, SEEK_SET);
+    }
+#endif
+    _buf = (uint8_t*) malloc(_chunksize);
+    valid = (_buf != NULL);
+}
+
+ByteSourceBuffered::~ByteSourceBuffered() {
+    if (_fp) fclose(_fp);
+    free(_buf);
+}
+
+bool ByteSourceBuffered::next_span(const uint8_t *&data, size_t &len) {
+    if (!valid) return false;
+    len = fread(_buf, 1, _chunksize, _fp);
+    if (len == 0) return false;
+    data = _buf;
+    _pos += len;
+    return true;
+}
+
+/********************************************
+ *   MMAP
+ ********************************************/
+#ifdef BYTESOURCE_NO_MMAP
+ByteSourceMmap::ByteSourceMmap(const std::string &filename) : _data(NULL) {
+    (void) filename;
+}
+
+ByteSourceMmap::~ByteSourceMmap() {}
+
+#else
+ByteSourceMmap::ByteSourceMmap(const std::string &filename) : _data(NULL) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (0 == fstat(fd, &st) && st.st_size > 0) {
+        void*p = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            _data = (uint8_t*) p;
+            _size = (uint64_t) st.st_size;
+            madvise(p, (size_t) _size, MADV_SEQUENTIAL); // only a hint for read-ahead
+            valid = true;
+        }
+    }
+    ::close(fd); // mapping stays valid
+}
+
+ByteSourceMmap::~ByteSourceMmap() {
+    if (_data) munmap(_data, (size_t) _size);
+}
+#endif
+
+bool ByteSourceMmap::next_span(const uint8_t *&data, size_t &len) {
+    if (!valid || _pos >= _size) return false;
+    data = _data;
+    len = (size_t) _size;
+    _pos = _size;
+    return true;
+}
+
+/********************************************
+ *   MEMORY
+ ********************************************/
+ByteSourceMemory::ByteSourceMemory(const uint8_t *data, size_t len) : _data(data) {
+    _size = len;
+    valid = (data != NULL);
+}
+
+bool ByteSourceMemory::next_span(const uint8_t *&data, size_t &len) {
+    if (!valid || _pos >= _size) return false;
+    data = _data;
+    len = (size_t) _size;
+    _pos = _size;
+    return true;
+}
+
+/********************************************
+ *   CURSOR
+ ********************************************/
+void ByteCursor::reset(ByteSource *src) {
+    _src = src;
+    _span = NULL;
+    _span_len = _span_pos = 0;
+    _pos = 0;
+    _end = (src && src->valid) ? src->get_size() : 0;
+}
+
+void ByteCursor::set_limit(uint64_t end) {
+    const uint64_t size = (_src && _src->valid) ? _src->get_size() : 0;
+    _end = end < size ? end : size;
+    if (_pos > _end) _pos = _end;
+}
+
+bool ByteCursor::_next_span(void) {
+    if (!_src->next_span(_span, _span_len)) {
+        _span_len = _span_pos = 0;
+        _pos = _end;
+        return false;
+    }
+    _span_pos = 0;
+    return true;
+}
+
+const uint8_t* ByteCursor::_read_across(size_t n) {
+    // collect it from several spans
+    _carry.resize(n);
+    size_t have = 0;
+    while (have < n) {
+        if (_span_pos == _span_len && !_next_span()) return NULL;
+        size_t take = _span_len - _span_pos;
+        if (take > n - have) take = n - have;
+        memcpy(&_carry[have], _span + _span_pos, take);
+        have += take;
+        _span_pos += take;
+    }
+    _pos += n;
+    return &_carry[0];
+}
+
+int ByteCursor::peek(void) {
+    if (at_end()) return -1;
+    if (_span_pos == _span_len && !_next_span()) return -1;
+    return _span[_span_pos];
+}
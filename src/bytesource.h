@@ -0,0 +1,212 @@
+/**
+ * @file bytesource.h
+ * @brief Hands out the contents of a (log)file as contiguous spans of bytes,
+ * either from a memory-mapped file or from a large read-ahead buffer.
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef BYTESOURCE_H
+#define BYTESOURCE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief abstract source of bytes. Consumers repeatedly ask for the next span
+ * and process it in a tight loop, instead of paying one library call per byte.
+ */
+class ByteSource {
+public:
+    /**
+     * @brief which implementation to use
+     */
+    typedef enum {
+        SOURCE_AUTO,     ///< mmap if available, else buffered
+        SOURCE_MMAP,     ///< map whole file into memory
+        SOURCE_BUFFERED  ///< read-ahead buffer of given size
+    } sourcetype_e;
+
+    static const size_t DEFAULT_CHUNKSIZE = 1024*1024;
+
+    virtual ~ByteSource() {}
+
+    /**
+     * @brief get the next contiguous span of bytes. The span stays valid
+     * until the next call.
+     * @param data is set to the beginning of the span
+     * @param len is set to the length of the span
+     * @return false if there is no more data (then data and len are invalid)
+     */
+    virtual bool next_span(const uint8_t* &data, size_t &len) = 0;
+
+    /**
+     * @brief if the whole content is accessible at once (e.g., mmap), then
+     * this returns a pointer to it, otherwise NULL.
+     */
+    virtual const uint8_t* get_data(void) const { return NULL; }
+
+    /**
+     * @brief total number of bytes in this source
+     */
+    uint64_t get_size(void) const { return _size; }
+
+    /**
+     * @brief number of bytes that have been handed out by next_span() so far
+     */
+    uint64_t get_position(void) const { return _pos; }
+
+    /**
+     * @brief human-readable name of the implementation
+     */
+    virtual const char* get_typename(void) const = 0;
+
+    bool valid; ///< false if the source could not be opened
+
+    /**
+     * @brief factory. Falls back to buffered reading if mapping fails.
+     * @param filename file to open
+     * @param type preferred implementation
+     * @param chunksize size of the read-ahead buffer (ignored for mmap)
+     * @return always an object (check valid), caller owns it
+     */
+    static ByteSource* open(const std::string & filename, sourcetype_e type = SOURCE_AUTO,
+                            size_t chunksize = DEFAULT_CHUNKSIZE);
+
+protected:
+    ByteSource() : valid(false), _size(0), _pos(0) {}
+
+    uint64_t _size;
+    uint64_t _pos;
+};
+
+/**
+ * @brief reads the file with fread() in chunks of a given size. A chunk size
+ * of one gives the old byte-by-byte behavior.
+ */
+class ByteSourceBuffered : public ByteSource {
+public:
+    ByteSourceBuffered(const std::string & filename, size_t chunksize = DEFAULT_CHUNKSIZE);
+    ~ByteSourceBuffered();
+    bool next_span(const uint8_t* &data, size_t &len);
+    const char* get_typename(void) const { return "buffered"; }
+
+private:
+    FILE*    _fp;
+    uint8_t* _buf;
+    size_t   _chunksize;
+};
+
+/**
+ * @brief maps the whole file into the address space and hands it out as one span.
+ * Only available on POSIX systems; elsewhere valid is always false.
+ */
+class ByteSourceMmap : public ByteSource {
+public:
+    ByteSourceMmap(const std::string & filename);
+    ~ByteSourceMmap();
+    bool next_span(const uint8_t* &data, size_t &len);
+    const uint8_t* get_data(void) const { return _data; }
+    const char* get_typename(void) const { return "mmap"; }
+
+private:
+    uint8_t* _data;
+};
+
+/**
+ * @brief a view on memory owned by someone else, e.g., a slice of a mapped file
+ */
+class ByteSourceMemory : public ByteSource {
+public:
+    ByteSourceMemory(const uint8_t* data, size_t len);
+    bool next_span(const uint8_t* &data, size_t &len);
+    const uint8_t* get_data(void) const { return _data; }
+    const char* get_typename(void) const { return "memory"; }
+
+private:
+    const uint8_t* _data;
+};
+
+/**
+ * @brief reads a ByteSource message by message: hands out pointers to the next n bytes,
+ * which point right into the source if the bytes are in one span (always the case with
+ * mmap), or else into an internal buffer. Never reads beyond the end or the limit.
+ */
+class ByteCursor {
+public:
+    ByteCursor() : _src(NULL), _span(NULL), _span_len(0), _span_pos(0), _pos(0), _end(0) {}
+
+    /**
+     * @brief start at the beginning of the given source; does not take ownership
+     */
+    void reset(ByteSource*src);
+
+    /**
+     * @brief get the next n bytes
+     * @return pointer to them (valid until next call), or NULL if there are not enough.
+     * In the latter case, the cursor is at the end.
+     */
+    inline const uint8_t* read(size_t n) {
+        if (_pos + n > _end) {
+            _pos = _end; // incomplete; nothing useful left
+            return NULL;
+        }
+        // usual case, and always with mmap: everything in the current span
+        if (_span_len - _span_pos >= n) {
+            const uint8_t*const ret = _span + _span_pos;
+            _span_pos += n;
+            _pos += n;
+            return ret;
+        }
+        return _read_across(n);
+    }
+
+    bool skip(size_t n) { return n == 0 || NULL != read(n); }
+
+    /**
+     * @brief next byte without consuming it
+     * @return -1 at the end
+     */
+    int peek(void);
+
+    /**
+     * @brief stop at the given position, even if the source has more
+     */
+    void set_limit(uint64_t end);
+
+    uint64_t get_position(void) const { return _pos; }
+    bool at_end(void) const { return _pos >= _end; }
+
+private:
+    const uint8_t* _read_across(size_t n);
+    bool _next_span(void);
+
+    ByteSource*          _src;
+    const uint8_t*       _span;     ///< current piece of the source
+    size_t               _span_len;
+    size_t               _span_pos;
+    std::vector<uint8_t> _carry;    ///< for reads crossing the end of a span
+    uint64_t             _pos;      ///< position in source
+    uint64_t             _end;      ///< min(size, limit)
+};
+
+#endif // BYTESOURCE_H
@@ -26,6 +26,7 @@
 #include <getopt.h>
 #include "cmdlineargs.h"
 #include "filefun.h"
+#include "stringfun.h"
 
 using namespace std;
 
@@ -36,6 +37,12 @@ void CmdlineArgs::_print_usage(FILE * stream) const {
             "  -n  --headless        start without GUI\n"
             "  -j  --max-time-jumps  define max. allowed time jumps between messages (in seconds, default: 100)\n"
             "  -i  --import          Import file to Database\n"
+            "  -b  --benchmark <x>   run benchmark x and exit (tlog, tlog-parallel, ulog, px4log, apmlog, ingest, mavlink-decode, merge, merge-series, resample, stats-window, plot-lod, all). Uses given files or synthetic data\n"
+            "  -s  --bench-size <MB> size of synthetic benchmark data (default: 2048)\n"
+            "  -t  --threads <n>     parse tlogs with n threads in headless mode (default: 1)\n"
+            "  -m  --msgids <a,b,..> decode only these MAVLink message ids in headless mode\n"
+            "  -y  --sysids <a,b,..> decode only these MAVLink systems in headless mode\n"
+            "  -x  --index           keep a message index next to each tlog (<file>.idx) for -m/-y\n"
             "  -h  --help            shows this\n"
             );
 }
@@ -52,14 +59,30 @@ bool CmdlineArgs::_file_exists(std::string filename) {
     return false;
 }
 
+void CmdlineArgs::_parse_idlist(const char*str, std::set<unsigned int> &ids) {
+    vector<string> elems;
+    string_split(str, ',', elems);
+    for (vector<string>::iterator it = elems.begin(); it != elems.end(); ++it) {
+        string_trim(*it);
+        if (it->empty()) continue;
+        ids.insert(atoi(it->c_str()));
+    }
+}
+
 int CmdlineArgs::_parse(int argc, char**argv) {
-    const char *const short_options = "hnj:i"; /* A string listing valid short options letters.  */
+    const char *const short_options = "hnj:ib:s:t:m:y:x"; /* A string listing valid short options letters.  */
     /* An array describing valid long options.  */
     const struct option long_options[] = {
         {"help",           0, NULL, 'h'},
         {"max-time-jumps", 1, NULL, 'j'},
         {"headless",       0, NULL, 'n'},
         {"import",         0, NULL, 'i'},   // Bernd
+        {"benchmark",      1, NULL, 'b'},
+        {"bench-size",     1, NULL, 's'},
+        {"threads",        1, NULL, 't'},
+        {"msgids",         1, NULL, 'm'},
+        {"sysids",         1, NULL, 'y'},
+        {"index",          0, NULL, 'x'},
         {NULL, 0, NULL, 0}             /* Required at end of array.  */
     };
 
@@ -79,6 +102,40 @@ int CmdlineArgs::_parse(int argc, char**argv) {
             import = true;
             break;
 
+        case 'b':
+            benchmark = optarg;
+            break;
+
+        case 's':
+            {
+                int cand = atoi(optarg);
+                if (cand > 0) {
+                    benchmark_size_mb = cand;
+                }
+            }
+            break;
+
+        case 't':
+            {
+                int cand = atoi(optarg);
+                if (cand > 0) {
+                    threads = cand;
+                }
+            }
+            break;
+
+        case 'm':
+            _parse_idlist(optarg, msgids);
+            break;
+
+        case 'y':
+            _parse_idlist(optarg, sysids);
+            break;
+
+        case 'x':
+            use_index = true;
+            break;
+
         case 'h':
             _print_usage(stdout);
             exit (0); // FIXME: it is a bit rude for the caller
@@ -115,7 +172,7 @@ int CmdlineArgs::_parse(int argc, char**argv) {
     return 0;
 }
 
-CmdlineArgs::CmdlineArgs(int argc, char **argv) : valid(false), headless(false), time_maxjump_sec(100.), import(false){
+CmdlineArgs::CmdlineArgs(int argc, char **argv) : valid(false), headless(false), time_maxjump_sec(100.), import(false), benchmark_size_mb(2048), threads(1), use_index(false) {
     if (!_parse(argc, argv)) {
         valid=true;
     }
@@ -25,6 +25,7 @@
 #define CMDLINEARGS_H
 
 #include <list>
+#include <set>
 #include <string>
 
 class CmdlineArgs
@@ -41,10 +42,17 @@ public:
     double time_maxjump_sec; ///< how much time is allowed to jump between two successive messages
 
     bool import;               ///Bernd: anaylize File to test DB-Import
+    std::string benchmark;     ///< if not empty: run this benchmark instead of GUI/headless ("all" for all)
+    unsigned int benchmark_size_mb; ///< size of synthetic input for benchmarks
+    unsigned int threads;      ///< number of threads for parsing; 1 means sequential
+    std::set<unsigned int> msgids; ///< if not empty: decode only these MAVLink messages (headless)
+    std::set<unsigned int> sysids; ///< if not empty: decode only these MAVLink systems (headless)
+    bool use_index;            ///< keep an index of the messages next to tlogs
 private:
     int _parse(int argc, char**argv);
     void _print_usage(FILE * stream) const;
     static bool _file_exists(std::string filename);
+    static void _parse_idlist(const char*str, std::set<unsigned int> & ids);
 
     /****************************************
      *   DATA MEMBERS
@@ -23,4 +23,16 @@
 
 #include "data.h"
 
-unsigned int Data::_autoincrement = 0; ///< initial value
+QAtomicInt Data::_autoincrement(0); ///< initial value
+
+bool Data::merge_in_all(const std::vector<const Data *> &others) {
+    bool ok = true;
+    for (std::vector<const Data*>::const_iterator it = others.begin(); it != others.end(); ++it) {
+        if (!merge_in(*it)) ok = false;
+    }
+    return ok;
+}
+
+bool Data::take_in_all(const std::vector<Data *> &others) {
+    return merge_in_all(std::vector<const Data*>(others.begin(), others.end()));
+}
@@ -25,6 +25,8 @@
 #define DATA_H
 
 #include <string>
+#include <vector>
+#include <QAtomicInt>
 #include "treeitem.h"
 #include "datagroup.h"
 #include "debugtype.h"
@@ -34,14 +36,14 @@ class Data : public TreeItem
 public:
     // CTOR
     Data(std::string name) : _valid (false), _name(name), _class(DATA_RAW), _time_epoch_datastart_usec(0), _deferredLoad(false), _dbid(0) {
-        _id = _autoincrement++;
+        _id = _autoincrement.fetchAndAddRelaxed(1);
         itemtype=DATA;
         parent = NULL;
     }
 
     // copy CTOR
     Data(const Data & other) {
-        _id = _autoincrement++; // ID is always unique
+        _id = _autoincrement.fetchAndAddRelaxed(1); // ID is always unique, also when parsers run in threads
         parent = other.parent;
         itemtype = other.itemtype;
         _valid = other._valid;
@@ -119,6 +121,20 @@ public:
      */
     virtual bool merge_in(const Data * const other) = 0;
 
+    /**
+     * @brief add data from several other instances at once. Same as merge_in() with each of them
+     * in turn, but subclasses can do it in one pass instead of re-copying what was merged before.
+     * @param others data that shall be merged in; they must be of the same subclass as this
+     * @return true if all of them were merged
+     */
+    virtual bool merge_in_all(const std::vector<const Data*> & others);
+
+    /**
+     * @brief same as merge_in_all(), but others are not needed anymore. Subclasses can take over
+     * their memory instead of copying it. Afterwards, others are in no defined state and must be deleted.
+     */
+    virtual bool take_in_all(const std::vector<Data*> & others);
+
     /**
      * @brief get statistics in a given time window. considering interpolation if t_min or t_max is between samples.
      * @param s holds the statistics.
@@ -155,6 +171,14 @@ public:
      */
     virtual bool is_present() const { return _valid; }        
 
+    /**
+     * @brief the range of all samples, e.g., for the axes of a plot
+     * @param tmin earliest time, in seconds UNIX epoch
+     * @param vmin smallest value
+     * @return false if the data has no samples with values
+     */
+    virtual bool get_bounds(double & /*tmin*/, double & /*tmax*/, double & /*vmin*/, double & /*vmax*/) const { return false; }
+
     /**
      * @brief every data should have units...leave empty if it doesn't apply
      * @return string with units
@@ -178,6 +202,20 @@ public:
      */
     virtual unsigned long get_epoch_dataend() const = 0;
 
+    /**
+     * @brief append the data points of another instance of the same type, as if
+     * they had been added one by one in their original order.
+     * @param other data of the same type
+     * @param first index of the first data point in other to be appended
+     * @return true if successful, false if not supported. Nothing is appended then.
+     */
+    virtual bool append_from(const Data * const /*other*/, unsigned int /*first*/) { return false; }
+
+    /**
+     * @brief whether append_from() would succeed with this other instance
+     */
+    virtual bool can_append_from(const Data * const /*other*/) const { return false; }
+
     /****************************************************
      *  FUNCTIONS THAT THIS ABSTRACT CLASS PROVIDES
      ****************************************************/
@@ -256,7 +294,7 @@ protected:
     bool                _valid;
     std::string         _name;    
     data_classifier_e   _class;
-    static unsigned int _autoincrement; ///< every data class get's a unique ID here.
+    static QAtomicInt   _autoincrement; ///< every data class get's a unique ID here.
     unsigned long       _time_epoch_datastart_usec; ///< absolute time when the data starts, expressed in epoch usec
     std::string         _units;
 
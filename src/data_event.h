@@ -159,68 +159,75 @@ public:
 
     // implements Data::merge_in() (DONE)
     bool merge_in(const Data * const other) {
-        const DataEvent*const src = dynamic_cast<const DataEvent*const>(other);
-        if (!src) return false;
-        if (!src->_valid) return false;
-        //if (_elems_time.empty()) return false;
+        return merge_in_all(std::vector<const Data*>(1, other));
+    }
+
+    // implements Data::merge_in_all()
+    bool merge_in_all(const std::vector<const Data*> & others) {
+        return _merge_in_all(others, false);
+    }
 
-        const double tmin_src = src->_elems_time.front() + src->_time_epoch_datastart_usec/1E6;
-        const double tmax_src = src->_elems_time.back() + src->_time_epoch_datastart_usec/1E6;
-        const double tmin_me = _elems_time.front() + _time_epoch_datastart_usec/1E6;
-        const double tmax_me = _elems_time.back() + _time_epoch_datastart_usec/1E6;
-        const double dt_sec = (_time_epoch_datastart_usec/1E6 - src->_time_epoch_datastart_usec / 1E6); ///< positive, if my data is more recent
+    // implements Data::take_in_all()
+    bool take_in_all(const std::vector<Data*> & others) {
+        return _merge_in_all(std::vector<const Data*>(others.begin(), others.end()), true);
+    }
+
+    // implements Data::append_from()
+    bool append_from(const Data * const other, unsigned int first) {
+        if (!can_append_from(other)) return false;
+        const DataEvent*const src = static_cast<const DataEvent*const>(other);
+        for (unsigned int k=first; k < src->_elems_time.size(); ++k) {
+            add_elem(src->_elems_data[k], src->_elems_time[k]);
+        }
+        return true;
+    }
+
+    // implements Data::can_append_from()
+    bool can_append_from(const Data * const other) const {
+        return dynamic_cast<const DataEvent*const>(other) != NULL;
+    }
+
+private:
+    /**
+     * @brief see merge_in_all(); if consume is true, the sources' buffers are taken over or freed
+     */
+    bool _merge_in_all(const std::vector<const Data*> & others, bool consume) {
+        bool ok = true;
+        std::vector<const DataEvent*> srcs;
+        for (std::vector<const Data*>::const_iterator it = others.begin(); it != others.end(); ++it) {
+            const DataEvent*const src = dynamic_cast<const DataEvent*const>(*it);
+            if (!src || !src->_valid) {
+                ok = false;
+                continue;
+            }
+            if (!src->_elems_time.empty()) srcs.push_back(src);
+        }
+        if (srcs.empty()) return ok;
 
         /*
-         * we want no negative time stamps, so adjust all *my* relative times by
-         * applying the offset between src and me to *me*
+         * we want no negative time stamps, so the earliest start becomes the new reference,
+         * and all relative times are corrected by their offset to it
          */
-        if (dt_sec > 0.) {
-            _time_epoch_datastart_usec = src->_time_epoch_datastart_usec;
-            for (std::vector<double>::iterator it = _elems_time.begin(); it != _elems_time.end(); ++it) {
-                *it += dt_sec;  ///< correct my relative times
-            }
+        unsigned long epoch = _time_epoch_datastart_usec;
+        for (unsigned int k=0; k < srcs.size(); ++k) {
+            if (srcs[k]->_time_epoch_datastart_usec < epoch) epoch = srcs[k]->_time_epoch_datastart_usec;
         }
 
         /*****************
          *  MERGING IN
          *****************/
-        const bool do_fast_merge = (tmax_src < tmin_me) || (tmin_src > tmax_me); ///< checks for non-overlapping time ranges
-        if (do_fast_merge) {
-            if (dt_sec > 0.) {
-                // PREPEND: my data is later (other earlier). we want no negative time stamps, so adjust all my relative times by adding apply the offset from src
-                _elems_time.insert(_elems_time.begin(), src->_elems_time.begin(), src->_elems_time.end()); ///< prepend time
-                _elems_data.insert(_elems_data.begin(), src->_elems_data.begin(), src->_elems_data.end()); ///< prepend data
-            } else {
-                // APPEND: my data is older (other more recent). adjust other data's time relative time stamps by adding the offset to it
-                for (std::vector<double>::const_iterator it = src->_elems_time.begin(); it != src->_elems_time.end(); ++it) {
-                    _elems_time.push_back(*it - dt_sec); ///< correct other's time stamp and append at the same time
-                }
-                _elems_data.insert(_elems_data.end(), src->_elems_data.begin(), src->_elems_data.end()); ///< append data
-            }
-        } else {                        
-            // INSERT: data is overlapping...we have to sort-in every single data item
-            for (unsigned int k=0; k<src->_elems_time.size(); ++k) {
-                double tsrc = src->_elems_time[k];
-                if (dt_sec < 0.) {
-                    // adjust source's time
-                    tsrc = src->_elems_time[k] - dt_sec;
-                }
-                T datasrc = src->_elems_data[k];
-                std::vector<double>::iterator first_greater_time = std::upper_bound(_elems_time.begin(), _elems_time.end(), tsrc); // returns iterator to first element t1 where t1 > t holds true
-                if (first_greater_time != _elems_time.end()) {
-                    // insert before first_greater
-                    typename std::vector<T>::iterator first_greater_data = _elems_data.begin() + (first_greater_time - _elems_time.begin()); // calc index from iterator
-                    _elems_time.insert(first_greater_time, tsrc);
-                    _elems_data.insert(first_greater_data, datasrc);
-                } else {
-                    // there was none greater...append
-                    _elems_time.push_back(tsrc);
-                    _elems_data.push_back(datasrc);
-                }
-            }
+        std::vector<run_t<std::vector<double>, std::vector<T> > > runs(srcs.size());
+        for (unsigned int k=0; k < srcs.size(); ++k) {
+            runs[k].time = &srcs[k]->_elems_time;
+            runs[k].data = &srcs[k]->_elems_data;
+            runs[k].offset = (srcs[k]->_time_epoch_datastart_usec - epoch)/1E6;
         }
-        _n+= src->_elems_data.size();
-        return true;
+        for (unsigned int k=0; k < srcs.size(); ++k) {
+            _n+= srcs[k]->_elems_data.size();
+        }
+        _merge_runs(_elems_time, _elems_data, (_time_epoch_datastart_usec - epoch)/1E6, runs, consume);
+        _time_epoch_datastart_usec = epoch;
+        return ok;
     }
 };
 
@@ -128,6 +128,19 @@ public:
          */
         return false;
     }
+
+    // implements Data::append_from(): the most recent value wins
+    bool append_from(const Data * const other, unsigned int /*first*/) {
+        if (!can_append_from(other)) return false;
+        const DataParam*const src = static_cast<const DataParam*const>(other);
+        if (src->_valid) add_elem(src->_elem);
+        return true;
+    }
+
+    // implements Data::can_append_from()
+    bool can_append_from(const Data * const other) const {
+        return dynamic_cast<const DataParam*const>(other) != NULL;
+    }
 };
 
 #endif // DATA_PARAM_H
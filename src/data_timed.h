@@ -23,6 +23,10 @@
 #ifndef DATA_TIMED_H
 #define DATA_TIMED_H
 
+#include <vector>
+#include <queue>
+#include <utility>
+#include <math.h>
 #include "data.h"
 
 /**
@@ -51,6 +55,129 @@ public:
     virtual void make_periodic() = 0;
 
 protected:
+    /**
+     * @brief one sorted piece of a timeseries for _merge_runs()
+     */
+    template <typename TC, typename DC>
+    struct run_t {
+        const TC* time;
+        const DC* data;
+        double    offset; ///< added to each time
+    };
+
+    /**
+     * @brief merges several time-sorted runs into time and data, which are sorted as well, in one pass.
+     * The result is built in place, from the back, so nothing but time and data grow. At equal times,
+     * time and data come first, then the runs in the order given, just like with std::merge.
+     * @param time, data columns with std::vector's interface, e.g., SegmentedVector
+     * @param offset added to each of time
+     * @param consume if true, the vectors of the runs are not needed anymore. If time is empty, the
+     * first run is then taken over instead of copied, and all are left empty.
+     */
+    template <typename TC, typename DC>
+    static void _merge_runs(TC & time, DC & data, double offset,
+                            const std::vector<run_t<TC, DC> > & runs, bool consume = false) {
+        unsigned int first = 0; ///< runs before are in time and data already
+        if (consume && time.empty()) {
+            while (first < runs.size() && runs[first].time->empty()) ++first;
+            if (first == runs.size()) return;
+            time.swap(*const_cast<TC*>(runs[first].time));
+            data.swap(*const_cast<DC*>(runs[first].data));
+            offset = runs[first].offset;
+            ++first;
+        }
+        const size_t nmine = time.size();
+        size_t total = nmine;
+        for (unsigned int k=first; k < runs.size(); ++k) total += runs[k].time->size();
+        time.resize(total);
+        data.resize(total);
+
+        // the usual case, one other run: no need for a queue
+        unsigned int nother = 0, other = 0;
+        for (unsigned int k=first; k < runs.size(); ++k) {
+            if (!runs[k].time->empty()) {
+                ++nother;
+                other = k;
+            }
+        }
+        if (nother == 1) {
+            const TC & rt = *runs[other].time;
+            const DC & rd = *runs[other].data;
+            const double roff = runs[other].offset;
+            size_t i = nmine, j = rt.size(), w = total;
+            while (j > 0) {
+                if (i > 0 && time[i-1] + offset > rt[j-1] + roff) {
+                    --i;
+                    --w;
+                    time[w] = time[i] + offset;
+                    data[w] = data[i];
+                } else {
+                    --j;
+                    --w;
+                    time[w] = rt[j] + roff;
+                    data[w] = rd[j];
+                }
+            }
+            if (offset != 0.) {
+                for (size_t k=0; k < w; ++k) time[k] += offset;
+            }
+            if (consume) _release_run(runs[other]);
+            return;
+        }
+
+        /*
+         * k-way merge from the back: always take the latest tail, on ties the one of the later run.
+         * Ours is run 0 and is read from the front part of the same vectors, which is never overwritten
+         * before it is read, because there is always as much space behind it as the others have left.
+         */
+        typedef std::pair<double, unsigned int> tail_t;
+        std::priority_queue<tail_t> tails;
+        std::vector<size_t> left(1 + runs.size(), 0); ///< per run, how many are not yet merged
+        left[0] = nmine;
+        if (nmine > 0) tails.push(std::make_pair(time[nmine - 1] + offset, 0u));
+        for (unsigned int k=first; k < runs.size(); ++k) {
+            left[k+1] = runs[k].time->size();
+            if (left[k+1] > 0) tails.push(std::make_pair(runs[k].time->back() + runs[k].offset, k+1));
+        }
+        size_t w = total;
+        while (!tails.empty()) {
+            const tail_t h = tails.top();
+            tails.pop();
+            if (h.second == 0 && tails.empty()) break; // the rest of ours is where it belongs
+            const TC & rt = h.second ? *runs[h.second-1].time : time;
+            const DC & rd = h.second ? *runs[h.second-1].data : data;
+            const double roff = h.second ? runs[h.second-1].offset : offset;
+            size_t & p = left[h.second];
+            // take everything from this run until another tail is later
+            const double tnext = tails.empty() ? -INFINITY : tails.top().first;
+            const unsigned int knext = tails.empty() ? 0 : tails.top().second;
+            do {
+                --p;
+                --w;
+                time[w] = rt[p] + roff;
+                data[w] = rd[p];
+            } while (p > 0 && (rt[p-1] + roff > tnext || (rt[p-1] + roff == tnext && h.second > knext)));
+            if (p > 0) {
+                tails.push(std::make_pair(rt[p-1] + roff, h.second));
+            } else if (consume && h.second) {
+                _release_run(runs[h.second-1]);
+            }
+        }
+        // what is left of ours did not move, but its time may need to
+        if (offset != 0.) {
+            for (size_t k=0; k < w; ++k) time[k] += offset;
+        }
+    }
+
+    /**
+     * @brief frees the memory of a run that was consumed by _merge_runs()
+     */
+    template <typename TC, typename DC>
+    static void _release_run(const run_t<TC, DC> & r) {
+        TC().swap(*const_cast<TC*>(r.time));
+        DC().swap(*const_cast<DC*>(r.data));
+    }
+
     bool _bad_timestamps;
 };
 
@@ -37,6 +37,8 @@
 #include <math.h>
 #include <iomanip>
 #include "data_timed.h"
+#include "segmentedvector.h"
+#include "summarypyramid.h"
 #include "time_fun.h"
 
 
@@ -51,13 +53,10 @@ class DataTimeseries : public DataTimed {
 private:
     typedef std::pair<double,T> datapair; ///< one item in the timeline is this
 
-    struct TimedSample{
-        double time;
-        T data;
-        bool operator<(const TimedSample& r){ return time < r.time; }
-    };
-
 public:
+    typedef SegmentedVector<double> timevector; ///< see get_time()
+    typedef SegmentedVector<T>      datavector; ///< see get_data()
+
     /**
      * @brief Statistics
      * @param keepitems if true then individual items are stored.
@@ -69,6 +68,7 @@ public:
     void _defaults() {
         _min_valid = false;
         _max_valid = false;
+        _min = _max = T(); // meaningless until valid, but deterministic
         _sqsum = _sum = 0.;
         _n = 0;
         _min_t = INFINITY;
@@ -90,6 +90,7 @@ public:
         _min = other._min;
         _max_t = other._max_t;
         _min_t = other._min_t;
+        _summary = other._summary;
     }
 
     /**
@@ -131,6 +132,7 @@ public:
         _defaults();
         _elems_data.clear();
         _elems_time.clear();
+        _summary.clear();
         _time_epoch_datastart_usec = 0;
     }
 
@@ -169,8 +171,14 @@ public:
         _valid = true;
     }
 
-    double get_stddev() const {        
-        return sqrt(_sqsum/pow(_sum,2));
+    /**
+     * @return standard deviation of all values (of the population, not the sample)
+     */
+    double get_stddev() const {
+        if (_n == 0) return NAN;
+        const double avg = _sum/((double)_n);
+        const double var = _sqsum/((double)_n) - avg*avg;
+        return var > 0. ? sqrt(var) : 0.;
     }
 
     double get_average() const {
@@ -199,49 +207,77 @@ public:
     }
 
     /**
-     * @brief _get_index_of_time
+     * @brief reads the series at a sequence of times, like get_data_at_time(). It continues where the
+     * previous call stopped, so a sweep over increasing times costs amortized O(1) per call instead
+     * of a binary search. Going back in time is allowed, but costs a binary search again.
+     * The series must not change while a cursor is in use.
+     */
+    class Cursor {
+    public:
+        /**
+         * @param ts may be NULL, then there is never any data
+         */
+        explicit Cursor(const DataTimeseries * ts) : _ts(ts), _k(0) {}
+
+        /**
+         * @brief same as DataTimeseries::get_data_at_time()
+         */
+        bool get_data_at_time(double timeinstant, T &val) {
+            if (!_ts) return false;
+            if (timeinstant > _ts->_max_t || timeinstant < _ts->_min_t) return false; // extrapolation not supported
+
+            const timevector & time = _ts->_elems_time;
+            if (_k > 0 && time[_k - 1] >= timeinstant) {
+                // backwards
+                _k = std::lower_bound(time.begin(), time.begin() + _k, timeinstant).index();
+            } else {
+                // forward: the next sample is usually close, otherwise search the rest
+                unsigned int steps = 0;
+                while (_k < time.size() && time[_k] < timeinstant) {
+                    if (++steps > LINEAR_STEPS) {
+                        _k = std::lower_bound(time.begin() + _k, time.end(), timeinstant).index();
+                        break;
+                    }
+                    ++_k;
+                }
+            }
+            return _ts->_get_data_at_index(_k, timeinstant, val);
+        }
+
+    private:
+        static const unsigned int LINEAR_STEPS = 8;
+
+        const DataTimeseries*_ts;
+        size_t               _k; ///< first sample at or after the time of the previous call
+    };
+    friend class Cursor;
+
+    /**
+     * @brief _get_index_of_time, O(log n). Time must be ordered.
      * @param timeinstant time to search for
-     * @param idx returns the index, which is >= time
-     * @return if true, then idx is valid, otherwise not found
+     * @param idx_before returns the index of the last sample <= timeinstant
+     * @param idx_after returns the index of the first sample >= timeinstant
+     * @return if true, then indices are valid, otherwise not found
      */
     bool _get_index_of_time(double timeinstant, unsigned int & idx_before, unsigned int & idx_after) const {
         if (timeinstant > _max_t || timeinstant < _min_t) return false; // extrapolation not supported
 
-        // find item which is >= timeinstant
-        double t_pre=0.;
-        bool first = true;
-        for(unsigned int k=0; k< _elems_time.size(); ++k) {
-            const double t = _elems_time[k];
-            // assumption: vector is ordered by time
-            if (first) {
-                t_pre = t;
-                first = false;
-            }
-            //assert(t >= t_pre);
-            if (!t >= t_pre) {
-                std::cerr << "time is non-monotonic in data " << this->get_fullname(this) << std::endl;
-                return false;
-            }
-            // --
-            if (t == timeinstant) {
-                idx_before = k;
-                idx_after = k;
-                return true;
-            } else if (t > timeinstant) {
-                // lin. interpolate
-                if (k > 0) {
-                    idx_before = k - 1;
-                    idx_after = k;
-                    return true;
-                }
-            }
-            t_pre = t;
+        const size_t k = std::lower_bound(_elems_time.begin(), _elems_time.end(), timeinstant).index();
+        if (k >= _elems_time.size()) return false;
+        if (_elems_time[k] == timeinstant) {
+            idx_before = k;
+            idx_after = k;
+            return true;
         }
-        return false;
+        if (k == 0) return false;
+        idx_before = k - 1;
+        idx_after = k;
+        return true;
     }
 
     /**
      * @brief gets the value of the timeseries that belongs to time instant 'timeinstant'. If there is no data point, it interpolates.
+     * Use a Cursor for many increasing times.
      * @param timeinstant time at which the value shall be retrieved, internal relative time!!
      * @param val value will be written to here
      * @return true if value could be calculated, else false
@@ -249,26 +285,8 @@ public:
     bool get_data_at_time(double timeinstant, T &val) const {
         if (timeinstant > _max_t || timeinstant < _min_t) return false; // extrapolation not supported
 
-        unsigned int idx_before = UINT_MAX;
-        unsigned int idx_after = 0;
-        bool ret = _get_index_of_time(timeinstant, idx_before, idx_after);
-        if (!ret) return false;
-
-        assert(idx_before <= idx_after);
-        if (idx_before == idx_after) {
-            // hit a sample
-            val = _elems_data[idx_before];
-            return true;
-        } else {
-            // betweem samples; need interpolation
-            const double val_pre = _elems_data[idx_before];
-            const double val_post = _elems_data[idx_after];
-            const double t_post = _elems_time[idx_after];
-            const double t_pre = _elems_time[idx_before];
-            const double m = (val_post-val_pre)/(t_post-t_pre);
-            val = val_pre + (timeinstant - t_pre)*m;
-            return true;
-        }
+        const size_t k = std::lower_bound(_elems_time.begin(), _elems_time.end(), timeinstant).index();
+        return _get_data_at_index(k, timeinstant, val);
     }
 
     /**
@@ -320,65 +338,37 @@ public:
         // we have the limits
         s.n_samples = idx_max_pre - idx_min_post + 1;
 
-        double sum = 0.;
-        double sumsq = 0.;
-        double first = true;
-        unsigned int n_samples_int = 0; // internally we may use more samples. The returned struct says "samples in between", but we may interpolate at beginning and end.
-
-        // do we need to interpolate at the beginning?
-        if (idx_min_pre != idx_min_post) {
-            // yes
-            T val;
-            if (get_data_at_time(tmin, val)) {
-                s.min = (double)val;
-                s.max = (double)val;
-                first = false;
-                sum += val;
-                sumsq += (val*val);
-                n_samples_int++;
-            }
-        }
-
-        // run over the samples now
-        for (unsigned int k = idx_min_post; k <= idx_max_pre; k++) {
-            const T val = _elems_data[k];
-            if (first) {
-                s.min = (double)val;
-                s.max = (double)val;
-                first = false;
-            } else {
-                s.min = (val < s.min) ? val : s.min;
-                s.max = (val > s.max) ? val : s.max;
-            }
-            sum += val;
-            sumsq += (val*val);
+        /*
+         * the samples in between: min and max from the pyramid, the sums from the prefix sums.
+         * Internally we may use more samples: the returned struct says "samples in between", but
+         * we may interpolate at beginning and end.
+         */
+        const SummaryPyramid<T> & summary = _get_summary(true);
+        const typename SummaryPyramid<T>::summary_t sm = summary.summarize(_elems_time, _elems_data, idx_min_post, idx_max_pre + 1);
+        double vmin = sm.min, vmax = sm.max, sum, sumsq;
+        unsigned int n_finite;
+        summary.sums(idx_min_post, idx_max_pre + 1, sum, sumsq, n_finite);
+        unsigned int n_samples_int = sm.count;
+
+        // do we need to interpolate at the beginning, and at the end?
+        T val;
+        if (idx_min_pre != idx_min_post && get_data_at_time(tmin, val)) {
+            _add_stats_sample(val, summary.get_ref(), vmin, vmax, sum, sumsq, n_finite);
             n_samples_int++;
         }
-
-        // do we need to interpolate at the end?
-        if (idx_max_pre != idx_max_post) {
-            // yes
-            T val;
-            if (get_data_at_time(tmax, val)) {
-                if (first) {
-                    s.min = val;
-                    s.max = val;
-                    first = false;
-                } else {
-                    s.min = (val < s.min) ? val : s.min;
-                    s.max = (val > s.max) ? val : s.max;
-                }
-                sum += val;
-                sumsq += (val*val);
-                n_samples_int++;
-            }
+        if (idx_max_pre != idx_max_post && get_data_at_time(tmax, val)) {
+            _add_stats_sample(val, summary.get_ref(), vmin, vmax, sum, sumsq, n_finite);
+            n_samples_int++;
         }
 
-        // finally: complete stats
-        sum /= n_samples_int;
-        sumsq /= n_samples_int;
-        s.avg = sum;
-        s.stddev = sqrt(sumsq - sum*sum);
+        // finally: complete stats. The average is over the finite values only.
+        sum /= n_finite;
+        sumsq /= n_finite;
+        const double var = sumsq - sum*sum;
+        s.min = vmin;
+        s.max = vmax;
+        s.avg = summary.get_ref() + sum;
+        s.stddev = var > 0. ? sqrt(var) : 0.;
         s.t_min = tmin;
         s.t_max = tmax;
         const double dt = tmax - tmin;
@@ -386,6 +376,87 @@ public:
         return true;
     }
 
+    // implements Data::get_bounds()
+    bool get_bounds(double & tmin, double & tmax, double & vmin, double & vmax) const {
+        if (_elems_time.empty()) return false;
+        const typename SummaryPyramid<T>::summary_t sm = _get_summary().summarize(_elems_time, _elems_data, 0, _elems_time.size());
+        const double time_offset = _time_epoch_datastart_usec /1E6;
+        tmin = sm.t_first + time_offset;
+        tmax = sm.t_last + time_offset;
+        vmin = sm.min;
+        vmax = sm.max;
+        return true;
+    }
+
+    /**
+     * @brief picks the samples needed to draw the series between tmin and tmax (absolute time)
+     * on a width of n pixels: per pixel the first, the smallest, the largest and the last one.
+     * The lines between them then cover the same pixels as the lines between all samples.
+     * Besides, the last sample before tmin and the first after tmax, so that the lines leave the view.
+     * Costs O(n log N) for N samples, instead of O(N).
+     * @param idx returns the indices of the samples, ascending
+     */
+    void get_lod_indices(double tmin, double tmax, unsigned int n, std::vector<size_t> & idx) const {
+        idx.clear();
+        if (_elems_time.empty() || n == 0 || !(tmin <= tmax)) return;
+
+        // convert the absolute time to time of this series
+        const double time_offset = _time_epoch_datastart_usec /1E6;
+        tmin -= time_offset;
+        tmax -= time_offset;
+
+        const size_t first = std::lower_bound(_elems_time.begin(), _elems_time.end(), tmin).index();
+        const size_t end = std::upper_bound(_elems_time.begin() + first, _elems_time.end(), tmax).index();
+        if (first > 0) idx.push_back(first - 1);
+
+        if (end - first <= 4*((size_t)n)) {
+            // not more than we would pick anyway
+            for (size_t k=first; k < end; ++k) idx.push_back(k);
+        } else {
+            const SummaryPyramid<T> & summary = _get_summary();
+            const double dt = (tmax - tmin) / n;
+            size_t b0 = first;
+            for (unsigned int p=0; p < n && b0 < end; ++p) {
+                const size_t b1 = (p + 1 == n) ? end : std::lower_bound(_elems_time.begin() + b0, _elems_time.begin() + end, tmin + dt*(p + 1)).index();
+                if (b1 == b0) continue; // empty pixel
+
+                const typename SummaryPyramid<T>::summary_t sm = summary.summarize(_elems_time, _elems_data, b0, b1);
+                size_t pick[4] = { b0, b0, b0, b1 - 1 };
+                if (sm.k_min != SummaryPyramid<T>::NONE) {
+                    pick[1] = std::min(sm.k_min, sm.k_max);
+                    pick[2] = std::max(sm.k_min, sm.k_max);
+                }
+                for (unsigned int j=0; j < 4; ++j) {
+                    if (idx.empty() || pick[j] > idx.back()) idx.push_back(pick[j]);
+                }
+                b0 = b1;
+            }
+        }
+        if (end < _elems_time.size()) idx.push_back(end);
+    }
+
+    /**
+     * @brief where the smallest and the largest value between tmin and tmax (absolute time) are,
+     * the first ones on ties. NAN is ignored. O(log N), from the summary.
+     * @return false if there is no such value
+     */
+    bool get_extrema_index(double tmin, double tmax, size_t & kmin, size_t & kmax) const {
+        if (_elems_time.empty() || !(tmin <= tmax)) return false;
+
+        // convert the absolute time to time of this series
+        const double time_offset = _time_epoch_datastart_usec /1E6;
+        tmin -= time_offset;
+        tmax -= time_offset;
+
+        const size_t first = std::lower_bound(_elems_time.begin(), _elems_time.end(), tmin).index();
+        const size_t end = std::upper_bound(_elems_time.begin() + first, _elems_time.end(), tmax).index();
+        const typename SummaryPyramid<T>::summary_t sm = _get_summary().summarize(_elems_time, _elems_data, first, end);
+        if (sm.k_min == SummaryPyramid<T>::NONE) return false;
+        kmin = sm.k_min;
+        kmax = sm.k_max;
+        return true;
+    }
+
     /**
      * @brief get_max
      * @return maximum VALUE of data series
@@ -399,11 +470,11 @@ public:
         return ((unsigned long) _elems_time.back()*1E6) + get_epoch_datastart();
     }
 
-    const std::vector<double>& get_time() const {
+    const timevector& get_time() const {
         return _elems_time;
     }
 
-    const std::vector<T>& get_data() const {
+    const datavector& get_data() const {
         return _elems_data;
     }
 
@@ -466,6 +537,7 @@ public:
         for (unsigned int k=0; k<_elems_time.size(); ++k) {
             _elems_time[k] = t0 + dt*k;
         }
+        _summary.invalidate();
 
         _bad_timestamps = false;
         _class = DATA_DERIVED;
@@ -500,107 +572,42 @@ public:
 
     // implements Data::merge_in()
     bool merge_in(const Data * const other) {
-        const DataTimeseries*const src = dynamic_cast<const DataTimeseries*const>(other);
-        if (!src) return false;
-        if (!src->_valid) return false;
-
-        const double tmin_src = src->_elems_time.front() + src->_time_epoch_datastart_usec/1E6;
-        const double tmax_src = src->_elems_time.back() + src->_time_epoch_datastart_usec/1E6;
-        const double tmin_me = _elems_time.front() + _time_epoch_datastart_usec/1E6;
-        const double tmax_me = _elems_time.back() + _time_epoch_datastart_usec/1E6;
-        const double dt_sec = (_time_epoch_datastart_usec/1E6 - src->_time_epoch_datastart_usec / 1E6); ///< positive, if my data is more recent
-
-        /*
-         * we want no negative time stamps, so adjust all *my* relative times by
-         * applying the offset between src and me to *me*
-         */
-        if (dt_sec > 0.) {
-            _time_epoch_datastart_usec = src->_time_epoch_datastart_usec;
-            for (std::vector<double>::iterator it = _elems_time.begin(); it != _elems_time.end(); ++it) {
-                *it += dt_sec;  ///< correct my relative times
-            }
-        }
-
-        /*****************
-         *  MERGING IN
-         *****************/
-        _elems_time.reserve(_elems_time.size()+src->_elems_time.size());
-        _elems_data.reserve(_elems_data.size()+src->_elems_data.size());
-        const bool do_fast_merge = (tmax_src < tmin_me) || (tmin_src > tmax_me); ///< checks for non-overlapping time ranges
-        if (do_fast_merge) {
-            if (dt_sec > 0.) {
-                // PREPEND: my data is later (other earlier). we want no negative time stamps, so adjust all my relative times by adding apply the offset from src
-                _elems_time.insert(_elems_time.begin(), src->_elems_time.begin(), src->_elems_time.end()); ///< prepend time
-                _elems_data.insert(_elems_data.begin(), src->_elems_data.begin(), src->_elems_data.end()); ///< prepend data
-            } else {
-                // APPEND: my data is older (other more recent). adjust other data's time relative time stamps by adding the offset to it
-                for (std::vector<double>::const_iterator it = src->_elems_time.begin(); it != src->_elems_time.end(); ++it) {
-                    _elems_time.push_back(*it - dt_sec); ///< correct other's time stamp and append at the same time
-                }
-                _elems_data.insert(_elems_data.end(), src->_elems_data.begin(), src->_elems_data.end()); ///< append data
-            }
-        } else {
-            // INSERT: data is overlapping...we have to sort-in every single data item
+        return merge_in_all(std::vector<const Data*>(1, other));
+    }
 
-            //merge time and data arrays into one array (SOA to AOS) for both our data and other data
-            std::vector<TimedSample> own(_elems_time.size());
-            for (size_t cnt = 0; cnt < _elems_time.size(); cnt++) {
-                TimedSample s = {_elems_time[cnt], _elems_data[cnt]};
-                own[cnt] = s;
-            }
+    // implements Data::merge_in_all()
+    bool merge_in_all(const std::vector<const Data*> & others) {
+        return _merge_in_all(others, false);
+    }
 
-            std::vector<TimedSample> others(src->_elems_time.size());
-            for (size_t cnt = 0; cnt < src->_elems_time.size(); cnt++) {
-                TimedSample s = {src->_elems_time[cnt] - dt_sec, src->_elems_data[cnt]};
-                others[cnt] = s;
-            }
+    // implements Data::take_in_all()
+    bool take_in_all(const std::vector<Data*> & others) {
+        return _merge_in_all(std::vector<const Data*>(others.begin(), others.end()), true);
+    }
 
-            //merge the two series
-
-            //c++11:
-            //    assert(std::is_sorted(own.begin(),own.end()),"Other data is not sorted");
-            //    assert(std::is_sorted(others.begin(),others.end()),"Other data is not sorted");
-
-            const size_t total_size = _elems_time.size() + src->_elems_time.size();
-            std::vector<TimedSample> merged(total_size);
-            std::merge(
-                        own.begin(),
-                        own.end(),
-                        others.begin(),
-                        others.end(),
-                        merged.begin()
-                        );
-
-            //split array containing time and data back into separate arrays
-            _elems_time.resize(total_size);
-            _elems_data.resize(total_size);
-
-            for (std::size_t i = 0; i < total_size; ++i) {
-                _elems_time[i] = merged[i].time;
-                _elems_data[i] = merged[i].data;
-            }
+    // implements Data::append_from()
+    bool append_from(const Data * const other, unsigned int first) {
+        if (!can_append_from(other)) return false;
+        const DataTimeseries*const src = static_cast<const DataTimeseries*const>(other);
+        for (unsigned int k=first; k < src->_elems_time.size(); ++k) {
+            add_elem(src->_elems_data[k], src->_elems_time[k]); // same order of summation
         }
-
-        // correct the other class members
-        _sum+=src->_sum;
-        _sqsum+=src->_sqsum;
-        if (src->_max > _max) _max = src->_max;
-        if (src->_min < _min) _min = src->_min;
-        _min_t = _elems_time.front();
-        _max_t = _elems_time.back();
-        _n+= src->_elems_data.size();
-
         return true;
     }
 
+    // implements Data::can_append_from()
+    bool can_append_from(const Data * const other) const {
+        const DataTimeseries*const src = dynamic_cast<const DataTimeseries*const>(other);
+        return src && src->_keepitems;
+    }
+
 private:
     unsigned int    _n;
     bool            _keepitems;    
 
-    // FIXME: this storage format is not all that good...pairs would be nicer, but are harder to access
-    //std::vector< timeseries_elem >  _elems; // better but plotting would be tedious
-    std::vector<T>      _elems_data;    ///< only used if keepitems=true
-    std::vector<double> _elems_time;    ///< only used if keepitems=true
+    // blocks instead of one vector each, so that growing and merging never copies the whole series
+    datavector      _elems_data;    ///< only used if keepitems=true
+    timevector      _elems_time;    ///< only used if keepitems=true
 
     double          _sum;
     double          _sqsum;
@@ -610,6 +617,141 @@ private:
     double          _min_t;
     bool            _max_valid;
     bool            _min_valid;    
+    mutable SummaryPyramid<T> _summary; ///< for statistics of windows; brought up to date when needed
+
+    /**
+     * @brief the summary, after catching up with the samples added since
+     * @param with_sums also the prefix sums, which are only needed for statistics of windows
+     */
+    const SummaryPyramid<T>& _get_summary(bool with_sums=false) const {
+        _summary.update(_elems_time, _elems_data);
+        if (with_sums) _summary.update_sums(_elems_data);
+        return _summary;
+    }
+
+    /**
+     * @brief adds an interpolated value to the statistics of a window, see get_stats_timewindow()
+     */
+    static void _add_stats_sample(T val, double ref, double & vmin, double & vmax, double & sum, double & sumsq, unsigned int & n_finite) {
+        if (val < vmin) vmin = val;
+        if (val > vmax) vmax = val;
+        const double v = (double)val;
+        if (isnan(v) || isinf(v)) return;
+        const double d = v - ref;
+        sum += d;
+        sumsq += d*d;
+        n_finite++;
+    }
+
+    /**
+     * @brief see merge_in_all(); if consume is true, the sources' buffers are taken over or freed
+     */
+    bool _merge_in_all(const std::vector<const Data*> & others, bool consume) {
+        bool ok = true;
+        std::vector<const DataTimeseries*> srcs;
+        for (std::vector<const Data*>::const_iterator it = others.begin(); it != others.end(); ++it) {
+            const DataTimeseries*const src = dynamic_cast<const DataTimeseries*const>(*it);
+            if (!src || !src->_valid) {
+                ok = false;
+                continue;
+            }
+            if (!src->_elems_time.empty()) srcs.push_back(src);
+        }
+        if (srcs.empty()) return ok;
+
+        /*
+         * we want no negative time stamps, so the earliest start becomes the new reference,
+         * and all relative times are corrected by their offset to it
+         */
+        unsigned long epoch = _time_epoch_datastart_usec;
+        for (unsigned int k=0; k < srcs.size(); ++k) {
+            if (srcs[k]->_time_epoch_datastart_usec < epoch) epoch = srcs[k]->_time_epoch_datastart_usec;
+        }
+
+        /*****************
+         *  MERGING IN
+         *****************/
+        std::vector<run_t<timevector, datavector> > runs(srcs.size());
+        for (unsigned int k=0; k < srcs.size(); ++k) {
+            runs[k].time = &srcs[k]->_elems_time;
+            runs[k].data = &srcs[k]->_elems_data;
+            runs[k].offset = (srcs[k]->_time_epoch_datastart_usec - epoch)/1E6;
+        }
+
+        // correct the other class members, before the sources are consumed
+        for (unsigned int k=0; k < srcs.size(); ++k) {
+            const DataTimeseries*const src = srcs[k];
+            _sum+=src->_sum;
+            _sqsum+=src->_sqsum;
+            if (src->_max > _max) _max = src->_max;
+            if (src->_min < _min) _min = src->_min;
+            _n+= src->_elems_data.size();
+        }
+        const double myoffset = (_time_epoch_datastart_usec - epoch)/1E6;
+
+        // ours stay where they are up to the first sample of the others, but their time changes by myoffset
+        double tfirst = INFINITY;
+        for (unsigned int k=0; k < runs.size(); ++k) {
+            if (runs[k].time->front() + runs[k].offset < tfirst) tfirst = runs[k].time->front() + runs[k].offset;
+        }
+        size_t unmoved = std::lower_bound(_elems_time.begin(), _elems_time.end(), tfirst - myoffset).index();
+        _summary.invalidate(unmoved > 0 ? unmoved - 1 : 0); // -1: rounding of the offsets
+        _summary.shift_time(myoffset);
+
+        if (runs.size() == 1 && !_elems_time.empty() &&
+            runs[0].time->back() + runs[0].offset < _elems_time.front() + myoffset) {
+            // all of it is before ours, e.g., the previous logfile: only ours needs a new time base
+            _shift_elems_time(myoffset);
+            _summary.invalidate();
+            for (size_t k=runs[0].time->size(); k > 0; --k) {
+                _elems_time.push_front((*runs[0].time)[k-1] + runs[0].offset);
+                _elems_data.push_front((*runs[0].data)[k-1]);
+            }
+            if (consume) _release_run(runs[0]);
+        } else {
+            _merge_runs(_elems_time, _elems_data, myoffset, runs, consume);
+        }
+        _time_epoch_datastart_usec = epoch;
+        _min_t = _elems_time.front();
+        _max_t = _elems_time.back();
+
+        return ok;
+    }
+
+    /**
+     * @brief adds dt to all times, block by block
+     */
+    void _shift_elems_time(double dt) {
+        if (dt == 0.) return;
+        size_t n;
+        for (size_t k=0; k < _elems_time.size(); k += n) {
+            double*const t = _elems_time.segment(k, n);
+            for (size_t j=0; j < n; ++j) t[j] += dt;
+        }
+    }
+
+    /**
+     * @brief the value at timeinstant, interpolated between k-1 and k if need be
+     * @param k index of the first sample >= timeinstant
+     */
+    bool _get_data_at_index(size_t k, double timeinstant, T &val) const {
+        if (k >= _elems_time.size()) return false;
+        if (_elems_time[k] == timeinstant) {
+            // hit a sample
+            val = _elems_data[k];
+            return true;
+        }
+        if (k == 0) return false;
+
+        // between samples; need interpolation
+        const double val_pre = _elems_data[k - 1];
+        const double val_post = _elems_data[k];
+        const double t_post = _elems_time[k];
+        const double t_pre = _elems_time[k - 1];
+        const double m = (val_post-val_pre)/(t_post-t_pre);
+        val = val_pre + (timeinstant - t_pre)*m;
+        return true;
+    }
 };
 
 #endif // DATA_TIMESERIES_H
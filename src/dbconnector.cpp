@@ -485,11 +485,11 @@ int DBConnector::_convertDataToDoubleVector(const Data *dat,std::vector <double>
 template <typename TT>
 void DBConnector::_convertTimeSeriesToDoubleVectorTemplate(const DataTimeseries<TT> &dat, std::vector <double> &data,std::vector <double> &time)
 {
-    for (typename std::vector<TT>::const_iterator it = dat.get_data().begin(); it != dat.get_data().end(); ++it)
+    for (typename DataTimeseries<TT>::datavector::const_iterator it = dat.get_data().begin(); it != dat.get_data().end(); ++it)
     {
         data.push_back((double)*it);
     }
-    time = dat.get_time();
+    time.assign(dat.get_time().begin(), dat.get_time().end());
 }
 
 /**
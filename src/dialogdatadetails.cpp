@@ -37,6 +37,8 @@
 #include <QFrame>
 #include <QLineEdit>
 #include "mavplot.h"
+#include "mavplotcurve.h"
+#include "mavplotevents.h"
 
 void DialogDataDetails::_buildDialog(const Data *const d) {
     // build structure
@@ -175,14 +177,14 @@ DialogDataDetails::DialogDataDetails(const Data *const d, std::vector<QwtPlotIte
     /***********************
      *  MARKERS
      ***********************/
-    QwtPlotMarker*mark = dynamic_cast<QwtPlotMarker*>(s->front());
+    EventPlotItem*mark = s->empty() ? NULL : dynamic_cast<EventPlotItem*>(s->front());
 
     // try to get color from marker...default to white
     if (!s->empty()) {
         QColor currentcol(Qt::white);
         //const QwtSymbol*currentsym=NULL;
         if (mark) {            
-            currentcol = mark->linePen().color();
+            currentcol = mark->pen().color();
             //currentsym = mark->symbol();
             btnCol->setEnabled(true);
         }
@@ -221,9 +223,9 @@ void DialogDataDetails::on_buttonColor_clicked() {
         }
         if (_items) {
             for (std::vector<QwtPlotItem*>::iterator it = _items->begin(); it != _items->end(); ++it) {
-                QwtPlotMarker*mark = dynamic_cast<QwtPlotMarker*>(*it);
+                EventPlotItem*mark = dynamic_cast<EventPlotItem*>(*it);
                 if (mark) {
-                    mark->setLinePen(QPen(usercolor, 0, Qt::DashDotLine));
+                    mark->setPen(QPen(usercolor, 0, Qt::DashDotLine));
                 }
             }
         }
@@ -314,10 +316,12 @@ void DialogDataDetails::on_cbScale_Changed(int idx) {
             newtxt += _get_suffix_from_scale(scale);
             curve->setTitle(newtxt);
 
-            // re-read original data and scale it
-            QVector<double> xdata, ydata;            
-            MavPlot::data2xyvect(_data, xdata, ydata, 1./scale);
-            curve->setSamples(xdata, ydata); // makes a deep copy
+            // the samples are scaled when they are drawn
+            LodSeriesData*samples = dynamic_cast<LodSeriesData*>(curve->data());
+            if (samples) {
+                samples->set_scale(1./scale);
+                curve->itemChanged();
+            }
         }
     }    
 }
@@ -344,7 +348,7 @@ void DialogDataDetails::on_txtName_changed(QString newname) {
     // for other annotations, e.g., markers
     if (_items) {
         for (std::vector<QwtPlotItem*>::iterator it = _items->begin(); it != _items->end(); ++it) {
-            QwtPlotMarker*mark = dynamic_cast<QwtPlotMarker*>(*it);
+            EventPlotItem*mark = dynamic_cast<EventPlotItem*>(*it);
             if (mark) {
                 mark->setTitle(newname);
             }
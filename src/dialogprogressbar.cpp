@@ -38,6 +38,10 @@ DialogProgressBar::DialogProgressBar(QWidget *parent) :
     _progressbar->setValue(50);
     v->addWidget(_lbl);
     v->addWidget(_progressbar);
+    _btncancel = new QPushButton("Cancel", this);
+    _btncancel->setVisible(false);
+    v->addWidget(_btncancel);
+    connect(_btncancel, SIGNAL(clicked()), this, SIGNAL(canceled()));
 }
 
 void DialogProgressBar::setLabel(const QString &text) {
@@ -48,3 +52,8 @@ void DialogProgressBar::setValue(unsigned int value, unsigned int max) {
     _progressbar->setValue(value);
     _progressbar->setMaximum(max);
 }
+
+void DialogProgressBar::setCancelable(bool on) {
+    _btncancel->setVisible(on);
+    _btncancel->setEnabled(true);
+}
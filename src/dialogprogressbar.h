@@ -28,6 +28,7 @@
 #include <QDialog>
 #include <QProgressBar>
 #include <QLabel>
+#include <QPushButton>
 
 class DialogProgressBar : public QDialog
 {
@@ -37,13 +38,20 @@ public:
     void setLabel(const QString & text);
     void setValue(unsigned int value, unsigned int max);
 
+    /**
+     * @brief show a cancel button, which emits canceled()
+     */
+    void setCancelable(bool on);
+
 signals:
-    
+    void canceled();
+
 public slots:
     
 private:
     QProgressBar*_progressbar;
     QLabel*_lbl;
+    QPushButton*_btncancel;
 };
 
 #endif // DIALOGPROGRESSBAR_H
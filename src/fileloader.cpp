@@ -0,0 +1,369 @@
+/**
+ * @file fileloader.cpp
+ * @brief Parses and processes logfiles in a background thread
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <QMutexLocker>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QDebug>
+#include "fileloader.h"
+#include "mavlinkparser.h"
+#include "onboardlogparserfactory.h"
+#include "filefun.h"
+#include "stringfun.h"
+#include "time_fun.h"
+
+using namespace std;
+
+// how often the parse loops check for cancel and update the progress
+#define CHECK_EVERY_MSGS 4096
+
+/**
+ * @brief loads one file in the thread pool
+ */
+class FileLoadWorker : public QRunnable {
+public:
+    FileLoadWorker(FileLoader*loader, unsigned int idx) : _loader(loader), _idx(idx) {}
+    void run() { _loader->_work(_idx); }
+private:
+    FileLoader*  _loader;
+    unsigned int _idx;
+};
+
+FileLoader::FileLoader(const QStringList &files, double delay, CmdlineArgs *args, QObject *parent) :
+    QThread(parent), _files(files), _delay(delay), _args(args),
+    _bytes_total(0), _n_done(0), _last_permille(-1), _canceled(false),
+    _policy_fwd(JUMP_ASK), _policy_back(JUMP_ASK) {
+
+    job_t j;
+    j.bytes_consumed = 0;
+    j.question_pending = false;
+    j.question_forward = false;
+    j.answer_allow = false;
+    for (QStringList::const_iterator it = _files.begin(); it != _files.end(); ++it) {
+        j.bytes_total = QFileInfo(*it).size();
+        _bytes_total += j.bytes_total;
+        _jobs.push_back(j);
+    }
+
+    // one file per thread; every thread needs its own MAVLink channel, and channel 0 is left alone
+    _nthreads = QThread::idealThreadCount();
+    if (_nthreads > (unsigned int) _files.size()) _nthreads = _files.size();
+    if (_nthreads > MAVLINK_COMM_NUM_BUFFERS - 1) _nthreads = MAVLINK_COMM_NUM_BUFFERS - 1;
+    if (_nthreads < 1) _nthreads = 1;
+    _nthreads_file = QThread::idealThreadCount() / _nthreads;
+    if (_nthreads_file < 1) _nthreads_file = 1;
+}
+
+FileLoader::~FileLoader() {
+    cancel();
+    wait();
+    // results nobody took
+    for (std::deque<loaded_t>::iterator it = _loaded.begin(); it != _loaded.end(); ++it) {
+        for (std::vector<MavlinkScenario*>::iterator sit = it->scenarios.begin(); sit != it->scenarios.end(); ++sit) {
+            delete *sit;
+        }
+    }
+}
+
+void FileLoader::cancel(void) {
+    QMutexLocker lock(&_mutex);
+    _canceled = true;
+    _answered.wakeAll();
+}
+
+bool FileLoader::is_canceled(void) const {
+    QMutexLocker lock(&_mutex);
+    return _canceled;
+}
+
+void FileLoader::answer_timejump(int file, bool allow, bool to_all) {
+    QMutexLocker lock(&_mutex);
+    if (file < 0 || file >= (int) _jobs.size()) return;
+    job_t & j = _jobs[file];
+    if (!j.question_pending) return;
+    j.answer_allow = allow;
+    j.question_pending = false;
+    if (to_all) {
+        jumppolicy_e & policy = j.question_forward ? _policy_fwd : _policy_back;
+        policy = allow ? JUMP_ALLOW : JUMP_DEMUX;
+        // the others who are waiting for the same question get the same answer
+        for (std::vector<job_t>::iterator it = _jobs.begin(); it != _jobs.end(); ++it) {
+            if (it->question_pending && it->question_forward == j.question_forward) {
+                it->answer_allow = allow;
+                it->question_pending = false;
+            }
+        }
+    }
+    _answered.wakeAll();
+}
+
+bool FileLoader::is_question_pending(int file) const {
+    QMutexLocker lock(&_mutex);
+    if (file < 0 || file >= (int) _jobs.size()) return false;
+    return _jobs[file].question_pending;
+}
+
+bool FileLoader::take_loaded(std::vector<loaded_t> &ret) {
+    QMutexLocker lock(&_mutex);
+    if (_loaded.empty()) return false;
+    ret.insert(ret.end(), _loaded.begin(), _loaded.end());
+    _loaded.clear();
+    return true;
+}
+
+void FileLoader::run() {
+    _free_channels.clear();
+    for (unsigned int k=1; k <= _nthreads; ++k) {
+        _free_channels.insert((uint8_t) k);
+    }
+    _pool.setMaxThreadCount(_nthreads);
+    for (unsigned int k=0; k < _jobs.size(); ++k) {
+        _pool.start(new FileLoadWorker(this, k));
+    }
+    _pool.waitForDone();
+}
+
+uint8_t FileLoader::_acquire_channel(void) {
+    QMutexLocker lock(&_mutex);
+    const uint8_t chan = *_free_channels.begin(); // never empty, since there are as many as threads
+    _free_channels.erase(_free_channels.begin());
+    return chan;
+}
+
+void FileLoader::_release_channel(uint8_t chan) {
+    QMutexLocker lock(&_mutex);
+    _free_channels.insert(chan);
+}
+
+void FileLoader::_work(unsigned int idx) {
+    if (is_canceled()) return;
+    _report_progress(idx, 0);
+
+    loaded_t res;
+    const bool ok = _load_file(idx, res);
+
+    QMutexLocker lock(&_mutex);
+    _n_done++;
+    if (ok) {
+        _loaded.push_back(res);
+        lock.unlock();
+        emit fileLoaded();
+    } else {
+        lock.unlock();
+        for (std::vector<MavlinkScenario*>::iterator it = res.scenarios.begin(); it != res.scenarios.end(); ++it) {
+            delete *it;
+        }
+    }
+    _report_progress(idx, _jobs[idx].bytes_total);
+}
+
+void FileLoader::_report_progress(unsigned int idx, uint64_t bytes_file) {
+    QMutexLocker lock(&_mutex);
+    _jobs[idx].bytes_consumed = bytes_file;
+    uint64_t done = 0;
+    for (std::vector<job_t>::const_iterator it = _jobs.begin(); it != _jobs.end(); ++it) {
+        done += it->bytes_consumed;
+    }
+    const int permille = _bytes_total > 0 ? (int) ((1000*done) / _bytes_total) : 0;
+    if (permille == _last_permille) return;
+    _last_permille = permille;
+
+    QString text;
+    if (1 == _files.size()) {
+        text = QString("Loading %1...").arg(QString::fromStdString(getBasename(_files[0].toStdString())));
+    } else {
+        text = QString("Loading %1 files, %2 done...").arg(_files.size()).arg(_n_done);
+    }
+    emit progressChanged(text, permille, 1000);
+}
+
+bool FileLoader::_load_file(unsigned int idx, loaded_t &ret) {
+    const string fname = _files[idx].toStdString();
+    ret.file = idx;
+    ret.fullpath = _files[idx];
+    ret.basename = getBasename(fname);
+
+    // decide which parser to take and do it
+    string ext = getExtension(fname);
+    ext = lcase(ext);
+    bool parsed;
+    if (ext.compare("tlog") == 0 || ext.compare("mavlink") == 0) {
+        parsed = _parse_mavlink(idx, fname, ret);
+    } else {
+        parsed = _parse_onboard(idx, fname, ext, ret);
+    }
+    if (!parsed || is_canceled()) return false;
+
+    // guess the start time of the logfile by looking at the file name
+    uint64_t time_epoch_usec = 0;
+    bool have_starttime = false;
+    QRegExp rex("\\d{4}-\\d{2}-\\d{2}[- ]\\d{2}-\\d{2}(-\\d{2})?");
+    if (rex.indexIn(QString::fromStdString(ret.basename)) != -1) {
+        QString str_datetime = rex.cap(0);
+
+        // remove hyphen between date and time, if there is one
+        if (str_datetime.length()>10) {
+            #if (QT_VERSION > QT_VERSION_CHECK(5,0,0))
+                char pos10 = str_datetime[10].toLatin1();
+            #else
+                char pos10 = str_datetime[10].toAscii();
+            #endif
+            if (pos10 != ' ') {
+                str_datetime[10] = ' ';
+            }
+        }
+        qDebug() << "GUESS DATE:" << str_datetime;
+        have_starttime = string_to_epoch_usec(str_datetime.toStdString(), time_epoch_usec);
+    }
+
+    // the user picks one of the scenarios later, so prepare all of them
+    for (std::vector<MavlinkScenario*>::iterator it = ret.scenarios.begin(); it != ret.scenarios.end(); ++it) {
+        if (have_starttime) {
+            (*it)->set_starttime_guess(time_epoch_usec);
+        }
+        if (_delay != 0.0) {
+            (*it)->shift_time(_delay);
+        }
+        (*it)->process();
+        (*it)->dump_overview();
+    }
+    return !is_canceled();
+}
+
+bool FileLoader::_parse_mavlink(unsigned int idx, const std::string &filename, loaded_t &ret) {
+    const uint8_t chan = _acquire_channel();
+    MavlinkParser mlp(ByteSource::open(filename), filename, chan);
+    const bool ok = mlp.valid && _parse_mavlink(idx, mlp, ret);
+    _release_channel(chan);
+    return ok;
+}
+
+bool FileLoader::_parse_mavlink(unsigned int idx, MavlinkParser &mlp, loaded_t &ret) {
+    const std::string & filename = mlp.get_filename();
+    const uint64_t total = mlp.get_bytes_total();
+
+    MavlinkScenario*scene = new MavlinkScenario(_args);
+    scene->setName(ret.basename);
+    ret.scenarios.push_back(scene);
+
+    mavlink_message_t msg;
+    unsigned int n = 0;
+    while (mlp.get_next_msg(msg)) {
+        const int upd = scene->add_mavlink_message(msg);
+        if (1 == upd || -1 == upd) {
+            // time jump. Either make one scenario or demultiplex into separate ones.
+            if (!_allow_timejump(idx, filename, 1 == upd)) {
+                if (is_canceled()) return false;
+                scene = new MavlinkScenario(_args);
+                scene->setName(ret.basename + "_" + QString::number(ret.scenarios.size() + 1).toStdString());
+                ret.scenarios.push_back(scene);
+            }
+            scene->add_mavlink_message(msg, true);
+        }
+
+        if (0 == (++n % CHECK_EVERY_MSGS)) {
+            if (is_canceled()) return false;
+            _report_progress(idx, mlp.get_bytes_consumed());
+        }
+    }
+    _report_progress(idx, total);
+
+    const mavlink_status_t*stats = mlp.get_linkstats();
+    qDebug() << "Mavlink parser stats: "
+                "#rx=" << stats->msg_received <<
+                ", #rx ok=" << stats->packet_rx_success_count <<
+                ", #rx drop" << stats->packet_rx_drop_count <<
+                ", #buffer ovf=" << stats->buffer_overrun <<
+                ", #parser err=" << stats->parse_error;
+    return true;
+}
+
+bool FileLoader::_parse_onboard(unsigned int idx, const std::string &filename, const std::string &ext, loaded_t &ret) {
+    OnboardLogParser*olp = OnboardLogParserFactory::Instance().Create(ext);
+    if (!olp)  {
+        qDebug() << "Could not find/allocate parser for extension " << QString::fromStdString(ext);
+        return false;
+    }
+
+    MavlinkScenario*scene = new MavlinkScenario(_args);
+    scene->setName(ret.basename);
+    ret.scenarios.push_back(scene);
+
+    // send parser info to scene
+    scene->begin_onboard_log(olp->get_parser_name());
+
+    // now go ahead with actual data
+    olp->Load(filename, scene->getLogChannel());
+    if (!olp->valid) {
+        delete olp;
+        return false;
+    }
+
+    bool ok = true;
+    if (olp->has_columns()) {
+        OnboardColumns cols;
+        olp->set_threads(_nthreads_file);
+        while (olp->has_more_data() && !is_canceled()) {
+            cols.clear();
+            ok = olp->get_columns(cols, 262144);
+            scene->add_onboard_columns(cols); // also what came before an error
+            _report_progress(idx, olp->get_bytes_consumed());
+            if (!ok) break;
+        }
+    } else {
+        OnboardData d;
+        unsigned int n = 0;
+        while (olp->has_more_data()) {
+            olp->get_data(d);
+            if (d.is_valid()) {
+                scene->add_onboard_message(d);
+            }
+            if (0 == (++n % CHECK_EVERY_MSGS)) {
+                if (is_canceled()) break;
+                _report_progress(idx, olp->get_bytes_consumed());
+            }
+        }
+    }
+    delete olp;
+    return !is_canceled();
+}
+
+bool FileLoader::_allow_timejump(unsigned int idx, const std::string &filename, bool forward) {
+    QMutexLocker lock(&_mutex);
+    jumppolicy_e & policy = forward ? _policy_fwd : _policy_back;
+    if (JUMP_ASK != policy) return JUMP_ALLOW == policy;
+    if (_canceled) return false;
+
+    // the GUI thread asks the user and calls answer_timejump()
+    job_t & j = _jobs[idx];
+    j.question_pending = true;
+    j.question_forward = forward;
+    lock.unlock();
+    emit timeJump(QString::fromStdString(filename), forward, (int) idx);
+    lock.relock();
+    while (j.question_pending && !_canceled) {
+        _answered.wait(&_mutex);
+    }
+    j.question_pending = false;
+    return !_canceled && j.answer_allow;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file fileloader.h
+ * @brief Parses and processes logfiles in a background thread
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef FILELOADER_H
+#define FILELOADER_H
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+#include "mavlinkscenario.h"
+#include "mavlinkparser.h"
+#include "cmdlineargs.h"
+
+/**
+ * @brief loads a list of files in the background. The files are parsed at the same time by
+ * a pool of worker threads, each into its own scenario(s), and processed. The GUI thread takes
+ * whatever is done with take_loaded() and merges it in all at once with
+ * MavlinkScenario::merge_in_all(), so that it shows up while the other files are being parsed.
+ *
+ * The workers never talk to the user. When a file has a time jump, its worker emits timeJump()
+ * and waits until the GUI thread calls answer_timejump() or cancel().
+ */
+class FileLoader : public QThread {
+    Q_OBJECT
+public:
+    /**
+     * @brief the result for one file
+     */
+    typedef struct {
+        unsigned int                  file;     ///< index in the list of files
+        QString                       fullpath;
+        std::string                   basename;
+        std::vector<MavlinkScenario*> scenarios; ///< more than one if the user chose to demultiplex at time jumps
+    } loaded_t;
+
+    /**
+     * @param files full paths of the files to load
+     * @param delay shift all data of the files by this many seconds
+     */
+    FileLoader(const QStringList & files, double delay, CmdlineArgs*args, QObject*parent = 0);
+    ~FileLoader();
+
+    /**
+     * @brief stop as soon as possible. The current file is dropped, those before are kept.
+     * Can be called from any thread.
+     */
+    void cancel(void);
+
+    bool is_canceled(void) const;
+
+    /**
+     * @brief answer the pending question from timeJump()
+     * @param file as given by timeJump()
+     * @param allow true to allow the jump, false to demultiplex into a new scenario
+     * @param to_all apply the answer to all further jumps in the same direction, in all files
+     */
+    void answer_timejump(int file, bool allow, bool to_all);
+
+    /**
+     * @brief whether the worker of this file still waits for answer_timejump(). After an
+     * answer "to all", the others with the same question do not wait anymore.
+     */
+    bool is_question_pending(int file) const;
+
+    /**
+     * @brief move the files which are done since the last call to ret. The caller owns the scenarios.
+     * @return false if there were none
+     */
+    bool take_loaded(std::vector<loaded_t> & ret);
+
+signals:
+    void fileLoaded(); ///< take_loaded() has something
+    void progressChanged(QString text, int value, int max);
+    void timeJump(QString filename, bool forward, int file); ///< call answer_timejump() in return
+
+protected:
+    void run();
+
+private:
+    typedef enum {
+        JUMP_ASK,
+        JUMP_ALLOW,
+        JUMP_DEMUX
+    } jumppolicy_e;
+
+    /**
+     * @brief state of one file
+     */
+    typedef struct {
+        uint64_t bytes_total;
+        uint64_t bytes_consumed;
+        bool     question_pending;
+        bool     question_forward;
+        bool     answer_allow;
+    } job_t;
+
+    friend class FileLoadWorker;
+
+    void _work(unsigned int idx);
+    bool _load_file(unsigned int idx, loaded_t & ret);
+    bool _parse_mavlink(unsigned int idx, const std::string & filename, loaded_t & ret);
+    bool _parse_mavlink(unsigned int idx, MavlinkParser & mlp, loaded_t & ret);
+    bool _parse_onboard(unsigned int idx, const std::string & filename, const std::string & ext, loaded_t & ret);
+    bool _allow_timejump(unsigned int idx, const std::string & filename, bool forward);
+    void _report_progress(unsigned int idx, uint64_t bytes_file);
+    uint8_t _acquire_channel(void);
+    void _release_channel(uint8_t chan);
+
+    QStringList    _files;
+    double         _delay;
+    CmdlineArgs*   _args;
+    unsigned int   _nthreads;
+    unsigned int   _nthreads_file; ///< for parsers which can use several threads themselves
+    QThreadPool    _pool;
+
+    // shared by the workers and the GUI thread
+    mutable QMutex       _mutex;
+    QWaitCondition       _answered;
+    std::vector<job_t>   _jobs;
+    std::set<uint8_t>    _free_channels; ///< MAVLink channels
+    uint64_t             _bytes_total;
+    unsigned int         _n_done;
+    int                  _last_permille;
+    bool                 _canceled;
+    jumppolicy_e         _policy_fwd;
+    jumppolicy_e         _policy_back;
+    std::deque<loaded_t> _loaded;
+};
+
+#endif // FILELOADER_H
@@ -26,6 +26,8 @@
 //#include <stdlib.h>
 #include <iostream>
 #include <unistd.h>
+#include <QThread>
+#include <QMutexLocker>
 #include "logger.h"
 #include "filefun.h"
 
@@ -40,6 +42,7 @@ Logger::Logger() : _nextid(0) {
 }
 
 Logger::logchannel Logger::createChannel(const std::string & chname, bool to_file) {
+    QMutexLocker lock(&_mutex);
     channelprops_t props;
     props.name = chname;
     props.has_file = to_file;
@@ -68,6 +71,7 @@ void Logger::deleteMessage(const QModelIndex &id) {
 }
 
 void Logger::deleteChannel(Logger::logchannel ch) {
+    QMutexLocker lock(&_mutex);
     // find channel, and remove
     channelmap_t::iterator it = _channels.find(ch);
     if (it != _channels.end()) {
@@ -112,6 +116,7 @@ void Logger::deleteLogfile(std::ofstream*stream) {
 void Logger::write(logmsgtype_e typ, const std::string & msg, logchannel ch) {
     // find channel, then write to there
     // if not found, revert to default channel
+    QMutexLocker lock(&_mutex);
     channelmap_t::const_iterator it = _channels.find(ch);
     channelprops_t props;
     if (it != _channels.end()) {
@@ -119,8 +124,16 @@ void Logger::write(logmsgtype_e typ, const std::string & msg, logchannel ch) {
     } else {
         props = _channels[0]; // default channel
     }
+    lock.unlock();
     std::string emitter = props.name;
-    _model.add_message(emitter, typ, msg);
+    if (QThread::currentThread() == _model.thread()) {
+        _model.add_message(emitter, typ, msg);
+    } else {
+        // the model belongs to the GUI; let its event loop do it
+        QMetaObject::invokeMethod(&_model, "add_message_queued", Qt::QueuedConnection,
+                                  Q_ARG(QString, QString::fromStdString(emitter)), Q_ARG(int, (int)typ),
+                                  Q_ARG(QString, QString::fromStdString(msg)));
+    }
 }
 
 /**
@@ -176,8 +189,8 @@ void Logger::_cleanup_stream(ofstream*ofs) {
 }
 
 void Logger::_cleanup(void) {
-    for (channelmap_t::iterator it = _channels.begin(); it != _channels.end(); ++it) {
-        deleteChannel(it->first);
+    // deleteChannel() erases from the map, so don't iterate
+    while (!_channels.empty()) {
+        deleteChannel(_channels.begin()->first);
     }
-    _channels.clear();
 }
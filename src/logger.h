@@ -30,6 +30,7 @@
 #include <sstream>
 #include <vector>
 #include <map>
+#include <QMutex>
 #include "logtablemodel.h"
 #include "logmsg.h"
 
@@ -125,6 +126,8 @@ private:
 
     std::vector<std::string> _files;
     std::vector<std::ofstream*> _streams;
+
+    QMutex _mutex; ///< parsers may log from worker threads
 };
 
 #endif // LOGGER_H
@@ -76,6 +76,10 @@ void LogTableModel::add_message(const std::string & emitter, logmsgtype_e typ, c
     emit dataChanged(topleft, botright);
 }
 
+void LogTableModel::add_message_queued(QString emitter, int typ, QString msg) {
+    add_message(emitter.toStdString(), (logmsgtype_e) typ, msg.toStdString());
+}
+
 /**
  * @brief remove all messages from one emitter
  * @param e
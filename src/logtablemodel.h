@@ -73,6 +73,10 @@ public:
 signals:
     
 public slots:
+    /**
+     * @brief same as add_message(), but for queued invocation from other threads
+     */
+    void add_message_queued(QString emitter, int typ, QString msg);
 private:
 
     QList<QStandardItem *> _prepareRow(const QString &first, const QString &second, const QString &third);    
@@ -31,8 +31,11 @@
 #include "mainwindow.h"
 #include "cmdlineargs.h"
 #include "mavlinkparser.h"
+#include "mavlinkchunkedparser.h"
+#include "mavlinkindex.h"
 #include "mavlinkscenario.h"
 #include "dbconnector.h"
+#include "benchmark.h"
 
 using namespace std;
 
@@ -51,6 +54,11 @@ int main(int argc, char *argv[]) {
         exit(1);
     }
 
+    if (!args.benchmark.empty()) {
+        Benchmark bench(&args);
+        return bench.run();
+    }
+
 	if(args.import) {
         // FIXME: that assumes we have only mavlog files. but there are also onboard logs.
         printf("Import\n");
@@ -99,9 +107,23 @@ int main(int argc, char *argv[]) {
 		        // for each parser, start a new scenario
 		        MavlinkScenario*curscenario = new MavlinkScenario(&args);
 		        if (curscenario) {
-		            mavlink_message_t msg;
-		            while ((*it)->get_next_msg(msg)) {
-		                curscenario->add_mavlink_message(msg);
+		            if (!args.msgids.empty() || !args.sysids.empty() || args.use_index) {
+		                // selective decoding
+		                MavlinkIndex index((*it)->get_filename());
+		                if (index.load_or_build(args.use_index)) {
+		                    const unsigned int n = index.decode(*curscenario, args.msgids, args.sysids);
+		                    cout << "Decoded " << n << " of " << index.get_num_entries() << " messages" << endl;
+		                } else {
+		                    cerr << "ERROR indexing " << (*it)->get_filename() << endl;
+		                }
+		            } else if (args.threads > 1) {
+		                MavlinkChunkedParser chunked((*it)->get_filename(), args.threads);
+		                chunked.parse(*curscenario);
+		            } else {
+		                mavlink_message_t msg;
+		                while ((*it)->get_next_msg(msg)) {
+		                    curscenario->add_mavlink_message(msg);
+		                }
 		            }
 		            // guess the start time of the logfile by looking at the file name
 		            //  - basename usually looks like "2014-04-10 15-41-26".
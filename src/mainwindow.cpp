@@ -22,11 +22,13 @@
 
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 #include <QSettings>
 #include <QMessageBox>
 #include <QSpacerItem>
 #include <QInputDialog>
 #include <QVBoxLayout>
+#include <QThread>
 #include <QHBoxLayout>
 #include <qfiledialog.h>
 #include <qfileinfo.h>
@@ -663,7 +665,7 @@ MainWindow::MainWindow(list<MavlinkParser*> &parsers, CmdlineArgs *const args, Q
     QMainWindow(parent),
     ui(new Ui::MainWindow), _settings("DE.TUM.EI.RCS", "MavLogAnalyzer"), _dataSelected(NULL), _datagroupSelected(NULL),
     _markerA(false), _markerB(false), _markerData(false),
-    _dlgprogress(NULL), _dlgstats(NULL), _dlgdatatable(NULL) {
+    _dlgprogress(NULL), _dlgstats(NULL), _loader(NULL), _merging(false), _asking(false), _dlgdatatable(NULL) {
 
     ui->setupUi(this);    
     _args = args;
@@ -698,6 +700,7 @@ MainWindow::MainWindow(list<MavlinkParser*> &parsers, CmdlineArgs *const args, Q
 }
 
 MainWindow::~MainWindow() {
+    delete _loader; // stops it
     _save_windows_settings();
     delete ui;
     delete _analyzer;
@@ -823,6 +826,7 @@ MavlinkScenario* MainWindow::_forceChooseScenario(const std::vector<MavlinkScena
 
 void MainWindow::_addFile(double delay) {
     // TODO: check whether currently a DB scenario is loaded. Ask user whether to clear or merge in.
+    if (_loader) return; // one at a time
 
     // start in last path
     _settings.beginGroup("fileDialog");
@@ -832,7 +836,7 @@ void MainWindow::_addFile(double delay) {
     QStringList fileNames = QFileDialog::getOpenFileNames
             (NULL,
              "Add Files to scenario", startDir,
-             "MavLink or onboard log (*.tlog *.log *.mavlink *.px4log *.ulg);;All files (*.*)");
+             "MavLink or onboard log (*.tlog *.log *.bin *.mavlink *.px4log *.ulg);;All files (*.*)");
     if (fileNames.empty()) return;
 
     // save last path
@@ -841,245 +845,159 @@ void MainWindow::_addFile(double delay) {
     _settings.setValue("last_directory",dirname);
     _settings.endGroup();
 
-    // do it
+    QStringList toload;
+    for (QStringList::Iterator itf = fileNames.begin(); itf != fileNames.end(); ++itf) {
+        QString f_fullpath = QString::fromStdString(getFullPath(itf->toStdString()));
+        if(f_fullpath.compare("")==0) continue;
+        if (_fileLoaded(f_fullpath) || toload.contains(f_fullpath)) continue;
+        toload.push_back(f_fullpath);
+    }
+    if (toload.empty()) return;
+
+    // do it in the background; the results come in with fileLoaded()
     showProgressBar();
     updateProgressBarTitle("Merging in data...");
-    updateProgressBarValue(0, fileNames.size());
+    updateProgressBarValue(0, 1000);
+    _dlgprogress->setCancelable(true);
 
-    bool timeJumpsBack_yesToAll = false;
-    bool timeJumpsBack_noToAll = false;    
-    bool timeJumpsFwd_yesToAll = false;
-    bool timeJumpsFwd_noToAll = false;    
+    _loader = new FileLoader(toload, delay, _args);
+    connect(_loader, SIGNAL(fileLoaded()), this, SLOT(fileLoaded()), Qt::QueuedConnection);
+    connect(_loader, SIGNAL(progressChanged(QString,int,int)), this, SLOT(loadProgress(QString,int,int)), Qt::QueuedConnection);
+    connect(_loader, SIGNAL(timeJump(QString,bool,int)), this, SLOT(loadTimeJump(QString,bool,int)), Qt::QueuedConnection);
+    connect(_loader, SIGNAL(finished()), this, SLOT(loadFinished()), Qt::QueuedConnection);
+    _loader->start();
+}
 
-    unsigned int progress=0;
-    for (QStringList::Iterator itf = fileNames.begin(); itf != fileNames.end(); ++itf) {
-        QString f = *itf;
-        QString f_fullpath = QString::fromStdString(getFullPath(f.toStdString()));
-        string f_basename = getBasename(f_fullpath.toStdString());
-        if(f_fullpath.compare("")==0) continue;       
-        if (!_fileLoaded(f_fullpath)) {
-
-            // use a new temporary scene for this file
-            std::vector<MavlinkScenario*> fileScenarios;
-            MavlinkScenario*tmp_scene = new MavlinkScenario(_args); fileScenarios.push_back(tmp_scene);
-            tmp_scene->setName(getBasename(f_fullpath.toStdString()));
-
-            // decide which parser to take and do it
-            string ext = getExtension(f_fullpath.toStdString());
-            ext = lcase(ext);            
-            bool parsed = false;
-            if (ext.compare("tlog") == 0 || ext.compare("mavlink") == 0) {
-                /*****************
-                 * MavLink Log
-                 *****************/
-                MavlinkParser*mlp = new MavlinkParser(f_fullpath.toStdString());
-                if (!mlp) {
-                    qDebug() << "Could not allocate memory for new MavlinkParser";
-                    continue; // skip file
-                }
-                if (!mlp->valid) {continue;}
-                _parsers->push_back(mlp); ///< FIXME: why do we keep that thing?
-
-                // run it, feed it into analyzer
-                mavlink_message_t msg;
-                while (mlp->get_next_msg(msg)) {
-                    int upd = tmp_scene->add_mavlink_message(msg);
-
-                    // ERROR HANDLING:
-                    if (1 == upd) {
-                        /************************
-                         * fwd jump in time base
-                         ************************/
-                        bool tolerate = false;
-                        if (!timeJumpsFwd_noToAll) {
-                            tolerate = timeJumpsFwd_yesToAll;
-                            if (!tolerate) {
-                                // ask whether to do this. FIXME: give more context to the user
-                                QMessageBox msg (QMessageBox::Question, "Time jump detected", "There is a rapid forward time jump in the data. Allow jump and make one scenario or demultiplex into separate scenarios?", QMessageBox::Yes|QMessageBox::No|QMessageBox::YesToAll|QMessageBox::NoToAll);
-                                msg.setButtonText(QMessageBox::Yes, "Allow");
-                                msg.setButtonText(QMessageBox::No, "Demux");
-                                msg.setButtonText(QMessageBox::YesToAll, "Allow all");
-                                msg.setButtonText(QMessageBox::NoToAll, "Demux all");
-                                switch (msg.exec()) {
-                                    case QMessageBox::YesToAll:
-                                        timeJumpsFwd_yesToAll = true;
-                                        // fallthrough;
-                                    case QMessageBox::Yes:
-                                        tolerate = true;
-                                        break;
-                                    case QMessageBox::NoToAll:
-                                        timeJumpsFwd_noToAll = true;
-                                        // fallthrough
-                                    case QMessageBox::No:
-                                        // nothing to do
-                                        break;
-                                    default:
-                                        break;
-                                }
-                            }                        
-                        }
-                        if (!tolerate) {
-                            // demux into new scenario
-                            tmp_scene = new MavlinkScenario(_args); fileScenarios.push_back(tmp_scene);
-                            tmp_scene->setName(getBasename(f_fullpath.toStdString()) + "_" + QString::number(fileScenarios.size()).toStdString());
-                        }
-                        tmp_scene->add_mavlink_message(msg, true);
-
-                    } else if (-1 == upd) {
-                        /*************************
-                         * back jump in time base
-                         *************************/
-                        bool tolerate = false;
-                        if (!timeJumpsBack_noToAll) {
-                            tolerate = timeJumpsBack_yesToAll;
-                            if (!tolerate) {
-                                // ask whether to do this. FIXME: give more context to the user
-                                QMessageBox msg(QMessageBox::Question, "Time jump detected", "There is a rapid backward time jump in the data. Allow jump and make one scenario (yes) or demultiplex into separate scenarios (no)?",  QMessageBox::Yes|QMessageBox::No|QMessageBox::YesToAll|QMessageBox::NoToAll);
-                                msg.setButtonText(QMessageBox::Yes, "Allow");
-                                msg.setButtonText(QMessageBox::No, "Demux");
-                                msg.setButtonText(QMessageBox::YesToAll, "Allow all");
-                                msg.setButtonText(QMessageBox::NoToAll, "Demux all");
-                                switch (msg.exec()) {
-                                    case QMessageBox::YesToAll:
-                                        timeJumpsBack_yesToAll = true;
-                                        // fallthrough;
-                                    case QMessageBox::Yes:
-                                        tolerate = true;
-                                        break;
-                                    case QMessageBox::NoToAll:
-                                        timeJumpsBack_noToAll = true;
-                                        // fallthrough
-                                    case QMessageBox::No:
-                                        // nothing to do
-                                        break;
-                                    default:
-                                        break;
-                                }
-                            }
-                        }
-                        if (!tolerate) {
-                            // demux into new scenario
-                            tmp_scene = new MavlinkScenario(_args); fileScenarios.push_back(tmp_scene);
-                            tmp_scene->setName(getBasename(f_fullpath.toStdString()) + "_" + QString::number(fileScenarios.size()).toStdString());
-                        }
-                        tmp_scene->add_mavlink_message(msg, true);
-                    }
-
-                }
-                const mavlink_status_t*stats = mlp->get_linkstats();
-                qDebug() << "Mavlink parser stats: "
-                            "#rx=" << stats->msg_received <<
-                            ", #rx ok=" << stats->packet_rx_success_count <<
-                            ", #rx drop" << stats->packet_rx_drop_count <<
-                            ", #buffer ovf=" << stats->buffer_overrun <<
-                            ", #parser err=" << stats->parse_error;
-
-                parsed = true;
-            } else {
-                OnboardLogParser*olp = OnboardLogParserFactory::Instance().Create(ext);
-                if (!olp)  {
-                    qDebug() << "Could not find/allocate parser for extension " << QString::fromStdString(ext);
-                    continue; // skip file
-                }
-                // send parser info to scene
-                const std::string parsername = olp->get_parser_name();
-                OnboardData parser_id;
-                parser_id._string_data["_parser_name"] = parsername;
-                parser_id._msgname_orig = "_parser_name";
-                parser_id._valid = false;
-                tmp_scene->add_onboard_message (parser_id);
-
-                // now go ahead with actual data
-                olp->Load (f_fullpath.toStdString(), tmp_scene->getLogChannel());
-                if (!olp->valid) {continue;}
-
-                // - do the parsing into the scenario
-                while (olp->has_more_data()) {
-                    OnboardData d = olp->get_data();
-                    if (d.is_valid()) {
-                        tmp_scene->add_onboard_message(d);
-                    }
-                }
-                delete olp;
-                parsed = true;
+/**
+ * @brief orders the results of the loader like the files were given
+ */
+static bool loaded_before(const FileLoader::loaded_t & a, const FileLoader::loaded_t & b) {
+    return a.file < b.file;
+}
+
+void MainWindow::fileLoaded() {
+    if (!_loader) return;
+    if (_merging) return; // a dialog below is open; the loop picks it up
+    _merging = true;
+
+    std::vector<FileLoader::loaded_t> files;
+    while (_loader->take_loaded(files)) {
+        std::sort(files.begin(), files.end(), loaded_before);
+
+        /* first of all, if we have multiple scenes for a file, force user to
+         * select one (because MLA can only handle one at a time currently...)
+         */
+        std::vector<MavlinkScenario*> scenes;
+        for (std::vector<FileLoader::loaded_t>::iterator it = files.begin(); it != files.end(); ++it) {
+            if (it->scenarios.empty()) continue;
+            MavlinkScenario*tmp_scene = it->scenarios.front();
+            if (it->scenarios.size() > 1) {
+                tmp_scene = _forceChooseScenario(it->scenarios);
+            }
+            scenes.push_back(tmp_scene);
+            ui->listFiles->addItem(it->fullpath);
+
+            // set scenario name if empty
+            if (_analyzer->getName().empty()) {
+                _analyzer->setName(it->basename);
             }
+        }
 
+        // merge all that are done in one go; their data is moved, not copied. Data which is not
+        // present may be replaced then, so the plot must let go of it first.
+        d_plot->removeAbsentData();
+        _analyzer->take_in_all(scenes);
+        d_plot->reloadData();
 
-            // we tried all parsers at this point
-
-            if (parsed) {
-                /****************
-                 * GOT NEW DATA
-                 ****************/
-
-                /* first of all, if we have multiple scenes for this file, force user to
-                 * select one (because MLA can only handle one at a time currently...)
-                 */
-
-                // at this point, we have only one scene left. work on this.
-                if (fileScenarios.size() > 1) {
-                    tmp_scene = _forceChooseScenario(fileScenarios);
-                }
-                // guess the start time of the logfile by looking at the file name                
-                QRegExp rex("\\d{4}-\\d{2}-\\d{2}[- ]\\d{2}-\\d{2}(-\\d{2})?");
-                if (rex.indexIn(QString::fromStdString(f_basename)) != -1) {
-                    QString str_datetime = rex.cap(0);
-
-                    // remove hyphen between date and time, if there is one
-                    if (str_datetime.length()>10) {
-                        #if (QT_VERSION > QT_VERSION_CHECK(5,0,0))
-                            char pos10 = str_datetime[10].toLatin1();
-                        #else
-                            char pos10 = str_datetime[10].toAscii();
-                        #endif
-                        if (pos10 != ' ') {
-                            str_datetime[10] = ' ';
-                        }
-                    }
-                    qDebug() << "GUESS DATE:" << str_datetime;
-                    uint64_t time_epoch_usec = 0;
-                    if (string_to_epoch_usec(str_datetime.toStdString(), time_epoch_usec)) {
-                        tmp_scene->set_starttime_guess(time_epoch_usec);
-                    }
-                }
-
-                ui->listFiles->addItem(f_fullpath);
-
-                // apply delay if any
-                if (delay != 0.0) {
-                    tmp_scene->shift_time(delay);
-                }
-
-                // analyze
-                tmp_scene->process();
-                tmp_scene->dump_overview();
-
-                // merge in the analyzer
-                _analyzer->merge_in(*tmp_scene);
-
-                // set scenario name if empty
-                if (_analyzer->getName().empty()) {
-                    _analyzer->setName(f_basename);
-                }
-
-                // remove all temporary scenes
-                for (std::vector<MavlinkScenario*>::iterator fit = fileScenarios.begin(); fit != fileScenarios.end(); ++fit) {
-                    delete *fit;
-                }
-                fileScenarios.clear();
+        // remove all temporary scenes, what is left of them
+        for (std::vector<FileLoader::loaded_t>::iterator it = files.begin(); it != files.end(); ++it) {
+            for (std::vector<MavlinkScenario*>::iterator fit = it->scenarios.begin(); fit != it->scenarios.end(); ++fit) {
+                delete *fit;
             }
         }
-        updateProgressBarValue(++progress, fileNames.size());
+        files.clear();
+
+        // show what we have so far
+        _stvm->reload();
+        _dtvm->reload();
+        if (_lastsys) {
+            _updateTextInfo(_lastsys); ///< FIXME: if addFile removes a MavSystem, then this ptr could be invalid...
+            _updateTreeData(_lastsys);
+        }
     }
-    hideProgressBar();
-    _stvm->reload(); // update everything;
-    _dtvm->reload();
+    _merging = false;
+
+    if (_loader->isFinished()) loadFinished();
+}
+
+void MainWindow::loadProgress(QString text, int value, int max) {
+    if (_loader && _loader->is_canceled()) return;
+    updateProgressBarTitle(text);
+    updateProgressBarValue(value, max);
+}
+
+void MainWindow::loadTimeJump(QString filename, bool forward, int file) {
+    // the worker of that file waits for the answer. Ask one question after the other.
+    timejump_t q;
+    q.filename = filename;
+    q.forward = forward;
+    q.file = file;
+    _timejumps.enqueue(q);
+    if (_asking) return;
+    _asking = true;
+    while (!_timejumps.empty()) {
+        q = _timejumps.dequeue();
+        if (!_loader || !_loader->is_question_pending(q.file)) continue; // answered "to all" meanwhile
+
+        // FIXME: give more context to the user
+        const QString text = QString("There is a rapid %1 time jump in %2. Allow jump and make one scenario or demultiplex into separate scenarios?")
+                .arg(q.forward ? "forward" : "backward")
+                .arg(QString::fromStdString(getBasename(q.filename.toStdString())));
+        QMessageBox msg(QMessageBox::Question, "Time jump detected", text, QMessageBox::Yes|QMessageBox::No|QMessageBox::YesToAll|QMessageBox::NoToAll);
+        msg.setButtonText(QMessageBox::Yes, "Allow");
+        msg.setButtonText(QMessageBox::No, "Demux");
+        msg.setButtonText(QMessageBox::YesToAll, "Allow all");
+        msg.setButtonText(QMessageBox::NoToAll, "Demux all");
+        const int answer = msg.exec();
+        if (!_loader) continue;
+        switch (answer) {
+            case QMessageBox::YesToAll:
+                _loader->answer_timejump(q.file, true, true);
+                break;
+            case QMessageBox::Yes:
+                _loader->answer_timejump(q.file, true, false);
+                break;
+            case QMessageBox::NoToAll:
+                _loader->answer_timejump(q.file, false, true);
+                break;
+            default:
+                _loader->answer_timejump(q.file, false, false);
+                break;
+        }
+    }
+    _asking = false;
+}
+
+void MainWindow::loadFinished() {
+    if (!_loader) return;
+    if (_merging) return; // fileLoaded() comes back here
+    fileLoaded(); // whatever is left
+    if (!_loader) return;
 
-    if (_lastsys) {
-        // now trigger updates
-        _updateTextInfo(_lastsys); ///< FIXME: if addFile removes a MavSystem, then this ptr could be invalid...
-        _updateTreeData(_lastsys);
+    if (_loader->is_canceled()) {
+        qDebug() << "Loading files canceled";
     }
+    _loader->deleteLater();
+    _loader = NULL;
+    _timejumps.clear();
+    _dlgprogress->setCancelable(false);
+    hideProgressBar();
+}
+
+void MainWindow::cancelLoading() {
+    if (!_loader) return;
+    _loader->cancel();
+    updateProgressBarTitle("Canceling...");
 }
 
 void MainWindow::on_buttonAddFile_clicked() {
@@ -1090,6 +1008,8 @@ void MainWindow::showProgressBar() {
     if (!_dlgprogress) {
         // new dialog
         _dlgprogress = new DialogProgressBar;
+        connect(_dlgprogress, SIGNAL(canceled()), this, SLOT(cancelLoading()));
+        connect(_dlgprogress, SIGNAL(rejected()), this, SLOT(cancelLoading()));
         _dlgprogress->open();
     } else {
         _dlgprogress->show();
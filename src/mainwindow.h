@@ -24,6 +24,7 @@
 #define MAINWINDOW_H
 
 #include <list>
+#include <QQueue>
 #include <QMainWindow>
 #include <QSettings>
 #include <QItemSelectionModel>
@@ -40,6 +41,7 @@
 #include "SystemTableviewModel.h"
 #include "datatreeviewmodel.h"
 #include "dialogprogressbar.h"
+#include "fileloader.h"
 #include "dialogstats.h"
 #include "dialogscenarioprops.h"
 #include "dialogdatatable.h"
@@ -111,6 +113,11 @@ private slots:
     void on_buttonLogExpand_clicked();
     void on_buttonLogCollapse_clicked();
     void on_buttonLogRemove_clicked();
+    void fileLoaded();
+    void loadProgress(QString text, int value, int max);
+    void loadTimeJump(QString filename, bool forward, int file);
+    void loadFinished();
+    void cancelLoading();
 
 signals:
     void systemSelectionChangedSignal(); ///< indicate that someone clicked on another system -> we need to reload TreeView and the info box
@@ -166,6 +173,17 @@ private:
     DialogProgressBar*_dlgprogress;
     DialogStats * _dlgstats;
 
+    // for loading files in the background
+    FileLoader*_loader; ///< NULL unless loading
+    bool _merging; ///< in fileLoaded()
+    bool _asking; ///< in loadTimeJump()
+    typedef struct {
+        QString filename;
+        bool    forward;
+        int     file;
+    } timejump_t;
+    QQueue<timejump_t> _timejumps; ///< questions from the loader
+
     // for log messages
     QTreeView*_logmsg;
 
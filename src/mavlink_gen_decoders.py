@@ -0,0 +1,215 @@
+#!/usr/bin/env python
+#
+# @file mavlink_gen_decoders.py
+# @brief Generates the decoders of MavlinkDecoders from the MavLink message definitions
+# @author Martin Becker <becker@rcs.ei.tum.de>
+# @date 18.10.2026
+#
+#    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+#
+#    MavLogAnalyzer is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Usage: mavlink_gen_decoders.py <message definitions.xml> <output.cpp>
+#
+# Give the same XML that mavgenerate.py was run with for the headers in MAVLINK_COMMON;
+# the generated code uses their accessors (mavlink_msg_<message>_get_<field>), so a
+# mismatch does not compile. Included XML files are followed.
+
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+# longer numeric arrays are raw payloads (e.g., LOG_DATA, FILE_TRANSFER_PROTOCOL), not signals
+MAX_ARRAY_SERIES = 32
+
+# MavLink type -> (series type, C type for array buffers)
+TYPES = {
+    'int8_t':   ('SERIES_INT', 'int8_t'),
+    'int16_t':  ('SERIES_INT', 'int16_t'),
+    'int32_t':  ('SERIES_INT', 'int32_t'),
+    'int64_t':  ('SERIES_DOUBLE', 'int64_t'),
+    'uint8_t':  ('SERIES_UINT', 'uint8_t'),
+    'uint16_t': ('SERIES_UINT', 'uint16_t'),
+    'uint32_t': ('SERIES_UINT', 'uint32_t'),
+    'uint64_t': ('SERIES_DOUBLE', 'uint64_t'),
+    'uint8_t_mavlink_version': ('SERIES_UINT', 'uint8_t'),
+    'char':     ('SERIES_UINT', 'char'),
+    'float':    ('SERIES_FLOAT', 'float'),
+    'double':   ('SERIES_DOUBLE', 'double'),
+}
+
+# series type -> type argument of MavlinkDecoders::append
+APPEND_TYPES = {
+    'SERIES_INT': 'int',
+    'SERIES_UINT': 'unsigned int',
+    'SERIES_FLOAT': 'float',
+    'SERIES_DOUBLE': 'double',
+}
+
+
+class Field(object):
+    def __init__(self, name, typ, units):
+        m = re.match(r'^\s*([A-Za-z0-9_]+)\s*(?:\[\s*(\d+)\s*\])?\s*$', typ)
+        if not m or m.group(1) not in TYPES:
+            raise ValueError("unknown type '%s' of field '%s'" % (typ, name))
+        self.name = name
+        self.basetype = m.group(1)
+        self.array_length = int(m.group(2)) if m.group(2) else 0
+        self.units = units or ''
+
+    def is_string(self):
+        return self.basetype == 'char' and self.array_length > 0
+
+    def is_skipped(self):
+        return self.array_length > MAX_ARRAY_SERIES and not self.is_string()
+
+    def num_series(self):
+        if self.is_skipped():
+            return 0
+        if self.is_string() or self.array_length == 0:
+            return 1
+        return self.array_length
+
+
+class Message(object):
+    def __init__(self, msgid, name, fields):
+        self.msgid = msgid
+        self.name = name
+        self.fields = fields
+
+    def num_series(self):
+        return sum(f.num_series() for f in self.fields)
+
+
+def read_definitions(filename, messages, seen):
+    """reads the messages of filename and its includes into messages (by id)"""
+    filename = os.path.abspath(filename)
+    if filename in seen:
+        return
+    seen.add(filename)
+    root = ET.parse(filename).getroot()
+    for inc in root.findall('include'):
+        read_definitions(os.path.join(os.path.dirname(filename), inc.text.strip()), messages, seen)
+
+    for msg in root.findall('messages/message'):
+        msgid = int(msg.get('id'))
+        name = msg.get('name')
+        fields = []
+        for f in msg.findall('field'):  # extensions are fields, too; the <extensions/> tag only separates them
+            fields.append(Field(f.get('name'), f.get('type'), f.get('units')))
+        if msgid in messages:
+            sys.stderr.write("%s: message %s has the same id %d as %s, ignored\n"
+                             % (filename, name, msgid, messages[msgid].name))
+            continue
+        messages[msgid] = Message(msgid, name, fields)
+
+
+def c_string(s):
+    return '"' + s.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def emit_message(out, m):
+    lower = m.name.lower()
+    out.append('// #%d' % m.msgid)
+    if m.num_series() > 0:
+        out.append('static const MavlinkDecoders::series_t series_%s[] = {' % m.name)
+        for f in m.fields:
+            if f.is_skipped():
+                continue
+            stype = 'SERIES_EVENT' if f.is_string() else TYPES[f.basetype][0]
+            if f.is_string() or f.array_length == 0:
+                names = [f.name]
+            else:
+                names = ['%s_%d' % (f.name, k) for k in range(f.array_length)]
+            for n in names:
+                out.append('    {%s, %s, MavlinkDecoders::%s},' % (c_string(n), c_string(f.units), stype))
+        out.append('};')
+
+    out.append('static void decode_%s(const mavlink_message_t & msg, DataTimed*const* series, double t) {' % m.name)
+    if m.num_series() == 0:
+        out.append('    (void) msg; (void) series; (void) t;')
+    idx = 0
+    for f in m.fields:
+        if f.is_skipped():
+            continue
+        getter = 'mavlink_msg_%s_get_%s' % (lower, f.name)
+        if f.is_string():
+            out.append('    {')
+            out.append('        char v[%d];' % (f.array_length + 1))
+            out.append('        %s(&msg, v);' % getter)
+            out.append('        v[%d] = 0;' % f.array_length)
+            out.append('        MavlinkDecoders::append_event(series[%d], v, t);' % idx)
+            out.append('    }')
+        elif f.array_length > 0:
+            stype, ctype = TYPES[f.basetype]
+            out.append('    {')
+            out.append('        %s v[%d];' % (ctype, f.array_length))
+            out.append('        %s(&msg, v);' % getter)
+            out.append('        for (unsigned int k=0; k < %d; ++k) {' % f.array_length)
+            out.append('            MavlinkDecoders::append<%s>(series[%d + k], v[k], t);' % (APPEND_TYPES[stype], idx))
+            out.append('        }')
+            out.append('    }')
+        else:
+            stype = TYPES[f.basetype][0]
+            out.append('    MavlinkDecoders::append<%s>(series[%d], %s(&msg), t);' % (APPEND_TYPES[stype], idx, getter))
+        idx += f.num_series()
+    out.append('}')
+    out.append('')
+
+
+def generate(xmlfile, outfile):
+    messages = {}
+    read_definitions(xmlfile, messages, set())
+    if not messages:
+        sys.stderr.write("%s: no messages found\n" % xmlfile)
+        return 1
+
+    ordered = [messages[k] for k in sorted(messages.keys())]
+    out = []
+    out.append('/*')
+    out.append(' * Generated by mavlink_gen_decoders.py from %s. Do not edit.' % os.path.basename(xmlfile))
+    out.append(' */')
+    out.append('')
+    out.append('#include "mavlinkdecoders.h"')
+    out.append('')
+    for m in ordered:
+        emit_message(out, m)
+
+    out.append('// sorted by msgid')
+    out.append('const MavlinkDecoders::message_t MavlinkDecoders::_messages[] = {')
+    for m in ordered:
+        series = ('series_%s' % m.name) if m.num_series() > 0 else 'NULL'
+        out.append('    {MAVLINK_MSG_ID_%s, %s, %d, %s, &decode_%s},'
+                   % (m.name, c_string(m.name), m.num_series(), series, m.name))
+    out.append('};')
+    out.append('const unsigned int MavlinkDecoders::_n_messages = sizeof(MavlinkDecoders::_messages)/sizeof(MavlinkDecoders::_messages[0]);')
+    out.append('')
+
+    text = '\n'.join(out)
+    # do not touch the output if nothing changed, so that make does not rebuild
+    if os.path.exists(outfile):
+        with open(outfile) as f:
+            if f.read() == text:
+                return 0
+    with open(outfile, 'w') as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.stderr.write("Usage: %s <message definitions.xml> <output.cpp>\n" % sys.argv[0])
+        sys.exit(2)
+    sys.exit(generate(sys.argv[1], sys.argv[2]))
@@ -0,0 +1,312 @@
+/**
+ * @file mavlinkchunkedparser.cpp
+ * @brief Parses a Mavlink logfile with several threads, by cutting it into pieces
+ * at frame boundaries and stitching the results back together.
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <QRunnable>
+#include <QMutexLocker>
+#include "mavlinkchunkedparser.h"
+#include "mavlinkparser.h"
+
+using namespace std;
+
+/**
+ * @brief parses one piece in the thread pool
+ */
+class MavlinkChunkWorker : public QRunnable {
+public:
+    MavlinkChunkWorker(MavlinkChunkedParser*parser, unsigned int idx) : _parser(parser), _idx(idx) {}
+    void run() { _parser->_work(_idx); }
+private:
+    MavlinkChunkedParser*_parser;
+    unsigned int         _idx;
+};
+
+static inline bool is_stx(uint8_t c) {
+#ifdef MAVLINK_STX_MAVLINK1
+    return c == MAVLINK_STX || c == MAVLINK_STX_MAVLINK1;
+#else
+    return c == MAVLINK_STX;
+#endif
+}
+
+MavlinkChunkedParser::MavlinkChunkedParser(const std::string &filename, unsigned int nthreads) :
+    valid(false), _filename(filename), _src(NULL), _data(NULL), _nthreads(nthreads), _target(NULL),
+    _n_msg(0), _n_fallbacks(0) {
+
+    // every worker needs its own MAVLink channel, and channel 0 is ours
+    if (_nthreads > MAVLINK_COMM_NUM_BUFFERS - 1) _nthreads = MAVLINK_COMM_NUM_BUFFERS - 1;
+    if (_nthreads < 1) _nthreads = 1;
+
+    _src = ByteSource::open(_filename);
+    _data = _src->get_data(); // NULL if not mapped
+    valid = _src->valid;
+}
+
+MavlinkChunkedParser::~MavlinkChunkedParser() {
+    _pool.waitForDone();
+    for (vector<chunk_t>::iterator it = _chunks.begin(); it != _chunks.end(); ++it) {
+        delete it->scenario;
+    }
+    delete _src;
+}
+
+bool MavlinkChunkedParser::parse(MavlinkScenario &scenario) {
+    if (!valid) return false;
+    _target = &scenario;
+    _n_msg = 0;
+    _n_fallbacks = 0;
+
+    const uint64_t size = _src->get_size();
+    uint64_t nchunks = 2*_nthreads; // some more than threads, since pieces take different times
+    if (size / MIN_CHUNKSIZE < nchunks) nchunks = size / MIN_CHUNKSIZE;
+    if (!_data || _nthreads < 2 || nchunks < 2) {
+        _parse_sequential(scenario);
+        return true;
+    }
+
+    _find_chunks((unsigned int) nchunks);
+    _free_channels.clear();
+    for (unsigned int k=1; k <= _nthreads; ++k) {
+        _free_channels.insert((uint8_t) k);
+    }
+    _pool.setMaxThreadCount(_nthreads);
+    for (unsigned int k=0; k < _chunks.size(); ++k) {
+        _pool.start(new MavlinkChunkWorker(this, k));
+    }
+
+    // stitch in order, while later pieces are still being worked on
+    uint64_t pos = 0;
+    for (unsigned int k=0; k < _chunks.size(); ++k) {
+        chunk_t & c = _chunks[k];
+        {
+            QMutexLocker lock(&_mutex);
+            while (!c.done) {
+                _chunk_done.wait(&_mutex);
+            }
+        }
+        if (0 == k) {
+            _n_msg += c.n_msg;
+            pos = c.end;
+        } else {
+            _stitch(c, scenario, pos);
+        }
+        delete c.scenario;
+        c.scenario = NULL;
+        c.systems.clear();
+    }
+    _pool.waitForDone();
+    return true;
+}
+
+void MavlinkChunkedParser::_parse_sequential(MavlinkScenario &scenario) {
+    MavlinkParser*parser;
+    if (_data) {
+        parser = new MavlinkParser(new ByteSourceMemory(_data, (size_t) _src->get_size()), _filename);
+    } else {
+        parser = new MavlinkParser(_filename, ByteSource::SOURCE_BUFFERED);
+    }
+    mavlink_message_t msg;
+    while (parser->get_next_msg(msg)) {
+        scenario.add_mavlink_message(msg);
+    }
+    _n_msg = parser->get_num_messages();
+    delete parser;
+}
+
+void MavlinkChunkedParser::_find_chunks(unsigned int nchunks) {
+    const uint64_t size = _src->get_size();
+
+    chunk_t c;
+    c.begin = 0;
+    c.limit = size;
+    c.end = 0;
+    c.scenario = NULL;
+    c.n_msg = 0;
+    c.done = false;
+
+    _chunks.clear();
+    _chunks.push_back(c); // the first always starts at the beginning
+    for (unsigned int j=1; j < nchunks; ++j) {
+        const uint64_t nominal = (size / nchunks) * j;
+        if (nominal <= _chunks.back().begin) continue;
+        if (!_find_boundary(nominal, c.begin)) break;
+        if (c.begin <= _chunks.back().begin) continue;
+        _chunks.push_back(c);
+    }
+    for (unsigned int k=0; k+1 < _chunks.size(); ++k) {
+        _chunks[k].limit = _chunks[k+1].begin;
+    }
+}
+
+bool MavlinkChunkedParser::_find_boundary(uint64_t from, uint64_t &boundary) const {
+    const uint64_t size = _src->get_size();
+    for (uint64_t p = from; p < size; ++p) {
+        if (!is_stx(_data[p])) continue;
+        size_t len1;
+        if (!MavlinkParser::probe_frame(_data + p, (size_t)(size - p), 0, len1)) continue;
+
+        // a payload may look like a frame by chance; the next frame must be valid as well
+        uint64_t q = p + len1;
+        const uint64_t qmax = q + MAVLINK_MAX_PACKET_LEN;
+        while (q < size && q < qmax && !is_stx(_data[q])) ++q;
+        size_t len2;
+        if (q >= size || !MavlinkParser::probe_frame(_data + q, (size_t)(size - q), 0, len2)) continue;
+
+        // a garbage byte that looks like STX shortly before may swallow the frame
+        if (!_settles_at(p)) continue;
+        boundary = p;
+        return true;
+    }
+    return false;
+}
+
+bool MavlinkChunkedParser::_settles_at(uint64_t pos) const {
+    const uint64_t lookback = 4*MAVLINK_MAX_PACKET_LEN;
+    const uint64_t from = pos > lookback ? pos - lookback : 0;
+    MavlinkParser parser(new ByteSourceMemory(_data + from, (size_t)(_src->get_size() - from)), _filename, 0);
+    parser.set_limit(pos - from);
+    mavlink_message_t msg;
+    while (parser.get_next_msg(msg)) {}
+    return from + parser.get_bytes_consumed() == pos;
+}
+
+uint8_t MavlinkChunkedParser::_acquire_channel() {
+    QMutexLocker lock(&_mutex);
+    // there are never more workers than channels
+    const uint8_t chan = *_free_channels.begin();
+    _free_channels.erase(_free_channels.begin());
+    return chan;
+}
+
+void MavlinkChunkedParser::_release_channel(uint8_t chan) {
+    QMutexLocker lock(&_mutex);
+    _free_channels.insert(chan);
+}
+
+void MavlinkChunkedParser::_work(unsigned int idx) {
+    chunk_t & c = _chunks[idx];
+    const uint8_t chan = _acquire_channel();
+
+    if (0 == idx) {
+        // the first piece can go directly where it belongs
+        const map<uint8_t, unsigned int> all;
+        c.end = _parse_range(*_target, c.begin, c.limit, chan, all, c.n_msg);
+    } else {
+        c.scenario = new MavlinkScenario(_target->_args);
+        c.scenario->_start_unsynced = true;
+
+        MavlinkParser parser(new ByteSourceMemory(_data + c.begin, (size_t)(_src->get_size() - c.begin)), _filename, chan);
+        parser.set_limit(c.limit - c.begin);
+        mavlink_message_t msg;
+        while (parser.get_next_msg(msg)) {
+            c.scenario->add_mavlink_message(msg);
+
+            // keep everything until the state of the system is known
+            sysprefix_t & p = c.systems[msg.sysid];
+            if (p.have_mark || p.overflow) continue;
+            if (p.msgs.size() >= MAX_PREFIX) {
+                p.overflow = true;
+                continue;
+            }
+            p.msgs.push_back(msg);
+            if (MAVLINK_MSG_ID_HEARTBEAT == msg.msgid) {
+                p.have_heartbeat = true;
+            }
+            MavSystem*const sys = c.scenario->_get_or_add_system_byid(msg.sysid);
+            if (p.have_heartbeat && !sys->is_time_unsynced()) {
+                sys->mark_chunksync(p.mark);
+                p.have_mark = true;
+            }
+        }
+        c.n_msg = parser.get_num_messages();
+        c.end = c.begin + parser.get_bytes_consumed();
+    }
+
+    _release_channel(chan);
+    QMutexLocker lock(&_mutex);
+    c.done = true;
+    _chunk_done.wakeAll();
+}
+
+void MavlinkChunkedParser::_stitch(chunk_t &c, MavlinkScenario &scenario, uint64_t &pos) {
+    const map<uint8_t, unsigned int> all;
+    if (pos != c.begin) {
+        // the previous piece did not end where this one began; continue sequentially instead
+        unsigned int n = 0;
+        pos = _parse_range(scenario, pos, c.limit, 0, all, n);
+        _n_msg += n;
+        _n_fallbacks++;
+        return;
+    }
+
+    map<uint8_t, unsigned int> reparse; ///< sysid -> number of messages already fed
+    for (map<uint8_t, sysprefix_t>::const_iterator it = c.systems.begin(); it != c.systems.end(); ++it) {
+        const sysprefix_t & p = it->second;
+        for (vector<mavlink_message_t>::const_iterator itm = p.msgs.begin(); itm != p.msgs.end(); ++itm) {
+            scenario.add_mavlink_message(*itm);
+        }
+        if (p.have_mark) {
+            MavSystem*const mine = scenario._get_or_add_system_byid(it->first);
+            const MavSystem*const theirs = c.scenario->get_system_byid(it->first);
+            if (mine && theirs && mine->matches_chunksync(p.mark) && mine->append_chunk(theirs, p.mark)) {
+                MavSystem::mavlink_summary_t stats;
+                theirs->get_mavlink_stats(stats);
+                scenario._n_msgs += stats.num_received - p.mark.mavlink_summary.num_received;
+                scenario._n_ignored += stats.num_uninterpreted - p.mark.mavlink_summary.num_uninterpreted;
+                continue;
+            }
+            reparse[it->first] = p.msgs.size();
+        } else if (p.overflow) {
+            reparse[it->first] = p.msgs.size();
+        }
+    }
+    if (!reparse.empty()) {
+        unsigned int n = 0;
+        _parse_range(scenario, c.begin, c.limit, 0, reparse, n);
+        _n_fallbacks++;
+    }
+    _n_msg += c.n_msg;
+    pos = c.end;
+}
+
+uint64_t MavlinkChunkedParser::_parse_range(MavlinkScenario &scenario, uint64_t begin, uint64_t limit, uint8_t chan,
+                                            const std::map<uint8_t, unsigned int> &only, unsigned int &n_msg) const {
+    MavlinkParser parser(new ByteSourceMemory(_data + begin, (size_t)(_src->get_size() - begin)), _filename, chan);
+    parser.set_limit(limit > begin ? limit - begin : 0);
+
+    map<uint8_t, unsigned int> skip(only);
+    mavlink_message_t msg;
+    while (parser.get_next_msg(msg)) {
+        if (!only.empty()) {
+            map<uint8_t, unsigned int>::iterator it = skip.find(msg.sysid);
+            if (it == skip.end()) continue;
+            if (it->second > 0) {
+                it->second--;
+                continue;
+            }
+        }
+        scenario.add_mavlink_message(msg);
+    }
+    n_msg = parser.get_num_messages();
+    return begin + parser.get_bytes_consumed();
+}
@@ -0,0 +1,156 @@
+/**
+ * @file mavlinkchunkedparser.h
+ * @brief Parses a Mavlink logfile with several threads, by cutting it into pieces
+ * at frame boundaries and stitching the results back together.
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef MAVLINKCHUNKEDPARSER_H
+#define MAVLINKCHUNKEDPARSER_H
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include "mavlink.h"
+#include "bytesource.h"
+#include "mavsystem.h"
+#include "mavlinkscenario.h"
+
+/**
+ * The file is mapped into memory and cut into pieces, each starting with a valid frame.
+ * Every piece is parsed by a worker thread into its own scenario, whose systems do not know
+ * the time at first. As soon as a system has seen an actual timestamp and a heartbeat, its
+ * state is remembered (MavSystem::mark_chunksync()). The calling thread then goes through the
+ * pieces in order: it feeds the messages before the mark into the target scenario, checks that
+ * the target arrived at the same state, and then appends everything after the mark. Whenever
+ * something does not line up, that part is parsed again sequentially, so the result is always
+ * the same as with MavlinkParser and MavlinkScenario::add_mavlink_message().
+ *
+ * Without mmap (e.g., Windows), or with one thread, this falls back to sequential parsing.
+ */
+class MavlinkChunkedParser {
+public:
+    /**
+     * @param filename the logfile
+     * @param nthreads number of worker threads
+     */
+    MavlinkChunkedParser(const std::string & filename, unsigned int nthreads);
+    ~MavlinkChunkedParser();
+
+    /**
+     * @brief parse the whole file into the given scenario. Time jumps are not allowed,
+     * as with add_mavlink_message(msg).
+     * @return false on error
+     */
+    bool parse(MavlinkScenario & scenario);
+
+    const std::string& get_filename(void) const { return _filename; }
+    uint64_t get_bytes_total(void) const { return _src ? _src->get_size() : 0; }
+    unsigned int get_num_chunks(void) const { return _chunks.size(); }
+    unsigned int get_num_messages(void) const { return _n_msg; }
+
+    /**
+     * @brief how often parts had to be parsed again, because pieces did not line up
+     */
+    unsigned int get_num_fallbacks(void) const { return _n_fallbacks; }
+
+    /****************************************
+     *     DATA MEMBERS
+     ****************************************/
+    bool  valid; //< indicates error
+
+    static const uint64_t     MIN_CHUNKSIZE = 4*1024*1024; ///< smaller pieces are not worth the overhead
+    static const unsigned int MAX_PREFIX = 10000; ///< messages per system stored until its state is known
+
+private:
+    /**
+     * @brief what a worker found out about one system in its piece
+     */
+    typedef struct sysprefix_s {
+        std::vector<mavlink_message_t> msgs; ///< messages before the mark, to be replayed
+        bool have_heartbeat;
+        bool have_mark;
+        bool overflow; ///< too many messages before the mark; msgs is incomplete
+        MavSystem::chunksync_t mark;
+        sysprefix_s() : have_heartbeat(false), have_mark(false), overflow(false) {}
+    } sysprefix_t;
+
+    /**
+     * @brief one piece of the file
+     */
+    typedef struct chunk_s {
+        uint64_t begin; ///< offset of first byte
+        uint64_t limit; ///< offset where parsing should stop (next piece)
+        uint64_t end; ///< offset where parsing actually stopped
+        MavlinkScenario* scenario; ///< where the worker put the data; NULL for the first piece
+        std::map<uint8_t, sysprefix_t> systems;
+        unsigned int n_msg;
+        bool done;
+    } chunk_t;
+
+    friend class MavlinkChunkWorker;
+
+    void _parse_sequential(MavlinkScenario & scenario);
+    void _find_chunks(unsigned int nchunks);
+    bool _find_boundary(uint64_t from, uint64_t &boundary) const;
+
+    /**
+     * @brief check whether parsing from somewhat earlier is outside of a frame at pos
+     */
+    bool _settles_at(uint64_t pos) const;
+
+    void _work(unsigned int idx);
+    void _stitch(chunk_t & c, MavlinkScenario & scenario, uint64_t &pos);
+
+    /**
+     * @brief parse [begin, end of file) into scenario, until the first frame boundary after limit
+     * @param only if not empty: feed only messages of these systems, and skip the given number of each first
+     * @return offset where it stopped
+     */
+    uint64_t _parse_range(MavlinkScenario & scenario, uint64_t begin, uint64_t limit, uint8_t chan,
+                          const std::map<uint8_t, unsigned int> & only, unsigned int &n_msg) const;
+
+    uint8_t _acquire_channel(void);
+    void _release_channel(uint8_t chan);
+
+    /****************************************
+     *     DATA MEMBERS
+     ****************************************/
+    std::string          _filename;
+    ByteSource*          _src;
+    const uint8_t*       _data;
+    unsigned int         _nthreads;
+    std::vector<chunk_t> _chunks;
+    MavlinkScenario*     _target;
+    unsigned int         _n_msg;
+    unsigned int         _n_fallbacks;
+
+    QThreadPool          _pool;
+    QMutex               _mutex; ///< protects chunk_t::done and _free_channels
+    QWaitCondition       _chunk_done;
+    std::set<uint8_t>    _free_channels; ///< MAVLink channels for the workers
+};
+
+#endif // MAVLINKCHUNKEDPARSER_H
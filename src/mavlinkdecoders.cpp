@@ -0,0 +1,107 @@
+/**
+ * @file mavlinkdecoders.cpp
+ * @brief Decoders for all MavLink messages, generated from the message definitions
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "mavlinkdecoders.h"
+
+using namespace std;
+
+#ifdef WITHOUT_GENERATED_DECODERS
+// an array cannot be empty, but this entry is never looked at
+const MavlinkDecoders::message_t MavlinkDecoders::_messages[] = { {0, NULL, 0, NULL, NULL} };
+const unsigned int MavlinkDecoders::_n_messages = 0;
+#endif
+
+int MavlinkDecoders::_index_of(uint32_t msgid) {
+    unsigned int lo = 0, hi = _n_messages;
+    while (lo < hi) {
+        const unsigned int mid = (lo + hi) / 2;
+        if (_messages[mid].msgid < msgid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < _n_messages && _messages[lo].msgid == msgid) return (int) lo;
+    return -1;
+}
+
+const MavlinkDecoders::message_t* MavlinkDecoders::find_message(uint32_t msgid) {
+    const int idx = _index_of(msgid);
+    return idx < 0 ? NULL : &_messages[idx];
+}
+
+void MavlinkDecoders::clear(void) {
+    _systems.clear();
+    _last = 0;
+}
+
+void MavlinkDecoders::_bind(MavSystem *sys, const message_t &m, binding_t &b) {
+    b.bound = true;
+    b.series.assign(m.n_series, NULL);
+    const string stem = string("mavlink/") + m.name + "/";
+    for (unsigned int k=0; k < m.n_series; ++k) {
+        const series_t & s = m.series[k];
+        const string fullname = stem + s.name;
+        switch (s.type) {
+        case SERIES_INT:
+            b.series[k] = sys->bind_generic_timeseries<int>(fullname, s.units);
+            break;
+        case SERIES_UINT:
+            b.series[k] = sys->bind_generic_timeseries<unsigned int>(fullname, s.units);
+            break;
+        case SERIES_FLOAT:
+            b.series[k] = sys->bind_generic_timeseries<float>(fullname, s.units);
+            break;
+        case SERIES_DOUBLE:
+            b.series[k] = sys->bind_generic_timeseries<double>(fullname, s.units);
+            break;
+        case SERIES_EVENT:
+            b.series[k] = sys->bind_generic_event<std::string>(fullname, s.units);
+            break;
+        }
+    }
+}
+
+bool MavlinkDecoders::decode(MavSystem *sys, const mavlink_message_t &msg) {
+    const int idx = _index_of(msg.msgid);
+    if (idx < 0) return false;
+
+    if (_last >= _systems.size() || _systems[_last].sys != sys) {
+        _last = 0;
+        while (_last < _systems.size() && _systems[_last].sys != sys) ++_last;
+        if (_last == _systems.size()) {
+            binding_t unbound;
+            unbound.bound = false;
+            sysbinding_t sb;
+            sb.sys = sys;
+            _systems.push_back(sb);
+            _systems.back().msgs.assign(_n_messages, unbound);
+        }
+    }
+
+    const message_t & m = _messages[idx];
+    binding_t & b = _systems[_last].msgs[idx];
+    if (!b.bound) _bind(sys, m, b);
+    m.decode(msg, b.series.empty() ? NULL : &b.series[0], sys->get_rel_time_sec());
+    return true;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file mavlinkdecoders.h
+ * @brief Decoders for all MavLink messages, generated from the message definitions
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef MAVLINKDECODERS_H
+#define MAVLINKDECODERS_H
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include "mavlink.h"
+#include "mavsystem.h"
+#include "data_timeseries.h"
+#include "data_event.h"
+
+/**
+ * @brief stores the fields of any MavLink message as they are, below "mavlink/<MESSAGE>/".
+ *
+ * The table of messages and one decoder function per message are generated by
+ * mavlink_gen_decoders.py from the same XML as the MavLink headers (see MavLogAnalyzer.pro),
+ * into mavlinkdecoders_gen.cpp. A decoder uses the accessors from mavlink.h and appends each
+ * field to a series, which is looked up only for the first message of its type and system.
+ * Without the XML, WITHOUT_GENERATED_DECODERS is defined and there are no decoders.
+ *
+ * Numeric arrays get one series per element ("<field>_<k>"), except for long ones, which are
+ * raw payloads. Character arrays are events.
+ */
+class MavlinkDecoders {
+public:
+    typedef enum {
+        SERIES_INT,    ///< DataTimeseries<int>: int8..int32
+        SERIES_UINT,   ///< DataTimeseries<unsigned int>: uint8..uint32, char
+        SERIES_FLOAT,  ///< DataTimeseries<float>
+        SERIES_DOUBLE, ///< DataTimeseries<double>: double, and (u)int64, which do not fit the others
+        SERIES_EVENT   ///< DataEvent<std::string>: character arrays
+    } seriestype_e;
+
+    /**
+     * @brief one series of a message; array elements have one each
+     */
+    typedef struct {
+        const char*  name;
+        const char*  units;
+        seriestype_e type;
+    } series_t;
+
+    /**
+     * @brief appends the fields of msg to the series, in the order of message_t::series.
+     * An entry of series is NULL if the series could not be created.
+     */
+    typedef void (*decode_fn)(const mavlink_message_t & msg, DataTimed*const* series, double t);
+
+    typedef struct {
+        uint32_t        msgid;
+        const char*     name;
+        unsigned int    n_series;
+        const series_t* series;
+        decode_fn       decode;
+    } message_t;
+
+    MavlinkDecoders() : _last(0) {}
+
+    /**
+     * @brief decode msg into the series of sys, at the current time of sys
+     * @return false if there is no decoder for this message
+     */
+    bool decode(MavSystem*sys, const mavlink_message_t & msg);
+
+    /**
+     * @brief forget all series. Call when series may have been deleted, e.g., when systems were
+     * merged. MavlinkScenario does that.
+     */
+    void clear(void);
+
+    /**
+     * @return the decoder for the given message, or NULL if the definitions do not have it
+     */
+    static const message_t* find_message(uint32_t msgid);
+
+    static unsigned int get_num_messages(void) { return _n_messages; }
+
+    /*******************
+     * FOR THE GENERATED DECODERS
+     *******************/
+    template <typename T, typename V>
+    static inline void append(DataTimed*series, const V & val, double t) {
+        if (series) static_cast<DataTimeseries<T>*>(series)->add_elem((T) val, t);
+    }
+
+    static inline void append_event(DataTimed*series, const char*str, double t) {
+        if (series) static_cast<DataEvent<std::string>*>(series)->add_elem(std::string(str), t);
+    }
+
+private:
+    /**
+     * @brief the series of one message type
+     */
+    typedef struct {
+        bool                    bound;  ///< whether they were looked up already
+        std::vector<DataTimed*> series; ///< like message_t::series
+    } binding_t;
+
+    /**
+     * @brief the series of all message types of one system
+     */
+    typedef struct {
+        MavSystem*             sys;
+        std::vector<binding_t> msgs; ///< like _messages
+    } sysbinding_t;
+
+    static int _index_of(uint32_t msgid);
+    static void _bind(MavSystem*sys, const message_t & m, binding_t & b);
+
+    std::vector<sysbinding_t> _systems;
+    unsigned int              _last; ///< index of the system of the previous message
+
+    // generated, sorted by msgid
+    static const message_t    _messages[];
+    static const unsigned int _n_messages;
+};
+
+#endif // MAVLINKDECODERS_H
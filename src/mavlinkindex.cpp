@@ -0,0 +1,235 @@
+/**
+ * @file mavlinkindex.cpp
+ * @brief Index of all messages in a Mavlink logfile, to decode only parts of it
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "mavlinkindex.h"
+#include "mavlinkparser.h"
+#include "bytesource.h"
+
+using namespace std;
+
+// sidecar layout (little endian): magic, file size, file mtime, #entries, entries
+static const char     SIDECAR_MAGIC[8] = {'M','L','A','I','D','X','0','1'};
+static const size_t   SIDECAR_HEADER_LEN = 8 + 3*8;
+static const size_t   SIDECAR_ENTRY_LEN = 8 + 4 + 1 + 1 + 2;
+
+static void put_le(uint8_t*buf, uint64_t val, unsigned int nbytes) {
+    for (unsigned int k=0; k < nbytes; ++k) {
+        buf[k] = (uint8_t)(val >> (8*k));
+    }
+}
+
+static uint64_t get_le(const uint8_t*buf, unsigned int nbytes) {
+    uint64_t val = 0;
+    for (unsigned int k=0; k < nbytes; ++k) {
+        val |= ((uint64_t)buf[k]) << (8*k);
+    }
+    return val;
+}
+
+MavlinkIndex::MavlinkIndex(const std::string &filename) : valid(false), _filename(filename) {}
+
+bool MavlinkIndex::load_or_build(bool use_sidecar) {
+    if (use_sidecar && load_sidecar()) return true;
+    if (!build()) return false;
+    if (use_sidecar && !save_sidecar()) {
+        fprintf(stderr, "Could not write index %s\n", get_sidecar_filename().c_str());
+    }
+    return true;
+}
+
+bool MavlinkIndex::build() {
+    valid = false;
+    _entries.clear();
+
+    MavlinkParser parser(_filename);
+    if (!parser.valid) return false;
+    // roughly 30 bytes per message in usual logs
+    _entries.reserve((size_t)(parser.get_bytes_total() / 30));
+
+    mavlink_message_t msg;
+    while (parser.get_next_msg(msg)) {
+        entry_t e;
+        e.len = (uint16_t) MavlinkParser::frame_length(msg);
+        e.offset = parser.get_bytes_consumed() - e.len;
+        e.msgid = msg.msgid;
+        e.sysid = msg.sysid;
+        e.compid = msg.compid;
+        _entries.push_back(e);
+    }
+    valid = true;
+    return true;
+}
+
+bool MavlinkIndex::_get_fileprops(uint64_t &size, int64_t &mtime) const {
+    // 64bit sizes, the logs that need an index are the large ones
+#if defined(WIN32) || defined(__WIN32) || defined(__WIN32__)
+    struct _stat64 st;
+    if (_stat64(_filename.c_str(), &st) != 0) return false;
+#else
+    struct stat st; // off_t is 64bit, see _FILE_OFFSET_BITS in MavLogAnalyzer.pro
+    if (stat(_filename.c_str(), &st) != 0) return false;
+#endif
+    size = (uint64_t) st.st_size;
+    mtime = (int64_t) st.st_mtime;
+    return true;
+}
+
+bool MavlinkIndex::save_sidecar() const {
+    if (!valid) return false;
+    uint64_t size;
+    int64_t mtime;
+    if (!_get_fileprops(size, mtime)) return false;
+
+    const string fname = get_sidecar_filename();
+    FILE*fp = fopen(fname.c_str(), "wb");
+    if (!fp) return false;
+
+    uint8_t hdr[SIDECAR_HEADER_LEN];
+    memcpy(hdr, SIDECAR_MAGIC, 8);
+    put_le(hdr + 8, size, 8);
+    put_le(hdr + 16, (uint64_t)mtime, 8);
+    put_le(hdr + 24, _entries.size(), 8);
+    bool ok = (fwrite(hdr, 1, sizeof(hdr), fp) == sizeof(hdr));
+
+    const size_t ENTRIES_PER_WRITE = 4096;
+    vector<uint8_t> buf(ENTRIES_PER_WRITE*SIDECAR_ENTRY_LEN);
+    for (size_t k=0; ok && k < _entries.size(); k += ENTRIES_PER_WRITE) {
+        size_t n = _entries.size() - k;
+        if (n > ENTRIES_PER_WRITE) n = ENTRIES_PER_WRITE;
+        for (size_t j=0; j < n; ++j) {
+            const entry_t & e = _entries[k+j];
+            uint8_t*b = &buf[j*SIDECAR_ENTRY_LEN];
+            put_le(b, e.offset, 8);
+            put_le(b + 8, e.msgid, 4);
+            b[12] = e.sysid;
+            b[13] = e.compid;
+            put_le(b + 14, e.len, 2);
+        }
+        ok = (fwrite(&buf[0], SIDECAR_ENTRY_LEN, n, fp) == n);
+    }
+    fclose(fp);
+    if (!ok) {
+        remove(fname.c_str()); // don't leave a broken one
+    }
+    return ok;
+}
+
+bool MavlinkIndex::load_sidecar() {
+    valid = false;
+    _entries.clear();
+    uint64_t size;
+    int64_t mtime;
+    if (!_get_fileprops(size, mtime)) return false;
+
+    FILE*fp = fopen(get_sidecar_filename().c_str(), "rb");
+    if (!fp) return false;
+
+    uint8_t hdr[SIDECAR_HEADER_LEN];
+    if (fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr) || memcmp(hdr, SIDECAR_MAGIC, 8) != 0 ||
+        get_le(hdr + 8, 8) != size || (int64_t)get_le(hdr + 16, 8) != mtime) {
+        fclose(fp);
+        return false; // not ours, or outdated
+    }
+    const uint64_t n_total = get_le(hdr + 24, 8);
+    if (n_total > size / MAVLINK_NUM_NON_PAYLOAD_BYTES) {
+        fclose(fp);
+        return false; // cannot be
+    }
+
+    _entries.resize((size_t)n_total);
+    const size_t ENTRIES_PER_READ = 4096;
+    vector<uint8_t> buf(ENTRIES_PER_READ*SIDECAR_ENTRY_LEN);
+    bool ok = true;
+    for (size_t k=0; ok && k < _entries.size(); k += ENTRIES_PER_READ) {
+        size_t n = _entries.size() - k;
+        if (n > ENTRIES_PER_READ) n = ENTRIES_PER_READ;
+        if (fread(&buf[0], SIDECAR_ENTRY_LEN, n, fp) != n) {
+            ok = false;
+            break;
+        }
+        for (size_t j=0; j < n; ++j) {
+            entry_t & e = _entries[k+j];
+            const uint8_t*b = &buf[j*SIDECAR_ENTRY_LEN];
+            e.offset = get_le(b, 8);
+            e.msgid = (uint32_t) get_le(b + 8, 4);
+            e.sysid = b[12];
+            e.compid = b[13];
+            e.len = (uint16_t) get_le(b + 14, 2);
+            if (e.offset + e.len > size) ok = false;
+        }
+    }
+    fclose(fp);
+    if (!ok) {
+        _entries.clear();
+        return false;
+    }
+    valid = true;
+    return true;
+}
+
+bool MavlinkIndex::_selected(const entry_t &e, const std::set<unsigned int> &msgids, const std::set<unsigned int> &sysids) {
+    if (!sysids.empty() && sysids.find(e.sysid) == sysids.end()) return false;
+    if (msgids.empty()) return true;
+    if (MAVLINK_MSG_ID_HEARTBEAT == e.msgid || MAVLINK_MSG_ID_SYSTEM_TIME == e.msgid) return true;
+    return msgids.find(e.msgid) != msgids.end();
+}
+
+unsigned int MavlinkIndex::decode(MavlinkScenario &scenario, const std::set<unsigned int> &msgids,
+                                  const std::set<unsigned int> &sysids) const {
+    if (!valid) return 0;
+
+    unsigned int n = 0;
+    mavlink_message_t msg;
+    ByteSource*src = ByteSource::open(_filename);
+    const uint8_t*data = src->valid ? src->get_data() : NULL;
+    if (data) {
+        // jump right to the frames
+        const uint64_t size = src->get_size();
+        for (vector<entry_t>::const_iterator it = _entries.begin(); it != _entries.end(); ++it) {
+            if (!_selected(*it, msgids, sysids)) continue;
+            size_t framelen;
+            if (it->offset >= size ||
+                !MavlinkParser::probe_frame(data + it->offset, (size_t)(size - it->offset), 0, framelen, &msg)) {
+                continue; // file changed after indexing
+            }
+            scenario.add_mavlink_message(msg);
+            ++n;
+        }
+        delete src;
+    } else {
+        // cannot seek in the source; go through the frames, but only decode the selected ones
+        MavlinkParser parser(src, _filename);
+        vector<entry_t>::const_iterator it = _entries.begin();
+        while (it != _entries.end() && parser.get_next_msg(msg)) {
+            if (_selected(*it, msgids, sysids)) {
+                scenario.add_mavlink_message(msg);
+                ++n;
+            }
+            ++it;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file mavlinkindex.h
+ * @brief Index of all messages in a Mavlink logfile, to decode only parts of it
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef MAVLINKINDEX_H
+#define MAVLINKINDEX_H
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <set>
+#include "mavlink.h"
+#include "mavlinkscenario.h"
+
+/**
+ * A first pass only finds the frames (including CRC check) and remembers where they are,
+ * without translating the contents. A second pass then decodes only the messages of interest.
+ * The index can be stored next to the logfile ("<logfile>.idx"), so that the next time the
+ * first pass is not necessary. The sidecar is ignored when size or date of the log changed.
+ */
+class MavlinkIndex {
+public:
+    /**
+     * @brief one message in the logfile
+     */
+    typedef struct {
+        uint64_t offset; ///< position of the frame (STX) in the file
+        uint32_t msgid;
+        uint8_t  sysid;
+        uint8_t  compid;
+        uint16_t len;    ///< length of the whole frame
+    } entry_t;
+
+    MavlinkIndex(const std::string & filename);
+
+    /**
+     * @brief use the sidecar if it is up to date, otherwise scan the file
+     * @param use_sidecar if false, always scan and don't write a sidecar
+     * @return false on error
+     */
+    bool load_or_build(bool use_sidecar = true);
+
+    /**
+     * @brief scan the whole file (framing only)
+     * @return false on error
+     */
+    bool build(void);
+
+    /**
+     * @return false if there is no sidecar, or if it is outdated or broken
+     */
+    bool load_sidecar(void);
+    bool save_sidecar(void) const;
+
+    /**
+     * @brief second pass: feed the selected messages into the scenario, in file order.
+     * Messages which establish the systems and their time base (heartbeat, system time)
+     * are always decoded, otherwise the times of the other messages would be wrong.
+     * @param msgids only these message ids; empty means all
+     * @param sysids only these systems; empty means all
+     * @return number of messages decoded
+     */
+    unsigned int decode(MavlinkScenario & scenario, const std::set<unsigned int> & msgids,
+                        const std::set<unsigned int> & sysids) const;
+
+    const std::vector<entry_t>& get_entries(void) const { return _entries; }
+    unsigned int get_num_entries(void) const { return _entries.size(); }
+    const std::string& get_filename(void) const { return _filename; }
+    std::string get_sidecar_filename(void) const { return _filename + ".idx"; }
+
+    /****************************************
+     *     DATA MEMBERS
+     ****************************************/
+    bool valid; ///< true if the index is complete
+
+private:
+    static bool _selected(const entry_t & e, const std::set<unsigned int> & msgids,
+                          const std::set<unsigned int> & sysids);
+
+    /**
+     * @brief get size and modification time of the log, to tell whether a sidecar belongs to it
+     */
+    bool _get_fileprops(uint64_t & size, int64_t & mtime) const;
+
+    /****************************************
+     *     DATA MEMBERS
+     ****************************************/
+    std::string          _filename;
+    std::vector<entry_t> _entries;
+};
+
+#endif // MAVLINKINDEX_H
@@ -21,31 +21,50 @@
     
  */
 
+#include <string.h>
 #include "mavlinkparser.h"
 
-MavlinkParser::MavlinkParser(std::string filename) : _fp(NULL), _filename(filename), _n_msg(0) {
-    valid = _file_open();
+MavlinkParser::MavlinkParser(std::string filename, ByteSource::sourcetype_e srctype, size_t chunksize) :
+    _src(NULL), _filename(filename), _chan(0), _span(NULL), _span_len(0), _span_pos(0),
+    _span_stop(0), _have_limit(false), _limit(0), _n_msg(0) {
+    memset(&_r_mavlink_status, 0, sizeof(_r_mavlink_status));
+    _reset_channel(_chan);
+    _src = ByteSource::open(_filename, srctype, chunksize);
+    valid = _src->valid;
+}
+
+MavlinkParser::MavlinkParser(ByteSource *src, const std::string &name, uint8_t chan) :
+    _src(src), _filename(name), _chan(chan), _span(NULL), _span_len(0), _span_pos(0),
+    _span_stop(0), _have_limit(false), _limit(0), _n_msg(0) {
+    memset(&_r_mavlink_status, 0, sizeof(_r_mavlink_status));
+    _reset_channel(_chan);
+    valid = _src && _src->valid;
 }
 
 MavlinkParser::~MavlinkParser() {
-    if (_fp) {
-        fclose(_fp);
-        valid = false;
-    }
+    delete _src;
+    valid = false;
 }
 
 bool MavlinkParser::get_next_msg(mavlink_message_t &buf) {
-    if (!valid) return false;    
-
-    // read byte by byte and ask whether it can be parsed...    
-    uint8_t bytebuf;
-    int chan=0;
-    while(fread(&bytebuf, 1, 1, _fp) > 0) { // argh...inefficient
-        if (mavlink_parse_char(chan, bytebuf, &buf, &_r_mavlink_status)) {
-            _n_msg++;
-            return true;
+    if (!valid) return false;
+
+    // feed the state machine from contiguous spans, and only go back to the source when one is used up
+    for (;;) {
+        while (_span_pos < _span_len) {
+            if (_span_pos >= _span_stop && is_idle()) {
+                return false; // reached limit
+            }
+            if (mavlink_parse_char(_chan, _span[_span_pos++], &buf, &_r_mavlink_status)) {
+                _n_msg++;
+                return true;
+            }
         }
+        if (!_src->next_span(_span, _span_len)) break;
+        _span_pos = 0;
+        _update_span_stop();
     }
+    _span_len = _span_pos = 0;
     return false; // nothing found
 }
 
@@ -57,8 +76,67 @@ const std::string &MavlinkParser::get_filename() const {
     return _filename;
 }
 
-bool MavlinkParser::_file_open() {
-    _fp = fopen(_filename.c_str(), "rb");
-    if (!_fp) return false;
-    return true;
+uint64_t MavlinkParser::get_bytes_total() const {
+    return _src ? _src->get_size() : 0;
+}
+
+uint64_t MavlinkParser::get_bytes_consumed() const {
+    if (!_src) return 0;
+    return _src->get_position() - (_span_len - _span_pos);
+}
+
+void MavlinkParser::set_limit(uint64_t nbytes) {
+    _have_limit = true;
+    _limit = nbytes;
+    _update_span_stop();
+}
+
+void MavlinkParser::_update_span_stop() {
+    _span_stop = _span_len;
+    if (!_have_limit) return;
+    const uint64_t span_begin = _src->get_position() - _span_len;
+    if (_limit <= span_begin) {
+        _span_stop = 0;
+    } else if (_limit - span_begin < _span_len) {
+        _span_stop = (size_t)(_limit - span_begin);
+    }
+}
+
+void MavlinkParser::_reset_channel(uint8_t chan) {
+    mavlink_status_t*st = mavlink_get_channel_status(chan);
+    st->parse_state = MAVLINK_PARSE_STATE_IDLE;
+    st->packet_idx = 0;
+    st->msg_received = 0;
+}
+
+bool MavlinkParser::probe_frame(const uint8_t *data, size_t len, uint8_t chan, size_t &framelen, mavlink_message_t*msg) {
+    _reset_channel(chan);
+    if (len > MAVLINK_MAX_PACKET_LEN) len = MAVLINK_MAX_PACKET_LEN;
+
+    mavlink_message_t buf;
+    if (!msg) msg = &buf;
+    mavlink_status_t status;
+    for (size_t k=0; k < len; ++k) {
+        if (mavlink_parse_char(chan, data[k], msg, &status)) {
+            framelen = k + 1;
+            return true;
+        }
+        // the frame must start at the first byte and must not be interrupted
+        if (status.packet_rx_drop_count > 0 || status.parse_state <= MAVLINK_PARSE_STATE_IDLE) {
+            break;
+        }
+    }
+    return false;
+}
+
+size_t MavlinkParser::frame_length(const mavlink_message_t &msg) {
+#ifdef MAVLINK_STX_MAVLINK1
+    if (msg.magic == MAVLINK_STX_MAVLINK1) {
+        return MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + msg.len + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+    const size_t signature = (msg.incompat_flags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0;
+    return MAVLINK_NUM_NON_PAYLOAD_BYTES + msg.len + signature;
+#else
+    return MAVLINK_NUM_NON_PAYLOAD_BYTES + msg.len;
+#endif
 }
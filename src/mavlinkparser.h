@@ -24,19 +24,62 @@
 #ifndef MAVLINKPARSER_H
 #define MAVLINKPARSER_H
 
-#include <stdio.h>
 #include <inttypes.h>
 #include <string>
 #include "mavlink.h" // generated by mavgenerate.py from https://github.com/mavlink/mavlink.git
+#include "bytesource.h"
 
 
 class MavlinkParser {
 public:
-    MavlinkParser(std::string filename);
+    MavlinkParser(std::string filename, ByteSource::sourcetype_e srctype = ByteSource::SOURCE_AUTO,
+                  size_t chunksize = ByteSource::DEFAULT_CHUNKSIZE);
+
+    /**
+     * @brief parse from an arbitrary byte source
+     * @param src byte source; the parser takes ownership
+     * @param name used as filename
+     * @param chan MAVLink channel. Parsers working at the same time need different channels.
+     */
+    MavlinkParser(ByteSource*src, const std::string & name, uint8_t chan = 0);
     ~MavlinkParser();
     bool get_next_msg(mavlink_message_t &buf);
     const mavlink_status_t* get_linkstats(void) const;
     const std::string& get_filename(void) const;
+    const ByteSource* get_source(void) const { return _src; }
+    uint64_t get_bytes_total(void) const;
+    uint64_t get_bytes_consumed(void) const; ///< how far parsing has progressed
+    unsigned int get_num_messages(void) const { return _n_msg; }
+
+    /**
+     * @brief stop parsing at the first point at or after the given number of bytes,
+     * where the state machine is not inside of a frame. Used to cut a file into pieces.
+     */
+    void set_limit(uint64_t nbytes);
+
+    /**
+     * @brief true if the state machine is currently not inside of a frame
+     */
+    bool is_idle(void) const {
+        return _r_mavlink_status.parse_state <= MAVLINK_PARSE_STATE_IDLE;
+    }
+
+    /**
+     * @brief check whether a valid frame (STX...CRC) begins at the given position
+     * @param data where to look
+     * @param len number of bytes available
+     * @param chan MAVLink channel to use for parsing; its state is lost
+     * @param framelen if true, this is set to the length of the frame
+     * @param msg if not NULL and true, this receives the message
+     * @return true if it is a valid frame
+     */
+    static bool probe_frame(const uint8_t*data, size_t len, uint8_t chan, size_t &framelen,
+                            mavlink_message_t*msg = NULL);
+
+    /**
+     * @brief number of bytes the given message occupied in the stream (STX...CRC)
+     */
+    static size_t frame_length(const mavlink_message_t & msg);
 
     /****************************************
      *     DATA MEMBERS
@@ -44,14 +87,23 @@ public:
     bool  valid; //< indicates error
 
 private:
-    bool _file_open(void);
+    static void _reset_channel(uint8_t chan);
+    void _update_span_stop(void);
 
     /****************************************
      *     DATA MEMBERS
      ****************************************/
     // general
-    FILE*       _fp;
+    ByteSource* _src;
     std::string _filename;
+    uint8_t     _chan;
+    // current span from _src
+    const uint8_t* _span;
+    size_t         _span_len;
+    size_t         _span_pos;
+    size_t         _span_stop; ///< from here on, stop as soon as idle
+    bool           _have_limit;
+    uint64_t       _limit;
     // stats
     unsigned int     _n_msg;
     mavlink_status_t _r_mavlink_status;
@@ -31,7 +31,7 @@
 using namespace std;
 
 MavlinkScenario::MavlinkScenario(const CmdlineArgs *const args) : _args(args), _n_msgs(0), _n_ignored(0),
-    _time_guess_epoch_usec(0), _onboard_sysid(-1), _havedb(false), _dbid(0) {
+    _time_guess_epoch_usec(0), _start_unsynced(false), _onboard_sysid(-1), _havedb(false), _dbid(0) {
 
     _onboard_gps_time.have_last = false;
 
@@ -62,6 +62,9 @@ MavSystem* MavlinkScenario::_get_or_add_system_byid(uint8_t id) {
             it->second->set_max_timejumps_fwd(_args->time_maxjump_sec);
             it->second->set_max_timejumps_back(_args->time_maxjump_sec); // FIXME: spend separate argument
         }
+        if (_start_unsynced) {
+            it->second->set_time_unsynced();
+        }
     }
     MavSystem*sys = it->second;
     return sys;
@@ -71,40 +74,24 @@ void MavlinkScenario::log(logmsgtype_e t, const std::string & str) {
     Logger::Instance().write(t, str, _logchannel);
 }
 
-// FIXME: refactor similar to add_mavlink_message (int return) and make polymorphic
-bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
-
-    // check for parser id
-    if (msg._msgname_orig == "_parser_name") {
-        const OnboardData::stringdata_t::const_iterator it = msg.get_stringdata().find("_parser_name");
-        if (it == msg.get_stringdata().end()) return true;
-        _last_onboard_parser = it->second;
-        return true;
-    }
-
-    if (!msg.is_valid()) return true;
-
-    // find MAV system ID and cache it
-    if (msg.get_message_origname().compare("PARM")==0) {
-        const OnboardData::floatdata_t d = msg.get_floatdata();
-        OnboardData::floatdata_t::const_iterator ir = d.find("SYSID_THISMAV");
-        if (ir != d.end()) {
-            _onboard_sysid = ((int) ir->second);                        
-            log(MSG_INFO, stringbuilder() << "Onboard Log: Sysid=" << _onboard_sysid);
-        }
-    }
+MavSystem* MavlinkScenario::_get_onboard_system() {
     if (_onboard_sysid < 0) {
         _onboard_sysid = 1;
         log(MSG_WARN, stringbuilder() << "No system id known...assuming value: " << _onboard_sysid);
         //return false; // don't know yet for which system ID this is
     }
+    return _get_or_add_system_byid(((uint8_t)_onboard_sysid));
+}
 
-    /****************************
-     *  ADD/FIND SYSTEM
-     ****************************/
-    MavSystem* const sys = _get_or_add_system_byid(((uint8_t)_onboard_sysid));
-    if (!sys) return false;
+void MavlinkScenario::_update_onboard_reltime(MavSystem *sys, uint64_t tnow) {
+    if (sys->is_absolute_time(tnow)) {
+        sys->update_time_offset(sys->get_rel_time(), tnow);
+    } else {
+        sys->update_rel_time(tnow, true);
+    }
+}
 
+bool MavlinkScenario::_update_onboard_time(MavSystem *sys, const OnboardData &d) {
     /*
      * Guess the current time. Only the following messages carry timing:
      *  - GPS: TimeMS (ms since week start), week (week number), T=APM time (hal.scheduler.millis)
@@ -112,6 +99,8 @@ bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
      *  - CAM: GPSTime
      */
 
+    const std::string & origname = d.get_message_origname();
+
     // to preserve order when no time is given.
     bool untimed_message = false;
     uint64_t nowtime_us = sys->get_rel_time() + 1;
@@ -120,9 +109,8 @@ bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
     /****************************
      *  ABSOLUTE TIMESTAMPS
      ****************************/
-    if (msg.get_message_origname().compare("GPS")==0 ||
-        msg.get_message_origname().compare("vehicle_gps_position")==0) {
-        const OnboardData::uintdata_t d = msg.get_uintdata();                
+    if (origname.compare("GPS")==0 ||
+        origname.compare("vehicle_gps_position")==0) {
         /**
          * Get GPS time and use it as time reference. Unfortunately
          * gps_week_ms can have huge jumps. Namely, this happens when the GPS gots from no fix to fix.
@@ -133,12 +121,12 @@ bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
         bool valid = true;
         uint16_t gps_week;
         uint32_t gps_week_ms;
-        OnboardData::uintdata_t::const_iterator ir;
+        uint64_t val;
 
         // check if we have a fix
         bool has_gps_fix = false;
         {
-            std::string field_fix;
+            const char*field_fix = NULL;
             if (_last_onboard_parser == "apm") {
                 field_fix = "Status";
             } else if (_last_onboard_parser == "px4") {
@@ -146,11 +134,10 @@ bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
             } else if (_last_onboard_parser == "ulg") {
                 field_fix = "fix_type";
             }
-            ir = d.find(field_fix);
-            if (ir == d.end()) {
+            if (!field_fix || !d.find_uint(field_fix, val)) {
                 valid = false;
             } else {
-                unsigned int gpsfix = ir->second;
+                unsigned int gpsfix = val;
                 const unsigned int GPS_HAS_FIX_CONSTANT = 2; // true for all known parsers so far
                 has_gps_fix = (gpsfix >= GPS_HAS_FIX_CONSTANT);
             }
@@ -163,17 +150,23 @@ bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
                 /**************************
                  * APM time reference
                  **************************/
-                ir = d.find("TimeMS");
-                valid = valid && (ir != d.end());
+                valid = valid && (d.find_uint("TimeMS", val) || d.find_uint("GMS", val)); // GMS since AC3.3
                 if (valid) {
-                    gps_week_ms = ir->second;
+                    gps_week_ms = val;
                 }
-                ir = d.find("Week");
-                valid = valid && (ir != d.end());
+                valid = valid && (d.find_uint("Week", val) || d.find_uint("GWk", val));
                 if (valid) {
-                    gps_week = ir->second;
+                    gps_week = val;
                 }
-                if (valid) {
+                uint64_t time_boot;
+                if (valid && d.find_uint("TimeUS", time_boot)) {
+                    // time since boot is given like in all other messages; GPS only adds the absolute time
+                    nowtime_us = time_boot;
+                    sys->update_time_offset(nowtime_us, gpsepoch2unixepoch_usec(gps_week, gps_week_ms), /*allowjumps=*/true);
+                    _onboard_gps_time.last_nowtime_usec = nowtime_us;
+                    _onboard_gps_time.last_gps_week_ms = gps_week_ms;
+                    _onboard_gps_time.have_last = true;
+                } else if (valid) {
                     if (_onboard_gps_time.have_last) {
                         // update rel. time based on the time lapsed since last GPS message
                         // assumption: GPS week does not wrap during flight
@@ -199,14 +192,13 @@ bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
                  * PX4 and ULOG time reference
                  ******************************/
                 if (_last_onboard_parser == "px4") {
-                    ir = d.find("GPSTime");
+                    valid = valid && d.find_uint("GPSTime", val);
                 } else {
-                    ir = d.find("time_utc_usec");
+                    valid = valid && d.find_uint("time_utc_usec", val);
                 }
-                valid = valid && (ir != d.end());
 
                 if (valid) {
-                    uint64_t gps_time_usec = ir->second; // microseconds UTC time
+                    uint64_t gps_time_usec = val; // microseconds UTC time
                     uint64_t reltime_us = 0;
                     if (_onboard_gps_time.have_last) {
                         // update rel. time based on the time lapsed since last GPS message
@@ -232,13 +224,12 @@ bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
             }
         }
 
-    } else if (msg.get_message_origname().compare("TIME")==0) {
+    } else if (origname.compare("TIME")==0) {
         // PX4: uint64_t hrt_absolute_time
-        const OnboardData::uintdata_t d = msg.get_uintdata();
-        OnboardData::uintdata_t::const_iterator ir = d.find("StartTime");
-        bool valid = ir != d.end();
+        uint64_t val;
+        bool valid = d.find_uint("StartTime", val);
         if (valid) {
-            uint64_t gps_time_usec = ir->second; // microseconds UTC time
+            uint64_t gps_time_usec = val; // microseconds UTC time
             uint64_t reltime_us = 0;
             if (_onboard_time_time.have_last) {
                 // update rel. time based on the time lapsed since last GPS message
@@ -255,21 +246,10 @@ bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
             _onboard_time_time.have_last = true;
         }      
     } else {
-        //cout << "generic onboard message: " <<  msg.get_message_origname() << endl;
-        const OnboardData::uintdata_t d = msg.get_uintdata();
-        OnboardData::uintdata_t::const_iterator ir;
-        ir = d.find("TimeUS"); if (ir != d.end()) goto stopsearch;
-        ir = d.find("t"); if (ir != d.end()) goto stopsearch;
-        ir = d.find("timestamp"); if (ir != d.end()) goto stopsearch;
-
-stopsearch:
-        if (ir != d.end()) {
-            uint64_t tnow = ir->second;
-            if (sys->is_absolute_time(tnow)) {
-                sys->update_time_offset(sys->get_rel_time(), tnow);
-            } else {
-                sys->update_rel_time(tnow, true);
-            }
+        //cout << "generic onboard message: " <<  origname << endl;
+        uint64_t val;
+        if (d.find_uint("TimeUS", val) || d.find_uint("t", val) || d.find_uint("timestamp", val)) {
+            _update_onboard_reltime(sys, val);
         } else {
             untimed_message = true;
         }
@@ -279,60 +259,273 @@ stopsearch:
          */
 
     }
+    return !untimed_message;
+}
+
+void MavlinkScenario::begin_onboard_log(const std::string &parsername) {
+    _last_onboard_parser = parsername;
+    _onboard_bindings.clear(); // a new log begins
+    _onboard_fields.clear(); // ...with other schemas
+}
+
+MavlinkScenario::onboard_fields_t & MavlinkScenario::_get_onboard_fields(MavSystem *sys, const OnboardSchema &schema) {
+    std::map<const OnboardSchema*, onboard_fields_t>::iterator it = _onboard_fields.find(&schema);
+    if (it == _onboard_fields.end()) {
+        onboard_fields_t f;
+        f.sys = NULL;
+        it = _onboard_fields.insert(std::make_pair(&schema, f)).first;
+    }
+    onboard_fields_t & fields = it->second;
+    if (fields.sys != sys || fields.series.size() != schema.size()) {
+        // first message of this type, or the schema has grown (PARM), or the system has changed
+        fields.sys = sys;
+        fields.series.assign(schema.size(), NULL);
+        fields.bound.assign(schema.size(), 0);
+    }
+    return fields;
+}
+
+void MavlinkScenario::_bind_onboard_field(const OnboardSchema &schema, unsigned int id, onboard_fields_t &fields) {
+    fields.bound[id] = 1;
+    const OnboardSchema::field_t & f = schema.get_field(id);
+    if (f.name == "t") return;
+
+    const std::string fullname = "onboard log/" + schema.get_message_name() + "/" + f.name;
+    MavSystem*const sys = fields.sys;
+    switch (f.type) {
+    case OnboardSchema::FIELD_BOOL:
+        fields.series[id] = sys->bind_generic_timeseries<bool>(fullname, f.units);
+        break;
+    case OnboardSchema::FIELD_INT:
+        fields.series[id] = sys->bind_generic_timeseries<int>(fullname, f.units);
+        break;
+    case OnboardSchema::FIELD_UINT:
+        fields.series[id] = sys->bind_generic_timeseries<unsigned int>(fullname, f.units);
+        break;
+    case OnboardSchema::FIELD_FLOAT:
+        fields.series[id] = sys->bind_generic_timeseries<float>(fullname, f.units);
+        break;
+    case OnboardSchema::FIELD_STRING:
+        fields.series[id] = sys->bind_generic_event<std::string>(fullname);
+        break;
+    }
+}
+
+// FIXME: refactor similar to add_mavlink_message (int return) and make polymorphic
+bool MavlinkScenario::add_onboard_message(const OnboardData &msg) {
+    if (!msg.is_valid()) return true;
+
+    // find MAV system ID and cache it
+    float sysid;
+    if (msg.get_message_origname().compare("PARM")==0 && msg.find_float("SYSID_THISMAV", sysid)) {
+        _onboard_sysid = ((int) sysid);
+        log(MSG_INFO, stringbuilder() << "Onboard Log: Sysid=" << _onboard_sysid);
+    }
+    /****************************
+     *  ADD/FIND SYSTEM
+     ****************************/
+    MavSystem* const sys = _get_onboard_system();
+    if (!sys) return false;
+
+    const bool untimed_message = !_update_onboard_time(sys, msg);
 
     /****************************
      *  RELATIVE TIMESTAMPS
      ****************************/    
 
-    // timeseries
-    const std::string stem = "onboard log/" + msg.get_message_name() + "/";
-    const std::size_t stem_len = stem.size();
-
     /*
-     * Full name will consist of two parts:
-     * - The stem as created above - which is the same through the rest of the function
-     * - The data name that will be appended and which might be differen for each data sample
-     *
-     * => For performance reasons the same string variable will be reused to avoid repeated memeory allocations
+     * The series of a message type are only looked up by their names the first time.
+     * Afterwards, the samples go straight into them.
      */
-    std::string fullname = stem;
-    for (OnboardData::booldata_t::const_iterator dit = msg.get_booldata().begin(); dit != msg.get_booldata().end(); ++dit) {
-        if (dit->first == "t") continue;
-        fullname.erase(stem_len); //trim down to stem
-        fullname.append(dit->first); //append name of data sample
-        DataTimed *series = sys->track_generic_timeseries<bool>(fullname, dit->second);
+    const OnboardSchema & schema = *msg.get_schema();
+    onboard_fields_t & fields = _get_onboard_fields(sys, schema);
+    const double t = sys->get_rel_time_sec();
+    const std::vector<unsigned int> & order = schema.get_order(); // by type, then by name
+    for (std::vector<unsigned int>::const_iterator it = order.begin(); it != order.end(); ++it) {
+        const unsigned int id = *it;
+        if (!msg.has(id)) continue;
+        if (!fields.bound[id]) _bind_onboard_field(schema, id, fields);
+        DataTimed*const series = fields.series[id];
+        if (!series) continue;
+
+        switch (schema.get_field(id).type) {
+        case OnboardSchema::FIELD_BOOL:
+            static_cast<DataTimeseries<bool>*>(series)->add_elem(msg.get_bool(id), t);
+            break;
+        case OnboardSchema::FIELD_INT:
+            static_cast<DataTimeseries<int>*>(series)->add_elem((int) msg.get_int(id), t);
+            break;
+        case OnboardSchema::FIELD_UINT:
+            static_cast<DataTimeseries<unsigned int>*>(series)->add_elem((unsigned int) msg.get_uint(id), t);
+            break;
+        case OnboardSchema::FIELD_FLOAT:
+            static_cast<DataTimeseries<float>*>(series)->add_elem(msg.get_float(id), t);
+            break;
+        case OnboardSchema::FIELD_STRING:
+            // events
+            static_cast<DataEvent<std::string>*>(series)->add_elem(msg.get_string(id), t);
+            continue;
+        }
         if (untimed_message) { series->set_has_bad_timestamps(); }
     }
-    for (OnboardData::intdata_t::const_iterator dit = msg.get_intdata().begin(); dit != msg.get_intdata().end(); ++dit) {
-        if (dit->first == "t") continue;
-        fullname.erase(stem_len); //trim down to stem
-        fullname.append(dit->first); //append name of data sample
-        DataTimed *series = sys->track_generic_timeseries<int>(fullname, dit->second);
-        if (untimed_message) { series->set_has_bad_timestamps(); }
+
+    return true;
+}
+
+static bool is_onboard_special(const std::string & origname) {
+    // these influence the time base or the system, see add_onboard_message()
+    return origname.compare("GPS")==0 || origname.compare("vehicle_gps_position")==0 ||
+           origname.compare("TIME")==0 || origname.compare("PARM")==0;
+}
+
+void MavlinkScenario::_bind_onboard_table(MavSystem *sys, const OnboardColumns::table_t &tab, onboard_binding_t &b) {
+    b.sys = sys;
+    b.series.assign(tab.columns.size(), NULL);
+
+    // same precedence as in _update_onboard_time()
+    b.time_col = -1;
+    const char*const timenames[] = {"TimeUS", "t", "timestamp"};
+    for (unsigned int j=0; j < sizeof(timenames)/sizeof(timenames[0]) && b.time_col < 0; ++j) {
+        for (unsigned int k=0; k < tab.columns.size(); ++k) {
+            if (tab.columns[k].type == OnboardColumns::COL_UINT && tab.columns[k].name == timenames[j]) {
+                b.time_col = k;
+                break;
+            }
+        }
     }
-    for (OnboardData::uintdata_t::const_iterator dit = msg.get_uintdata().begin(); dit != msg.get_uintdata().end(); ++dit) {
-        if (dit->first == "t") continue;
-        fullname.erase(stem_len); //trim down to stem
-        fullname.append(dit->first); //append name of data sample
-        DataTimed *series = sys->track_generic_timeseries<unsigned int>(fullname, dit->second);
-        if (untimed_message) { series->set_has_bad_timestamps(); }
+
+    // create the series in the same order as add_onboard_message() does: by type, then by name
+    std::map<std::string, unsigned int> ints, uints, floats;
+    for (unsigned int k=0; k < tab.columns.size(); ++k) {
+        const OnboardColumns::column_t & c = tab.columns[k];
+        if (c.name == "t") continue;
+        switch (c.type) {
+        case OnboardColumns::COL_INT:   ints[c.name] = k; break;
+        case OnboardColumns::COL_UINT:  uints[c.name] = k; break;
+        case OnboardColumns::COL_FLOAT: floats[c.name] = k; break;
+        }
     }
-    for (OnboardData::floatdata_t::const_iterator dit = msg.get_floatdata().begin(); dit != msg.get_floatdata().end(); ++dit) {
-        if (dit->first == "t") continue;
-        fullname.erase(stem_len); //trim down to stem
-        fullname.append(dit->first); //append name of data sample
-        DataTimed *series = sys->track_generic_timeseries<float>(fullname, dit->second);
-        if (untimed_message) { series->set_has_bad_timestamps(); }
+    const std::string stem = "onboard log/" + tab.msgname_readable + "/";
+    for (std::map<std::string, unsigned int>::const_iterator it = ints.begin(); it != ints.end(); ++it) {
+        b.series[it->second] = sys->bind_generic_timeseries<int>(stem + it->first, tab.columns[it->second].units);
+    }
+    for (std::map<std::string, unsigned int>::const_iterator it = uints.begin(); it != uints.end(); ++it) {
+        b.series[it->second] = sys->bind_generic_timeseries<unsigned int>(stem + it->first, tab.columns[it->second].units);
     }
-    // events
-    for (OnboardData::stringdata_t::const_iterator dit = msg.get_stringdata().begin(); dit != msg.get_stringdata().end(); ++dit) {
-        if (dit->first == "t") continue;
-        fullname.erase(stem_len); //trim down to stem
-        fullname.append(dit->first); //append name of data sample
-        sys->track_generic_event<std::string>(fullname, dit->second);        
+    for (std::map<std::string, unsigned int>::const_iterator it = floats.begin(); it != floats.end(); ++it) {
+        b.series[it->second] = sys->bind_generic_timeseries<float>(stem + it->first, tab.columns[it->second].units);
     }
+}
 
-    return true;
+void MavlinkScenario::_append_onboard_rows(const OnboardColumns::table_t &tab, onboard_binding_t &b) {
+    const unsigned int n = b.time.size();
+    if (0 == n) return;
+
+    const unsigned int r0 = b.first_row;
+    for (unsigned int k=0; k < tab.columns.size(); ++k) {
+        DataTimed*const series = b.series[k];
+        if (!series) continue;
+        const OnboardColumns::column_t & c = tab.columns[k];
+        switch (c.type) {
+        case OnboardColumns::COL_INT:
+        {
+            DataTimeseries<int>*const d = static_cast<DataTimeseries<int>*>(series);
+            for (unsigned int j=0; j < n; ++j) d->add_elem((int) c.intdata[r0 + j], b.time[j]);
+        }
+            break;
+        case OnboardColumns::COL_UINT:
+        {
+            DataTimeseries<unsigned int>*const d = static_cast<DataTimeseries<unsigned int>*>(series);
+            for (unsigned int j=0; j < n; ++j) d->add_elem((unsigned int) c.uintdata[r0 + j], b.time[j]);
+        }
+            break;
+        case OnboardColumns::COL_FLOAT:
+        {
+            DataTimeseries<float>*const d = static_cast<DataTimeseries<float>*>(series);
+            for (unsigned int j=0; j < n; ++j) d->add_elem(c.floatdata[r0 + j], b.time[j]);
+        }
+            break;
+        }
+        if (b.untimed) { series->set_has_bad_timestamps(); }
+    }
+    b.first_row += n;
+    b.time.clear();
+    b.untimed = false;
+}
+
+bool MavlinkScenario::add_onboard_columns(const OnboardColumns &cols) {
+    if (_onboard_bindings.size() < cols.tables.size()) {
+        onboard_binding_t b;
+        b.sys = NULL;
+        b.special = false;
+        b.time_col = -1;
+        b.untimed = false;
+        b.first_row = 0;
+        _onboard_bindings.resize(cols.tables.size(), b);
+    }
+    for (std::vector<onboard_binding_t>::iterator it = _onboard_bindings.begin(); it != _onboard_bindings.end(); ++it) {
+        it->first_row = 0; // each batch starts over
+    }
+
+    /*
+     * Times are determined message by message exactly like in add_onboard_message(), but the
+     * samples are only collected per table and appended to the series at the end. Nothing in
+     * between looks at the series, so the result is the same.
+     */
+    bool ret = true;
+    unsigned int next_other = 0;
+    for (std::vector<uint16_t>::const_iterator it = cols.order.begin(); it != cols.order.end(); ++it) {
+        if (OnboardColumns::OTHER == *it) {
+            if (next_other < cols.others.size()) {
+                const OnboardData & msg = cols.others[next_other++];
+                // it may go into the same series as a table (e.g., short lines); keep their order
+                for (unsigned int k=0; k < cols.tables.size(); ++k) {
+                    if (cols.tables[k].msgname_orig == msg.get_message_origname()) {
+                        _append_onboard_rows(cols.tables[k], _onboard_bindings[k]);
+                    }
+                }
+                ret = add_onboard_message(msg) && ret;
+            }
+            continue;
+        }
+
+        const OnboardColumns::table_t & tab = cols.tables[*it];
+        onboard_binding_t & b = _onboard_bindings[*it];
+        const unsigned int row = b.first_row + b.time.size();
+        if (!b.sys && !b.special) {
+            b.special = is_onboard_special(tab.msgname_orig);
+        }
+        if (b.special) {
+            // rare; rows before this one were already timed, so they can wait
+            cols.get_row(*it, row, _onboard_row);
+            b.first_row++;
+            ret = add_onboard_message(_onboard_row) && ret;
+            continue;
+        }
+
+        MavSystem* const sys = _get_onboard_system();
+        if (!sys) {
+            ret = false;
+            _append_onboard_rows(tab, b);
+            b.first_row++;
+            continue;
+        }
+        if (b.sys != sys) {
+            if (b.sys) _append_onboard_rows(tab, b);
+            _bind_onboard_table(sys, tab, b);
+        }
+        if (b.time_col >= 0) {
+            _update_onboard_reltime(sys, tab.columns[b.time_col].uintdata[row]);
+        } else {
+            b.untimed = true;
+        }
+        b.time.push_back(sys->get_rel_time_sec());
+    }
+
+    for (unsigned int k=0; k < cols.tables.size(); ++k) {
+        _append_onboard_rows(cols.tables[k], _onboard_bindings[k]);
+    }
+    return ret;
 }
 
 int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allow_time_jumps) {
@@ -352,7 +545,9 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
 
     // FIXME: messages have no timestamps in their header...we need to be creative here
     uint64_t nowtime_us = sys->get_rel_time() + 1; // to preserve order when no time is given  FIXME: estimate from link rate?
-    sys->update_rel_time(nowtime_us, allow_time_jumps); // if someone knows better below, it can update just again
+    if (!sys->is_time_unsynced()) {
+        sys->update_rel_time(nowtime_us, allow_time_jumps); // if someone knows better below, it can update just again
+    }
 
     // that is a boundary that helps analyzing
     sys->nextmsg();
@@ -399,7 +594,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
     {
         uint64_t time_unix_usec = mavlink_msg_system_time_get_time_unix_usec(&msg);
         uint32_t time_boot_ms = mavlink_msg_system_time_get_time_boot_ms(&msg);
-        nowtime_us = time_boot_ms * 1000;        
+        nowtime_us = ((uint64_t)time_boot_ms) * 1000; // 32bit would wrap after 71 minutes
         sys->update_time_offset(nowtime_us, time_unix_usec, allow_time_jumps); // OK -- here we establish a reference between boot time and /absolute time
     }
         break;
@@ -557,7 +752,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
         uint32_t time_boot_ms = mavlink_msg_scaled_pressure_get_time_boot_ms(&msg); // OK
         int16_t temp = mavlink_msg_scaled_pressure_get_temperature(&msg);
         float press = mavlink_msg_scaled_pressure_get_press_abs(&msg);
-        nowtime_us = time_boot_ms * 1000;
+        nowtime_us = ((uint64_t)time_boot_ms) * 1000;
         int upd = sys->update_rel_time(nowtime_us, allow_time_jumps); // sometimes goes backwards
         // --
         if (0 == upd) {
@@ -580,7 +775,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
         speed_rpy_radsec[1] = mavlink_msg_attitude_get_pitchspeed(&msg);
         speed_rpy_radsec[2] = mavlink_msg_attitude_get_yawspeed(&msg);
         // update time
-        nowtime_us = time_boot_ms * 1000;
+        nowtime_us = ((uint64_t)time_boot_ms) * 1000;
         int upd = sys->update_rel_time(nowtime_us, allow_time_jumps); // BUG: goes backwards *every* time
         // --
         if (0 == upd) {
@@ -601,7 +796,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
         float vy = mavlink_msg_local_position_ned_get_vy(&msg);
         float vz = mavlink_msg_local_position_ned_get_vz(&msg);
         // update time
-        nowtime_us = time_boot_ms * 1000;
+        nowtime_us = ((uint64_t)time_boot_ms) * 1000;
         int upd = sys->update_rel_time(nowtime_us, allow_time_jumps);
         if (0==upd) {
             const string fullname = "airstate/local pos ned/";
@@ -631,7 +826,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
         v_ms[2] = mavlink_msg_global_position_int_get_vz(&msg)/100.f;
         float heading_deg = mavlink_msg_global_position_int_get_hdg(&msg)/100.f;
         // update time
-        nowtime_us = time_boot_ms * 1000;
+        nowtime_us = ((uint64_t)time_boot_ms) * 1000;
         int upd = sys->update_rel_time(nowtime_us, allow_time_jumps);
         // --
         if (0==upd) {
@@ -660,7 +855,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
         */
         uint8_t rssi = mavlink_msg_rc_channels_scaled_get_rssi(&msg);
         // update time
-        nowtime_us = time_boot_ms * 1000;
+        nowtime_us = ((uint64_t)time_boot_ms) * 1000;
 
         int upd = sys->update_rel_time(nowtime_us, allow_time_jumps); // BUG: goes backwards
         // --
@@ -685,7 +880,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
         chan_raw[6] = mavlink_msg_rc_channels_raw_get_chan7_raw(&msg);
         chan_raw[7] = mavlink_msg_rc_channels_raw_get_chan8_raw(&msg);
         // update time
-        nowtime_us = time_boot_ms * 1000;
+        nowtime_us = ((uint64_t)time_boot_ms) * 1000;
         int upd = sys->update_rel_time(nowtime_us, allow_time_jumps);
         // --
         if (0 == upd) {
@@ -858,7 +1053,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
     {
         const string fullname = "mission/attitude target/";
         uint32_t time_boot_ms = mavlink_msg_attitude_target_get_time_boot_ms(&msg);        
-        int upd = sys->update_rel_time(time_boot_ms*1000, allow_time_jumps);
+        int upd = sys->update_rel_time(((uint64_t)time_boot_ms) * 1000, allow_time_jumps);
         if (0 == upd) {
             uint8_t type_mask = mavlink_msg_attitude_target_get_type_mask(&msg);
             float q[4];
@@ -887,7 +1082,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
         const string fullname = "mission/pos target global int/";
         uint32_t time_boot_ms = mavlink_msg_position_target_global_int_get_time_boot_ms(&msg);
 
-        int upd = sys->update_rel_time(time_boot_ms * 1000, allow_time_jumps);
+        int upd = sys->update_rel_time(((uint64_t)time_boot_ms) * 1000, allow_time_jumps);
         if (0 == upd) {
 
             uint8_t frame = mavlink_msg_position_target_global_int_get_coordinate_frame(&msg);
@@ -1091,8 +1286,8 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
         break;
 
     default:
-        // unknown        
-        ignored = true;
+        // no dedicated handling: store the fields as they are, if the message is known at all
+        ignored = !_decoders.decode(sys, msg);
         break;
     }
 
@@ -1107,7 +1302,7 @@ int MavlinkScenario::add_mavlink_message(const mavlink_message_t &msg, bool allo
         _n_ignored++; // scenario-wide
         ret = 0; // because return value is only to indicate time jumps.
     }
-    sys->track_mavlink(msg.len + MAVLINK_NUM_NON_PAYLOAD_BYTES, msg.msgid, whatwasdone);
+    sys->track_mavlink(msg.len + MAVLINK_NUM_NON_PAYLOAD_BYTES, msg.msgid, whatwasdone, msg.compid, msg.seq);
 
     return ret;
 }
@@ -1149,6 +1344,10 @@ void MavlinkScenario::dump_overview(ostream& ofs) const {
         ss << tmp << endl;
     }
 
+    for (systemlist::const_iterator it = _seen_systems.begin(); it != _seen_systems.end(); ++it) {
+        it->second->describe_link(ss);
+    }
+
     ofs << ss.str();
     ofs << "Processed " << _n_msgs << " messages." << endl;
 }
@@ -1161,21 +1360,74 @@ const MavSystem *MavlinkScenario::get_system_byid(uint8_t id) const {
 }
 
 bool MavlinkScenario::merge_in(const MavlinkScenario & other) {
+    return merge_in_all(std::vector<const MavlinkScenario*>(1, &other));
+}
+
+bool MavlinkScenario::merge_in_all(const std::vector<const MavlinkScenario*> & others) {
+    // the systems of all others by id, in the order of others
+    std::map<uint8_t, std::vector<const MavSystem*> > byid;
+    for (std::vector<const MavlinkScenario*>::const_iterator it = others.begin(); it != others.end(); ++it) {
+        for (systemlist::const_iterator ito = (*it)->_seen_systems.begin(); ito != (*it)->_seen_systems.end(); ++ito) {
+            byid[ito->first].push_back(ito->second);
+        }
+    }
+
     // for each system in there: see if we have it. If so, merge its data in. Else, copy it.
     bool success = true;
-    for (systemlist::const_iterator ito = other._seen_systems.begin(); ito != other._seen_systems.end(); ++ito) {
-        systemlist::iterator mine = _seen_systems.find(ito->first);
+    for (std::map<uint8_t, std::vector<const MavSystem*> >::const_iterator it = byid.begin(); it != byid.end(); ++it) {
+        std::vector<const MavSystem*>::const_iterator first = it->second.begin();
+        systemlist::iterator mine = _seen_systems.find(it->first);
         if (mine == _seen_systems.end()) {
-            // do not have it, take a copy
-            _seen_systems.insert(_seen_systems.begin(), std::pair<uint8_t,MavSystem*>(ito->first,new MavSystem(ito->second))); ///< copy CTOR
-        } else {
-            // do have it, merge!
-            if (!mine->second->merge_in(ito->second)) {
-                log(MSG_ERR, stringbuilder() << "ERROR merging two MavSystems");
-                success = false;
+            // do not have it, take a copy of the first
+            mine = _seen_systems.insert(std::pair<uint8_t,MavSystem*>(it->first, new MavSystem(*first))).first; ///< copy CTOR
+            if (++first == it->second.end()) continue;
+        }
+        // do have it, merge!
+        if (!mine->second->merge_in_all(std::vector<const MavSystem*>(first, it->second.end()))) {
+            log(MSG_ERR, stringbuilder() << "ERROR merging two MavSystems");
+            success = false;
+        }
+    }
+    _decoders.clear(); // merging may have replaced series
+    return success;
+}
+
+bool MavlinkScenario::take_in_all(const std::vector<MavlinkScenario*> & others) {
+    // the systems of all others by id, in the order of others
+    std::map<uint8_t, std::vector<MavSystem*> > byid;
+    for (std::vector<MavlinkScenario*>::const_iterator it = others.begin(); it != others.end(); ++it) {
+        for (systemlist::const_iterator ito = (*it)->_seen_systems.begin(); ito != (*it)->_seen_systems.end(); ++ito) {
+            byid[ito->first].push_back(ito->second);
+        }
+    }
+
+    // for each system in there: see if we have it. If not, take the first as it is. Then merge the rest in.
+    bool success = true;
+    for (std::map<uint8_t, std::vector<MavSystem*> >::const_iterator it = byid.begin(); it != byid.end(); ++it) {
+        std::vector<MavSystem*>::const_iterator first = it->second.begin();
+        systemlist::iterator mine = _seen_systems.find(it->first);
+        if (mine == _seen_systems.end()) {
+            // do not have it, the first one becomes ours
+            for (std::vector<MavlinkScenario*>::const_iterator ito = others.begin(); ito != others.end(); ++ito) {
+                systemlist::iterator itsys = (*ito)->_seen_systems.find(it->first);
+                if (itsys != (*ito)->_seen_systems.end() && itsys->second == *first) {
+                    (*ito)->_seen_systems.erase(itsys);
+                    break;
+                }
             }
+            mine = _seen_systems.insert(std::pair<uint8_t,MavSystem*>(it->first, *first)).first;
+            if (++first == it->second.end()) continue;
+        }
+        // do have it, merge!
+        if (!mine->second->take_in_all(std::vector<MavSystem*>(first, it->second.end()))) {
+            log(MSG_ERR, stringbuilder() << "ERROR merging two MavSystems");
+            success = false;
         }
     }
+    _decoders.clear(); // merging may have replaced series, and those of others are ours now
+    for (std::vector<MavlinkScenario*>::const_iterator it = others.begin(); it != others.end(); ++it) {
+        (*it)->_decoders.clear();
+    }
     return success;
 }
 
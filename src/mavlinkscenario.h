@@ -32,8 +32,10 @@
 #include <ostream>
 #include "mavlink.h"
 #include "mavsystem.h"
+#include "mavlinkdecoders.h"
 #include "cmdlineargs.h"
 #include "onboarddata.h"
+#include "onboardcolumns.h"
 #include "logger.h"
 
 class MavlinkScenario
@@ -50,6 +52,13 @@ public:
      */
     int add_mavlink_message(const mavlink_message_t &msg, bool allowJumps=false);
 
+    /**
+     * @brief call before the messages of a new onboard log, since the parser tells how to
+     *        interpret them
+     * @param parsername see OnboardLogParser::get_parser_name()
+     */
+    void begin_onboard_log(const std::string & parsername);
+
     /**
      * @brief Feed onboard messages into here. analyzes the handed-over message and stores
      *        the data internally.
@@ -60,6 +69,14 @@ public:
      */
     bool add_onboard_message(const OnboardData &msg);
 
+    /**
+     * @brief same as calling add_onboard_message() for each message in the batch, in order,
+     *        but the series of a message type are only looked up once.
+     * @param cols the next batch of messages of the same log, see OnboardLogParser::get_columns()
+     * @return true if all messages were handeled, else false
+     */
+    bool add_onboard_columns(const OnboardColumns &cols);
+
     /**
      * XXX! do not use add_mavlink_message and add_mavlink_message in the same scenario. Rather use
      * two distinct scenarios and merge them using merge_in().
@@ -92,6 +109,22 @@ public:
      */
     bool merge_in(const MavlinkScenario &other);
 
+    /**
+     * @brief same as merge_in() with each of others in turn, e.g., one scenario per logfile.
+     *        Every series is merged in one pass over all of them, instead of once per scenario.
+     * @return true on success, else false (in this case, this instance's data might be inconsistent)
+     */
+    bool merge_in_all(const std::vector<const MavlinkScenario*> & others);
+
+    /**
+     * @brief same as merge_in_all(), but moves the systems and their data here instead of
+     *        copying them. Use this if others are deleted afterwards anyway, e.g., freshly
+     *        loaded logfiles. Overlapping series are still merged in time order.
+     * @param others left without (some of) their data; they must be deleted after this.
+     * @return true on success, else false (in this case, this instance's data might be inconsistent)
+     */
+    bool take_in_all(const std::vector<MavlinkScenario*> & others);
+
     /**
      * @brief shift all data in scenario by specifed amount of seconds. negative will make the data earlier.
      * @param delay
@@ -140,6 +173,44 @@ private:
 
     MavSystem* _get_or_add_system_byid(uint8_t id);
 
+    // #### helpers for onboardparser
+    MavSystem* _get_onboard_system(void);
+    void _update_onboard_reltime(MavSystem*sys, uint64_t tnow);
+
+    /**
+     * @brief advance the time of the system with an onboard message
+     * @return false if the message carries no time at all
+     */
+    bool _update_onboard_time(MavSystem*sys, const OnboardData & d);
+
+    /**
+     * @brief series of one table of OnboardColumns, and the times of the rows not yet added
+     */
+    typedef struct {
+        MavSystem*          sys;       ///< series belong to this system, NULL if not yet looked up
+        bool                special;   ///< rows set the time base or the system; they go through add_onboard_message()
+        int                 time_col;  ///< column with the timestamp, -1 if none
+        bool                untimed;   ///< some pending row had no time
+        unsigned int        first_row; ///< first row not yet added
+        std::vector<DataTimed*> series; ///< per column, NULL if skipped
+        std::vector<double> time;      ///< rel. time of the pending rows
+    } onboard_binding_t;
+
+    /**
+     * @brief series of the fields of one OnboardSchema. A field is bound when it is seen
+     *        first, so that the series are created in the same order as before.
+     */
+    typedef struct {
+        MavSystem*              sys;    ///< series belong to this system
+        std::vector<DataTimed*> series; ///< per field id, NULL if not bound (yet) or skipped
+        std::vector<uint8_t>    bound;  ///< per field id, whether it was looked up already
+    } onboard_fields_t;
+
+    onboard_fields_t & _get_onboard_fields(MavSystem*sys, const OnboardSchema & schema);
+    void _bind_onboard_field(const OnboardSchema & schema, unsigned int id, onboard_fields_t & fields);
+    void _bind_onboard_table(MavSystem*sys, const OnboardColumns::table_t & tab, onboard_binding_t & b);
+    void _append_onboard_rows(const OnboardColumns::table_t & tab, onboard_binding_t & b);
+
     /********************************************
      *  DATA MEMBERS
      ********************************************/
@@ -147,6 +218,7 @@ private:
 
     unsigned int _n_msgs; ///< how many messages we processed in this scenarios; this is for ALL systems. Per-system stats are within MavSystem
     unsigned int _n_ignored; ///< how many messages we did not process (no decoding was programmed)
+    MavlinkDecoders _decoders; ///< for all messages without dedicated handling below
 
     // scenario data
     typedef std::map <uint8_t, MavSystem*> systemlist;
@@ -156,6 +228,9 @@ private:
     friend class SystemTableViewModel; // FIXME: this avoids that we can compile w/o GUI
     friend class DataTreeViewModel; // FIXME: this avoids that we can compile w/o GUI
 	friend class DBConnector;
+    friend class MavlinkChunkedParser;
+
+    bool _start_unsynced; ///< if true, new systems do not know the time yet, because we start in the middle of a log
 
     // #### temps for onboardparser
     int _onboard_sysid;
@@ -179,6 +254,9 @@ private:
     std::string _name; ///< descriptive name of the scenario
     std::string _desc; ///< comments on the scenario
     std::string _last_onboard_parser;
+    std::vector<onboard_binding_t> _onboard_bindings; ///< per table of the OnboardColumns of the current log
+    std::map<const OnboardSchema*, onboard_fields_t> _onboard_fields; ///< per message type of the current log
+    OnboardData _onboard_row; ///< scratch for special rows
 
     // database
     bool _havedb;
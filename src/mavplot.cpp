@@ -41,6 +41,8 @@
 #include "data_timeseries.h"
 #include "data_event.h"
 #include "dialogdatadetails.h"
+#include "mavplotcurve.h"
+#include "mavplotevents.h"
 
 using namespace std;
 
@@ -171,7 +173,8 @@ void MavPlot::_updateDataBounds () {
         // FIXME: now we can only do curves
         const QwtPlotCurve * const q = dynamic_cast<const QwtPlotCurve * const>(that);
         if (q) {
-            QRectF rect = q->boundingRect();
+            // scaled like the curve; for timeseries from the summary of the data
+            const QRectF rect = q->boundingRect();
             if (first) {
                 first=false;
                 allrect = rect;
@@ -355,15 +358,6 @@ MavPlot::~MavPlot() {
     // TODO: a lot of cleanup!!!
 }
 
-/**
- * @brief function turning any data into double...it may fail.
- */
-template <typename CT>
-bool MavPlot::_convert2double(CT in, double &ret, double scale) {
-    ret = ((double) in)*scale;
-    return true;
-}
-
 QColor MavPlot::_suggestColor(unsigned int plotnumber) {
     const QList<QColor> cols = QList<QColor>() << QColor(Qt::lightGray) << QColor(Qt::red) << QColor(Qt::green) << QColor(Qt::cyan) << QColor(Qt::yellow) << QColor(Qt::magenta);
 
@@ -378,51 +372,27 @@ QColor MavPlot::_suggestColor(unsigned int plotnumber) {
  */
 template <typename ET>
 std::vector<QwtPlotItem*>* MavPlot::_add_data_event(const DataEvent<ET> * data, unsigned int plotnumber /* used for colors etc */) {
-
-    vector <QwtPlotItem*> * markers = new vector <QwtPlotItem*>;
-    if (!markers) {
-        qDebug() << "Error allocating memory for an event series";
-        return NULL;
-    }
-    const vector<double> vt = data->get_time();
-    const vector<ET>     vd = data->get_data();
+    if (!data) return NULL;
+    const vector<double> & vt = data->get_time();
+    const vector<ET>     & vd = data->get_data();
 
     // relative time -> absolute time
     double t_datastart = data->get_epoch_datastart()/1E6;
 
-    for (unsigned int k=0; k<data->size(); k++) {
-        QwtPlotMarker * d_marker = new QwtPlotMarker();
-        if (!d_marker) {
-            qDebug() << "Error allocating memory for a marker";
-            continue;
-        }
-        d_marker->setLineStyle(QwtPlotMarker::VLine);
-        d_marker->setLabelAlignment(Qt::AlignRight | Qt::AlignBottom);
-        d_marker->setLinePen(QPen(_suggestColor(plotnumber), 0, Qt::DashDotLine));
-        //d_marker->setSymbol( new QwtSymbol(QwtSymbol::Diamond, QColor(Qt::yellow), QColor(Qt::green), QSize(7,7)));
-        d_marker->setValue(vt[k] + t_datastart, 0.0);
-        d_marker->setLabelOrientation(Qt::Vertical);
+    // one item for all events, which only draws the visible ones
+    EventPlotItem * events = new EventPlotItem(QString::fromStdString(data->get_name()));
+    events->setPen(QPen(_suggestColor(plotnumber), 0, Qt::DashDotLine));
+    events->reserve(vt.size());
+    stringstream ss;
+    for (unsigned int k=0; k<vt.size() && k<vd.size(); k++) {
         // try to set label from data
-        stringstream ss;
+        ss.str("");
         ss << vd[k];
-        QString label(ss.str().c_str()); // that relies on QString to be cool and do some clever conversion
-        d_marker->setLabel(QwtText(label));
-        // --
-        QwtPlotItem*item = dynamic_cast<QwtPlotItem*>(d_marker);
-        if (!item) {
-            delete d_marker;
-            return NULL;
-        }
-        markers->push_back(item);
-        d_marker->attach(this);
-        // add legend entry for first
-        if (markers->size()==1) {
-            d_marker->setTitle(QString::fromStdString(data->get_name()));
-            d_marker->setItemAttribute(QwtPlotItem::Legend);
-        }
-    }       
+        events->append(vt[k] + t_datastart, QString(ss.str().c_str())); // that relies on QString to be cool and do some clever conversion
+    }
+    events->attach(this);
 
-    return markers;
+    return new vector <QwtPlotItem*>(1, events);
 }
 
 /**
@@ -436,19 +406,17 @@ QWT_ABSTRACT_SERIESITEM * MavPlot::_add_data_timeseries(const DataTimeseries<ST>
     /*
      * so we have a timeseries of type ST. We need to "translate" it for the plot, and then add it.
      * One problem is, that Qwt cannot plot double against float...so we need to "convert" every-
-     * thing to double here.
+     * thing to double. TimeseriesLodData does that while drawing, without a copy of the data, and
+     * only for the samples which are visible, per pixel the first, last, min and max.
      */
-    QVector<double> xdata, ydata;
-    if (!data2xyvect(data, xdata, ydata)) {
-        return NULL;
-    }
+    if (!data) return NULL;
 
-    QwtPlotCurve *curve = new QwtPlotCurve(QString().fromStdString(data->get_name()));
+    QwtPlotCurve *curve = new LodPlotCurve(QString().fromStdString(data->get_name()));
     curve->setRenderHint(QwtPlotItem::RenderAntialiased);
     curve->setPen(QPen(_suggestColor(plotnumber))); // FIXME: offer choices
 
     curve->setLegendAttribute(QwtPlotCurve::LegendShowLine);    
-    curve->setSamples(xdata, ydata); // makes a deep copy
+    curve->setData(new TimeseriesLodData<ST>(data)); // curve takes ownership
     curve->attach(this);
 
     return dynamic_cast<QWT_ABSTRACT_SERIESITEM *>(curve);
@@ -490,46 +458,6 @@ QWT_ABSTRACT_SERIESITEM * MavPlot::_branch_datatype_series(const Data* data, uns
     return NULL; // unrecognized data type
 }
 
-// TODO: ugly stuff, same as _branch_datatype_series()
-bool MavPlot::data2xyvect(const Data * data, QVector<double> & xdata, QVector<double> & ydata, double scale) {
-    const DataTimeseries<float> *const tsf = dynamic_cast<DataTimeseries<float> const*>(data);
-    if (tsf) return data2xyvect(tsf, xdata, ydata, scale);
-
-    const DataTimeseries<double> * tsd = dynamic_cast<DataTimeseries<double> const*>(data);
-    if (tsd) return data2xyvect(tsd, xdata, ydata, scale);
-
-    const DataTimeseries<unsigned int> * tsu = dynamic_cast<DataTimeseries<unsigned int> const*>(data);
-    if (tsu) return data2xyvect(tsu, xdata, ydata, scale);
-
-    const DataTimeseries<int> * tsi = dynamic_cast<DataTimeseries<int> const*>(data);
-    if (tsi) return data2xyvect(tsi, xdata, ydata, scale);
-
-    return false;
-}
-
-template <typename ST>
-bool MavPlot::data2xyvect(const DataTimeseries<ST> * data, QVector<double> & xdata, QVector<double> & ydata, double scale) {
-    if (!data) return false;
-
-    xdata = QVector<double>::fromStdVector(data->get_time());
-    double t_datastart = data->get_epoch_datastart()/1E6;
-    for (QVector<double>::iterator it = xdata.begin(); it != xdata.end(); ++it ) {
-        // relative time -> absolute time
-        *it += t_datastart;
-    }
-
-    // data to double
-    for (typename vector<ST>::const_iterator it = data->get_data().begin(); it != data->get_data().end(); ++it) {
-        double ret;
-        if (!_convert2double(*it, ret, scale)) {
-            qDebug() << "ERROR: cannot convert given data type to double";
-            return false;
-        }
-        ydata.push_back(ret);
-    }
-    return true;
-}
-
 bool MavPlot::addData(const Data* data) {
     // first check whether we already have it...
     dataplotmap::iterator it = _series.find(data);
@@ -572,73 +500,7 @@ void MavPlot::unset_markerData() {
 }
 
 void MavPlot::rev_markerData(const Data *const d) {
-    if (!d || !_data_marker_visible) return;
-    const double markerx = _data_marker.xValue();
-    double markerx_next = markerx;
-#if 0
-    /*******************
-     * SCAN IN Data
-     *******************/
-#else
-    /*******************
-     * SCAN IN Plot
-     *******************/
-    // FIXME: heavy code clone from fwd_markerData()
-    QPointF xy;
-    QString value;
-    bool found = false;
-    // find out what it is, then scan for data
-    const QWT_ABSTRACT_SERIESITEM*s = _get_series(d);
-    if (s) {
-        // it's a series
-        const QwtPlotCurve *curve = dynamic_cast<const QwtPlotCurve *>(s);
-        if (curve) {
-            for (unsigned int k=0; k<curve->dataSize(); k++) {
-                xy = curve->sample(k);
-                double x = xy.x();
-                if (x < markerx) {
-                    found = true;
-                    markerx_next = x;
-                    value = QString::number(xy.y());
-                } else if (x > markerx) {
-                    break;
-                }
-            }
-
-        }
-    }
-    // annotation
-    std::vector<QwtPlotItem*>*v = _get_annotations(d);
-    if (v && !found) {
-        // it's an annotation...we have to go through all of them
-        for (std::vector<QwtPlotItem*>::const_iterator it = v->begin(); it != v->end(); ++it) {
-            // only support marker annotations
-            const QwtPlotMarker * m = dynamic_cast<const QwtPlotMarker*>(*it);
-            if (m) {
-                // we only handle vertical markers
-                if (QwtPlotMarker::VLine == m->lineStyle()) {
-                    xy = m->value();
-                    double x = xy.x();
-                    if (x < markerx) {
-                        found = true;
-                        markerx_next = x;
-                        value = m->label().text();
-                    } else if (x > markerx) {
-                        break;
-                    }
-                }
-            }
-        }
-    }
-#endif
-
-    // set marker to found location
-    if (found) {
-        _data_marker_label = value;
-        _data_marker.setValue(markerx_next, 0);
-        replot();
-    }
-    updateStatusbar();
+    _step_markerData(d, false);
 }
 
 QWT_ABSTRACT_SERIESITEM *MavPlot::_get_series(const Data * const d) {
@@ -653,6 +515,18 @@ QWT_ABSTRACT_SERIESITEM *MavPlot::_get_series(const Data * const d) {
     return ret;
 }
 
+const LodSeriesData *MavPlot::_get_samples(const Data * const d) {
+    const QwtPlotCurve *curve = dynamic_cast<const QwtPlotCurve *>(_get_series(d));
+    if (!curve) return NULL;
+    return dynamic_cast<const LodSeriesData *>(curve->data());
+}
+
+const EventPlotItem *MavPlot::_get_events(const Data * const d) {
+    std::vector<QwtPlotItem*>*v = _get_annotations(d);
+    if (!v || v->empty()) return NULL;
+    return dynamic_cast<const EventPlotItem*>(v->front());
+}
+
 std::vector<QwtPlotItem*>* MavPlot::_get_annotations(const Data * const d) {
     std::vector<QwtPlotItem*>* ret = NULL;
     if (d) {
@@ -666,93 +540,37 @@ std::vector<QwtPlotItem*>* MavPlot::_get_annotations(const Data * const d) {
 }
 
 void MavPlot::setmin_markerData(const Data *const d) {
-    if (!d || !_data_marker_visible) return;
-    const double markerx = _data_marker.xValue();
-    double markerx_next = markerx;
-#if 0
-    /*******************
-     * SCAN IN Data
-     *******************/
-#else
-    /*******************
-     * SCAN IN Plot
-     *******************/
-    // FIXME: code clone from rev_markerData()
-    QPointF xy;
-    QString value;
-    bool found = false;
-    // find out what it is, then scan for data
-    const QWT_ABSTRACT_SERIESITEM*s = _get_series(d);
-    if (s) {
-        // it's a series
-        const QwtPlotCurve *curve = dynamic_cast<const QwtPlotCurve *>(s);
-        if (curve) {
-            double minval = 0;
-            for (unsigned int k=0; k<curve->dataSize(); k++) {
-                QPointF xy = curve->sample(k);
-                if (k == 0 || (xy.y() < minval)) {
-                    minval = xy.y();
-                    markerx_next = xy.x();
-                    found = true;
-                }
-            }
-            value = QString::number(minval);
-        }
-    }
-#endif
-
-    // set marker to found location
-    if (found) {
-        _data_marker_label = value;
-        _data_marker.setValue(markerx_next, 0);
-        replot();
-    } else {
-        _data_marker_label = "";
-    }
-    updateStatusbar();
+    _extremum_markerData(d, false);
 }
 
 void MavPlot::setmax_markerData(const Data *const d) {
+    _extremum_markerData(d, true);
+}
+
+void MavPlot::_extremum_markerData(const Data *const d, bool max) {
     if (!d || !_data_marker_visible) return;
-    const double markerx = _data_marker.xValue();
-    double markerx_next = markerx;
-#if 0
-    /*******************
-     * SCAN IN Data
-     *******************/
-#else
-    /*******************
-     * SCAN IN Plot
-     *******************/
-    // FIXME: code clone from rev_markerData()
-    QPointF xy;
     QString value;
     bool found = false;
-    // find out what it is, then scan for data
-    const QWT_ABSTRACT_SERIESITEM*s = _get_series(d);
-    if (s) {
-        // it's a series
-        const QwtPlotCurve *curve = dynamic_cast<const QwtPlotCurve *>(s);
-        if (curve) {
-            double maxval = 0;
-            for (unsigned int k=0; k<curve->dataSize(); k++) {
-                QPointF xy = curve->sample(k);
-                if (k == 0 || (xy.y() > maxval)) {
-                    maxval = xy.y();
-                    markerx_next = xy.x();
-                    found = true;
-                }
-            }
-            value = QString::number(maxval);
+    double markerx_next = 0.;
+    size_t k;
+
+    // only series have values; look within the visible time, from the summary of the data
+    const LodSeriesData *samples = _get_samples(d);
+    if (samples) {
+        const QwtScaleMap xMap = canvasMap(QwtPlot::xBottom);
+        found = samples->find_extremum(qMin(xMap.s1(), xMap.s2()), qMax(xMap.s1(), xMap.s2()), max, k);
+        if (found) {
+            const QPointF xy = samples->full_sample(k);
+            markerx_next = xy.x();
+            value = QString::number(xy.y());
         }
     }
-#endif
 
     // set marker to found location
     if (found) {
         _data_marker_label = value;
         _data_marker.setValue(markerx_next, 0);
-        replot();        
+        replot();
     } else {
         _data_marker_label = "";
     }
@@ -760,69 +578,40 @@ void MavPlot::setmax_markerData(const Data *const d) {
 }
 
 void MavPlot::fwd_markerData(const Data *const d) {
+    _step_markerData(d, true);
+}
+
+void MavPlot::_step_markerData(const Data *const d, bool forward) {
     if (!d || !_data_marker_visible) return;
     const double markerx = _data_marker.xValue();
     double markerx_next = markerx;
-#if 0
-    /*******************
-     * SCAN IN Data
-     *******************/
-#else
-    /*******************
-     * SCAN IN Plot
-     *******************/
-    // FIXME: heavy code clone from rev_markerData()
-    QPointF xy;
     QString value;
     bool found = false;
-    // find out what it is, then scan for data
-    const QWT_ABSTRACT_SERIESITEM*s = _get_series(d);
-    if (s) {
-        // it's a series
-        const QwtPlotCurve *curve = dynamic_cast<const QwtPlotCurve *>(s);
-        if (curve) {
-            for (unsigned int k=0; k<curve->dataSize(); k++) {
-                xy = curve->sample(k);
-                double x = xy.x();
-                if (x > markerx) {
-                    found = true;
-                    markerx_next = x;
-                    value = QString::number(xy.y());
-                    break;
-                }
-            }
-
+    size_t k;
+
+    // binary search in the data behind the series, or in the events
+    const LodSeriesData *samples = _get_samples(d);
+    const EventPlotItem *events = _get_events(d);
+    if (samples) {
+        found = forward ? samples->find_next(markerx, k) : samples->find_prev(markerx, k);
+        if (found) {
+            const QPointF xy = samples->full_sample(k);
+            markerx_next = xy.x();
+            value = QString::number(xy.y());
         }
-    }
-    // annotation
-    std::vector<QwtPlotItem*>*v = _get_annotations(d);
-    if (v && !found) {
-        // it's an annotation...we have to go through all of them
-        for (std::vector<QwtPlotItem*>::const_iterator it = v->begin(); it != v->end(); ++it) {
-            // only support marker annotations
-            const QwtPlotMarker * m = dynamic_cast<const QwtPlotMarker*>(*it);
-            if (m) {
-                // we only handle vertical markers
-                if (QwtPlotMarker::VLine == m->lineStyle()) {
-                    xy = m->value();
-                    double x = xy.x();
-                    if (x > markerx) {
-                        found = true;
-                        markerx_next = x;
-                        value = m->label().text();
-                        break;
-                    }
-                }
-            }
+    } else if (events) {
+        found = forward ? events->find_next(markerx, k) : events->find_prev(markerx, k);
+        if (found) {
+            markerx_next = events->time(k);
+            value = events->label(k);
         }
     }
-#endif
 
     // set marker to found location
     if (found) {
         _data_marker_label = value;
         _data_marker.setValue(markerx_next, 0);
-        replot();        
+        replot();
     }
     updateStatusbar();
 }
@@ -833,48 +622,28 @@ bool MavPlot::set_markerData(const Data *const d, unsigned long idx) {
 
     bool found = false;
     double markerx = 0;
-#if 0
-    /*******************
-     * SCAN IN Data
-     *******************/
-#else
-    /*******************
-     * SCAN IN Plot
-     *******************/
-    // FIXME: heavy code clone from rev_markerData()
     QPointF xy;
     QString value;
-    // find out what it is, then scan for data
-    const QWT_ABSTRACT_SERIESITEM*s = _get_series(d);
-    if (s) {
+    // find out what it is, then look up the index in the data
+    const LodSeriesData *samples = _get_samples(d);
+    if (samples) {
         // it's a series
-        const QwtPlotCurve *curve = dynamic_cast<const QwtPlotCurve *>(s);
-        if (curve) {
-            xy = curve->sample(idx);
+        if (idx < samples->full_size()) {
+            xy = samples->full_sample(idx);
             markerx = xy.x();
             value = QString::number(xy.y());
             found = true;
         }
     }
     // annotation
-    std::vector<QwtPlotItem*>*v = _get_annotations(d);
-    if (v && !found) {
-        // it's an annotation...we have to go through all of them
-        if (v->size() > idx) {
-            QwtPlotItem*tmp1 = (*v)[idx];
-            const QwtPlotMarker * m = dynamic_cast<const QwtPlotMarker*>(tmp1);
-            if (m) {
-                // we only handle vertical markers
-                if (QwtPlotMarker::VLine == m->lineStyle()) {
-                    xy = m->value();
-                    markerx = xy.x();
-                    found = true;
-                    value = m->label().text();
-                }
-            }
+    const EventPlotItem*events = _get_events(d);
+    if (events && !found) {
+        if (events->size() > idx) {
+            markerx = events->time(idx);
+            found = true;
+            value = events->label(idx);
         }
     }
-#endif
 
     // set marker to found location
     if (found) {
@@ -970,3 +739,46 @@ void MavPlot::removeAllData() {
     _updateDataBounds();
     replot();
 }
+
+void MavPlot::removeAbsentData() {
+    std::vector<const Data*> absent;
+    for (dataplotmap::const_iterator it_series = _series.begin(); it_series != _series.end(); ++it_series) {
+        if (!it_series->first->is_present()) absent.push_back(it_series->first);
+    }
+    for (annotationsmap::const_iterator it_annot = _annotations.begin(); it_annot != _annotations.end(); ++it_annot) {
+        if (!it_annot->first->is_present()) absent.push_back(it_annot->first);
+    }
+    if (absent.empty()) return;
+
+    for (std::vector<const Data*>::const_iterator it = absent.begin(); it != absent.end(); ++it) {
+        _removeData(*it);
+    }
+    _updateDataBounds();
+    replot();
+}
+
+void MavPlot::reloadData() {
+    // curves read from the data when drawn, they only need to know that it changed
+    for (dataplotmap::iterator it_series = _series.begin(); it_series != _series.end(); ++it_series) {
+        it_series->second->itemChanged();
+    }
+
+    // the events were copied; copy them again, into the same items, which dialogs may refer to
+    for (annotationsmap::iterator it_annot = _annotations.begin(); it_annot != _annotations.end(); ++it_annot) {
+        std::vector<QwtPlotItem*>*const v = it_annot->second;
+        std::vector<QwtPlotItem*>*const fresh = _branch_datatype_annotation(it_annot->first, 0);
+        if (!fresh) continue;
+        for (unsigned int k=0; k < v->size() && k < fresh->size(); ++k) {
+            EventPlotItem*const events = dynamic_cast<EventPlotItem*>((*v)[k]);
+            EventPlotItem*const fresh_events = dynamic_cast<EventPlotItem*>((*fresh)[k]);
+            if (events && fresh_events) events->swap_events(*fresh_events);
+        }
+        for (std::vector<QwtPlotItem*>::iterator it_vect = fresh->begin(); it_vect != fresh->end(); ++it_vect) {
+            delete *it_vect;
+        }
+        delete fresh;
+    }
+
+    _updateDataBounds();
+    replot();
+}
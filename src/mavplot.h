@@ -38,6 +38,9 @@
 #include "dialogstats.h"
 #include "mavplotdataitemmodel.h"
 
+class EventPlotItem; ///< forward decl
+class LodSeriesData; ///< forward decl
+
 class MavPlot : public QwtPlot
 {
     Q_OBJECT
@@ -110,8 +113,8 @@ public:
     bool set_markerData(const Data * const, unsigned long idx); // jump to index of given row
     void fwd_markerData(const Data * const); // forward marker to next data point of given row
     void rev_markerData(const Data * const); // reverse
-    void setmax_markerData(const Data *const d); // set marker to max of current row
-    void setmin_markerData(const Data *const d); // set marker to min of current row
+    void setmax_markerData(const Data *const d); // set marker to max of current row, within the visible time
+    void setmin_markerData(const Data *const d); // set marker to min of current row, within the visible time
     void unset_markerA();
     void unset_markerB();
     void unset_markerData();
@@ -133,11 +136,15 @@ public:
     void removeAllData();
 
     /**
-     * @brief convert Data class to two QVectors, which can be plotted
+     * @brief removes the data which is not present. Call this before more data is merged into the
+     * scenario, since the scenario may delete such data then.
      */
-    static bool data2xyvect(const Data * data, QVector<double> & xdata, QVector<double> & ydata, double scale=1.0);
-    template <typename ST>
-    static bool data2xyvect(const DataTimeseries<ST> * data, QVector<double> & xdata, QVector<double> & ydata, double scale=1.0);
+    void removeAbsentData();
+
+    /**
+     * @brief call this after the data in the plot has changed, e.g., because more was merged in
+     */
+    void reloadData();
 
     /**
      * @brief apply/undo coloring for print and PDF export
@@ -175,18 +182,24 @@ private:
 
     QWT_ABSTRACT_SERIESITEM *_get_series(const Data * const d);
     std::vector<QwtPlotItem*>* _get_annotations(const Data * const d);
+    const LodSeriesData * _get_samples(const Data * const d); ///< all samples of a series, or NULL
+    const EventPlotItem * _get_events(const Data * const d); ///< the item of an event series, or NULL
 
     /**
-     * @brief MavPlot::_updateDataBounds
-     * update internal variable _databounds to indicate overall data range
+     * @brief moves the data marker to the next or previous sample/event of d, by binary search
      */
-    void _updateDataBounds ();
+    void _step_markerData(const Data *const d, bool forward);
 
     /**
-     * @brief converty "any" data type to double
+     * @brief moves the data marker to the largest or smallest value of d within the visible time
      */
-    template <typename CT>
-    static bool _convert2double(CT in, double &ret, double scale=1.);
+    void _extremum_markerData(const Data *const d, bool max);
+
+    /**
+     * @brief MavPlot::_updateDataBounds
+     * update internal variable _databounds to indicate overall data range
+     */
+    void _updateDataBounds ();
 
     /**
      * @brief returns a color to be used for each data, based on the sequence number of the plot
@@ -226,7 +239,7 @@ private:
      * @brief for each added data we can moreover have annotations that are
      * connected to it. the annotations would have to be removed, if the data is removed.
      * some data type might also just result in an annotation, and not in a SeriesItem.
-     * E.g., DataEvent will just result in markers, not in a data row.
+     * E.g., DataEvent will just result in an EventPlotItem, not in a data row.
      */
     typedef std::map<Data const*, std::vector<QwtPlotItem*>* > annotationsmap;
     typedef std::pair<Data const*, std::vector<QwtPlotItem*>* > annotationsmap_pair;
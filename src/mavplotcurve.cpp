@@ -0,0 +1,58 @@
+/**
+ * @file mavplotcurve.cpp
+ * @brief Curve for MavPlot which only draws what the pixels can show
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <math.h>
+#include <qwt_scale_map.h>
+#include "mavplotcurve.h"
+
+// TODO: ugly stuff, same as MavPlot::_branch_datatype_series()
+LodSeriesData* LodSeriesData::create(const Data * data, double scale) {
+    const DataTimeseries<float> *const tsf = dynamic_cast<DataTimeseries<float> const*>(data);
+    if (tsf) return new TimeseriesLodData<float>(tsf, scale);
+
+    const DataTimeseries<double> * tsd = dynamic_cast<DataTimeseries<double> const*>(data);
+    if (tsd) return new TimeseriesLodData<double>(tsd, scale);
+
+    const DataTimeseries<unsigned int> * tsu = dynamic_cast<DataTimeseries<unsigned int> const*>(data);
+    if (tsu) return new TimeseriesLodData<unsigned int>(tsu, scale);
+
+    const DataTimeseries<int> * tsi = dynamic_cast<DataTimeseries<int> const*>(data);
+    if (tsi) return new TimeseriesLodData<int>(tsi, scale);
+
+    return NULL;
+}
+
+void LodPlotCurve::drawSeries(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                              const QRectF &canvasRect, int from, int to) const {
+    // drawing does not change the curve, only which samples it hands to Qwt
+    LodSeriesData*lod = dynamic_cast<LodSeriesData*>(const_cast<QwtSeriesData<QPointF>*>(data()));
+    if (lod) {
+        const double xmin = std::min(xMap.s1(), xMap.s2());
+        const double xmax = std::max(xMap.s1(), xMap.s2());
+        lod->set_view(xmin, xmax, (unsigned int)ceil(fabs(xMap.pDist())));
+        // the indices of the caller refer to the samples before
+        from = 0;
+        to = -1;
+    }
+    QwtPlotCurve::drawSeries(painter, xMap, yMap, canvasRect, from, to);
+}
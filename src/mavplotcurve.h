@@ -0,0 +1,223 @@
+/**
+ * @file mavplotcurve.h
+ * @brief Curve for MavPlot which only draws what the pixels can show
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef MAVPLOTCURVE_H
+#define MAVPLOTCURVE_H
+
+#include <vector>
+#include <algorithm>
+#include <QPointF>
+#include <QRectF>
+#include <qwt_series_data.h>
+#include <qwt_plot_curve.h>
+#include "data.h"
+#include "data_timeseries.h"
+
+/**
+ * @brief samples of a series for a level of detail: before each redraw, the curve says
+ * which x-range is visible on how many pixels, and then only gets the samples which make a
+ * difference there. The samples are read from the data when Qwt asks for them, and not copied.
+ */
+class LodSeriesData : public QwtSeriesData<QPointF> {
+public:
+    /**
+     * @brief picks the samples for this view. Cheap if nothing changed.
+     * @param xmin, xmax visible range, absolute time
+     * @param width pixels
+     */
+    virtual void set_view(double xmin, double xmax, unsigned int width) = 0;
+
+    /**
+     * @brief number of all samples, not only the ones in the view
+     */
+    virtual size_t full_size() const = 0;
+
+    /**
+     * @brief one of all samples, as it would be plotted
+     */
+    virtual QPointF full_sample(size_t k) const = 0;
+
+    /**
+     * @brief the first of all samples after x, by binary search
+     * @return false if there is none
+     */
+    virtual bool find_next(double x, size_t & k) const = 0;
+
+    /**
+     * @brief the last of all samples before x, by binary search
+     * @return false if there is none
+     */
+    virtual bool find_prev(double x, size_t & k) const = 0;
+
+    /**
+     * @brief the sample with the largest or smallest (scaled) value between xmin and xmax
+     * @return false if there is none
+     */
+    virtual bool find_extremum(double xmin, double xmax, bool max, size_t & k) const = 0;
+
+    /**
+     * @brief factor for the values. Takes effect with the next redraw, nothing is rebuilt.
+     */
+    virtual void set_scale(double scale) = 0;
+    virtual double get_scale() const = 0;
+
+    /**
+     * @brief makes one for the given data
+     * @param scale factor for the values
+     * @return NULL if the data cannot be plotted as a curve
+     */
+    static LodSeriesData* create(const Data * data, double scale=1.0);
+};
+
+/**
+ * @brief LodSeriesData over a DataTimeseries, see DataTimeseries::get_lod_indices(). It only
+ * keeps the indices of the samples in the view; time and value are taken from the data, converted
+ * to absolute time and double, and scaled when Qwt asks for them.
+ */
+template <typename T>
+class TimeseriesLodData : public LodSeriesData {
+public:
+    TimeseriesLodData(const DataTimeseries<T> * data, double scale=1.0) : _data(data), _scale(scale), _view_xmin(0.), _view_xmax(0.), _view_width(0), _view_n(0), _view_offset(0.) {}
+
+    void set_view(double xmin, double xmax, unsigned int width) {
+        const size_t n = full_size();
+        const double offset = _offset();
+        if (width == _view_width && xmin == _view_xmin && xmax == _view_xmax && n == _view_n && offset == _view_offset) return;
+        _view_xmin = xmin;
+        _view_xmax = xmax;
+        _view_width = width;
+        _view_n = n;
+        _view_offset = offset;
+
+        _data->get_lod_indices(xmin, xmax, width, _idx);
+    }
+
+    size_t full_size() const {
+        return _data->get_time().size();
+    }
+
+    QPointF full_sample(size_t k) const {
+        return QPointF(_data->get_time()[k] + _offset(), ((double)_data->get_data()[k])*_scale);
+    }
+
+    bool find_next(double x, size_t & k) const {
+        const typename DataTimeseries<T>::timevector & t = _data->get_time();
+        k = std::upper_bound(t.begin(), t.end(), x, XBeforeSample(_offset())).index();
+        return k < t.size();
+    }
+
+    bool find_prev(double x, size_t & k) const {
+        const typename DataTimeseries<T>::timevector & t = _data->get_time();
+        k = std::lower_bound(t.begin(), t.end(), x, SampleBeforeX(_offset())).index();
+        if (k == 0) return false;
+        --k;
+        return true;
+    }
+
+    bool find_extremum(double xmin, double xmax, bool max, size_t & k) const {
+        size_t kmin, kmax;
+        if (!_data->get_extrema_index(xmin, xmax, kmin, kmax)) return false;
+        k = (max != (_scale < 0.)) ? kmax : kmin;
+        return true;
+    }
+
+    void set_scale(double scale) {
+        _scale = scale;
+    }
+
+    double get_scale() const {
+        return _scale;
+    }
+
+    size_t size() const {
+        return _idx.size();
+    }
+
+    QPointF sample(size_t i) const {
+        return full_sample(_idx[i]);
+    }
+
+    /**
+     * @brief of all samples, not only of those in the view, from the summary of the data
+     */
+    QRectF boundingRect() const {
+        double tmin, tmax, vmin, vmax;
+        if (!_data->get_bounds(tmin, tmax, vmin, vmax)) return QRectF(1.0, 1.0, -2.0, -2.0); // invalid, like Qwt does
+        vmin *= _scale;
+        vmax *= _scale;
+        if (vmax < vmin) std::swap(vmin, vmax);
+        return QRectF(tmin, vmin, tmax - tmin, vmax - vmin);
+    }
+
+private:
+    /**
+     * @brief epoch of the data in seconds. Not kept, since merging more data in may change it.
+     */
+    double _offset() const {
+        return _data->get_epoch_datastart()/1E6;
+    }
+
+    /**
+     * @brief compare in absolute time like full_sample() does, so that the result is
+     * the same as when going through all samples
+     */
+    class SampleBeforeX {
+    public:
+        explicit SampleBeforeX(double offset) : _offset(offset) {}
+        bool operator()(double t, double x) const { return t + _offset < x; }
+    private:
+        double _offset;
+    };
+
+    class XBeforeSample {
+    public:
+        explicit XBeforeSample(double offset) : _offset(offset) {}
+        bool operator()(double x, double t) const { return x < t + _offset; }
+    private:
+        double _offset;
+    };
+
+    const DataTimeseries<T>*_data;
+    double                  _scale;
+    double                  _view_xmin;
+    double                  _view_xmax;
+    unsigned int            _view_width; ///< 0 if there was no view yet
+    size_t                  _view_n;     ///< size of the data at that time
+    double                  _view_offset; ///< and its epoch
+    std::vector<size_t>     _idx;        ///< which samples are in the view
+};
+
+/**
+ * @brief QwtPlotCurve which tells its LodSeriesData about the view before drawing.
+ * With other data, it is just a QwtPlotCurve.
+ */
+class LodPlotCurve : public QwtPlotCurve {
+public:
+    explicit LodPlotCurve(const QString &title = QString()) : QwtPlotCurve(title) {}
+
+protected:
+    virtual void drawSeries(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                            const QRectF &canvasRect, int from, int to) const;
+};
+
+#endif // MAVPLOTCURVE_H
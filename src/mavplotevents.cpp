@@ -0,0 +1,144 @@
+/**
+ * @file mavplotevents.cpp
+ * @brief Plot item which draws all events of one series
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <math.h>
+#include <climits>
+#include <algorithm>
+#include <QPainter>
+#include <QFontMetrics>
+#include <qwt_painter.h>
+#include <qwt_scale_map.h>
+#include "mavplotevents.h"
+#if QWT_VERSION >= QWT_VERSION_CHECK(6,1,0)
+    #include <qwt_graphic.h>
+#endif
+
+EventPlotItem::EventPlotItem(const QString &title) : QwtPlotItem(QwtText(title)) {
+    setItemAttribute(QwtPlotItem::Legend, true);
+    setZ(30.0); // same as QwtPlotMarker
+}
+
+int EventPlotItem::rtti() const {
+    return QwtPlotItem::Rtti_PlotUserItem;
+}
+
+void EventPlotItem::reserve(size_t n) {
+    _time.reserve(n);
+    _label.reserve(n);
+}
+
+void EventPlotItem::append(double t, const QString &label) {
+    _time.push_back(t);
+    _label.push_back(label);
+}
+
+void EventPlotItem::swap_events(EventPlotItem &other) {
+    _time.swap(other._time);
+    _label.swap(other._label);
+    itemChanged();
+    other.itemChanged();
+}
+
+bool EventPlotItem::find_next(double x, size_t &k) const {
+    k = std::upper_bound(_time.begin(), _time.end(), x) - _time.begin();
+    return k < _time.size();
+}
+
+bool EventPlotItem::find_prev(double x, size_t &k) const {
+    k = std::lower_bound(_time.begin(), _time.end(), x) - _time.begin();
+    if (k == 0) return false;
+    --k;
+    return true;
+}
+
+void EventPlotItem::setPen(const QPen &pen) {
+    if (pen == _pen) return;
+    _pen = pen;
+#if QWT_VERSION >= QWT_VERSION_CHECK(6,1,0)
+    legendChanged();
+#endif
+    itemChanged();
+}
+
+void EventPlotItem::draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap & /*yMap*/,
+                         const QRectF &canvasRect) const {
+    // only the events in the visible interval
+    const double xmin = std::min(xMap.s1(), xMap.s2());
+    const double xmax = std::max(xMap.s1(), xMap.s2());
+    const size_t first = std::lower_bound(_time.begin(), _time.end(), xmin) - _time.begin();
+    const size_t end = std::upper_bound(_time.begin() + first, _time.end(), xmax) - _time.begin();
+    if (first >= end) return;
+
+    painter->save();
+    painter->setPen(_pen);
+    const QFontMetrics fm = painter->fontMetrics();
+    int last_px = INT_MIN;          // pixel of the last line
+    double label_free = -INFINITY;  // where the next label may start without overlapping
+
+    for (size_t k=first; k < end; ) {
+        const double px = xMap.transform(_time[k]);
+        if (qRound(px) != last_px) {
+            last_px = qRound(px);
+            QwtPainter::drawLine(painter, px, canvasRect.top(), px, canvasRect.bottom());
+        }
+
+        // label at the bottom, right of the line, reading upwards
+        const double lx = px + LABEL_SPACING;
+        if (!_label[k].isEmpty() && lx >= label_free) {
+            painter->save();
+            painter->translate(lx, canvasRect.bottom() - LABEL_SPACING);
+            painter->rotate(-90.0);
+            painter->drawText(QPointF(0.0, fm.ascent()), _label[k]);
+            painter->restore();
+            label_free = lx + fm.height() + LABEL_SPACING;
+        }
+
+        if (label_free > last_px + 0.5 + LABEL_SPACING) {
+            // the rest of this pixel can get neither a line nor a label
+            const double tnext = xMap.invTransform(last_px + 0.5);
+            k = std::lower_bound(_time.begin() + k + 1, _time.begin() + end, tnext) - _time.begin();
+        } else {
+            ++k;
+        }
+    }
+    painter->restore();
+}
+
+#if QWT_VERSION >= QWT_VERSION_CHECK(6,1,0)
+QwtGraphic EventPlotItem::legendIcon(int /*index*/, const QSizeF &size) const {
+    QwtGraphic icon;
+    icon.setDefaultSize(size);
+    icon.setRenderHint(QwtGraphic::RenderPensUnscaled, true);
+    QPainter painter(&icon);
+    painter.setPen(_pen);
+    QwtPainter::drawLine(&painter, 0.5*size.width(), 0.0, 0.5*size.width(), size.height());
+    return icon;
+}
+#else
+void EventPlotItem::drawLegendIdentifier(QPainter *painter, const QRectF &rect) const {
+    painter->save();
+    painter->setPen(_pen);
+    QwtPainter::drawLine(painter, rect.center().x(), rect.top(), rect.center().x(), rect.bottom());
+    painter->restore();
+}
+#endif
@@ -0,0 +1,106 @@
+/**
+ * @file mavplotevents.h
+ * @brief Plot item which draws all events of one series
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef MAVPLOTEVENTS_H
+#define MAVPLOTEVENTS_H
+
+#include <vector>
+#include <QString>
+#include <QPen>
+#include <qwt_plot_item.h>
+#include "qwt_compat.h"
+
+/**
+ * @brief events as vertical lines with a vertical label, like a QwtPlotMarker per event.
+ * Times and labels are kept in plain arrays, and only the events in the visible interval are
+ * drawn. There, at most one line is drawn per pixel, and a label is left out if it would overlap
+ * the one before.
+ *
+ * The times must be ascending, like those of DataEvent.
+ */
+class EventPlotItem : public QwtPlotItem {
+public:
+    static const int LABEL_SPACING = 2; ///< pixels between line and label, and between labels
+
+    explicit EventPlotItem(const QString &title = QString());
+
+    virtual int rtti() const;
+
+    void reserve(size_t n);
+
+    /**
+     * @param t absolute time
+     */
+    void append(double t, const QString & label);
+
+    /**
+     * @brief exchange the events with those of other, but keep title and pen
+     */
+    void swap_events(EventPlotItem & other);
+
+    size_t size() const {
+        return _time.size();
+    }
+
+    double time(size_t k) const {
+        return _time[k];
+    }
+
+    const QString& label(size_t k) const {
+        return _label[k];
+    }
+
+    /**
+     * @brief the first event after x, by binary search
+     * @return false if there is none
+     */
+    bool find_next(double x, size_t & k) const;
+
+    /**
+     * @brief the last event before x, by binary search
+     * @return false if there is none
+     */
+    bool find_prev(double x, size_t & k) const;
+
+    void setPen(const QPen & pen);
+
+    const QPen& pen() const {
+        return _pen;
+    }
+
+    virtual void draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+                      const QRectF &canvasRect) const;
+
+#if QWT_VERSION >= QWT_VERSION_CHECK(6,1,0)
+    virtual QwtGraphic legendIcon(int index, const QSizeF &size) const;
+#else
+    virtual void drawLegendIdentifier(QPainter *painter, const QRectF &rect) const;
+#endif
+
+private:
+    std::vector<double>  _time;
+    std::vector<QString> _label;
+    QPen                 _pen;
+};
+
+#endif // MAVPLOTEVENTS_H
@@ -28,13 +28,17 @@
 #include <string>
 #include <time.h>
 #include <math.h>
+#include <string.h>
+#include <iomanip>
 #include "mavsystem.h"
 #include "mavlink.h"
+#include "mavlinkdecoders.h"
 #include "stringfun.h"
 #include "datagroup.h"
 #include "data_event.h"
 #include "data_timeseries.h"
 #include "data_param.h"
+#include "resampler.h"
 #include "treeitem.h"
 #include "time_fun.h"
 #include "mavsystem_macros.h"
@@ -73,6 +77,7 @@ void MavSystem::_defaults() {
     _time_maxfwdjump_sec = 100.;
     _time_maxbackjump_sec = 5.;
     _have_time_update = false;
+    _time_unsynced = false;
     _mavlink_summary._link_throughput_bytes = 0;
     _mavlink_summary.num_uninterpreted = 0;
     _mavlink_summary.num_received = 0;
@@ -215,16 +220,81 @@ void MavSystem::get_summary(string &buf) const {
         /***************************************/
         ss << "MavLink:" << endl;
         /***************************************/
-        ss << "   - sent total: " << _mavlink_summary.num_received << " (IDs: " << set2str(_mavlink_summary.mavlink_msgids_interpreted) << ")" << endl;
+        ss << "   - sent total: " << _mavlink_summary.num_received << " (IDs: " << set2str(get_mavlink_msgids(MAVLINK_INTERPRETED)) << ")" << endl;
         if (_mavlink_summary.num_uninterpreted > 0) {
-            ss << "   - uninterpreted: " << _mavlink_summary.num_uninterpreted << " (IDs: " << set2str(_mavlink_summary.mavlink_msgids_uninterpreted) << ")" << endl;
+            ss << "   - uninterpreted: " << _mavlink_summary.num_uninterpreted << " (IDs: " << set2str(get_mavlink_msgids(MAVLINK_UNINTERPRETED)) << ")" << endl;
         }
         ss << "   - errors: "  << _mavlink_summary.num_error << endl;
+        unsigned long lost = 0;
+        for (std::vector<compstats_t>::const_iterator it = _mavlink_summary.components.begin(); it != _mavlink_summary.components.end(); ++it) {
+            lost += it->seq_gaps;
+        }
+        if (lost > 0) {
+            ss << "   - lost on the link: " << lost << " (" << (100.*lost)/(lost + _mavlink_summary.num_received) << " %)" << endl;
+        }
     }
 
     buf = ss.str();
 }
 
+void MavSystem::describe_link(std::ostream &ofs) const {
+    if (_mavlink_summary.components.empty()) return; // e.g., onboard logs
+
+    unsigned long total_bytes = 0;
+    for (std::vector<compstats_t>::const_iterator it = _mavlink_summary.components.begin(); it != _mavlink_summary.components.end(); ++it) {
+        for (unsigned int k=0; k < LINKSTATS_MSGIDS; ++k) total_bytes += it->msgs[k].bytes;
+        for (std::map<unsigned int, msgstats_t>::const_iterator itm = it->msgs_ext.begin(); itm != it->msgs_ext.end(); ++itm) {
+            total_bytes += itm->second.bytes;
+        }
+    }
+
+    const std::ios_base::fmtflags flags = ofs.flags();
+    const std::streamsize prec = ofs.precision();
+    ofs << "MavLink link of system " << id << ":" << endl;
+    for (std::vector<compstats_t>::const_iterator it = _mavlink_summary.components.begin(); it != _mavlink_summary.components.end(); ++it) {
+        const compstats_t & comp = *it;
+        std::vector<unsigned int> msgids;
+        unsigned long packets = 0;
+        for (unsigned int k=0; k < LINKSTATS_MSGIDS; ++k) {
+            if (comp.msgs[k].packets == 0) continue;
+            msgids.push_back(k);
+            packets += comp.msgs[k].packets;
+        }
+        for (std::map<unsigned int, msgstats_t>::const_iterator itm = comp.msgs_ext.begin(); itm != comp.msgs_ext.end(); ++itm) {
+            msgids.push_back(itm->first);
+            packets += itm->second.packets;
+        }
+        // losses are only known per component; assume each message type lost its share
+        const double lossratio = packets > 0 ? ((double) comp.seq_gaps) / packets : 0.;
+
+        ofs << "   component " << (unsigned int) comp.compid << ": " << packets << " packets, " << comp.seq_gaps << " lost ("
+            << (100.*comp.seq_gaps)/(comp.seq_gaps + packets) << " %)" << endl;
+        ofs << "   " << std::setw(8) << "msgid" << std::setw(28) << "name" << std::setw(10) << "packets"
+            << std::setw(10) << "rate[Hz]" << std::setw(12) << "bytes" << std::setw(10) << "share[%]"
+            << std::setw(10) << "gaps" << std::setw(10) << "lost" << endl;
+        for (std::vector<unsigned int>::const_iterator itid = msgids.begin(); itid != msgids.end(); ++itid) {
+            const msgstats_t & ms = *_find_msgstats(comp, *itid);
+            const MavlinkDecoders::message_t*const info = MavlinkDecoders::find_message(*itid);
+            const double dt = ms.t_last - ms.t_first;
+            ofs << "   " << std::setw(8) << *itid << std::setw(28) << (info ? info->name : "?") << std::setw(10) << ms.packets
+                << std::setw(10) << std::fixed << std::setprecision(2) << (dt > 0. ? (ms.packets - 1) / dt : 0.)
+                << std::setw(12) << ms.bytes
+                << std::setw(10) << (total_bytes > 0 ? (100. * ms.bytes) / total_bytes : 0.)
+                << std::setw(10) << ms.seq_gaps
+                << std::setw(10) << std::setprecision(1) << lossratio * ms.packets << endl;
+            ofs.flags(flags);
+            ofs.precision(prec);
+        }
+    }
+    ofs << endl;
+}
+
+void MavSystem::describe_data(std::ostream &ofs) const {
+    for (data_accessmap::const_iterator it = _data_from_path.begin(); it != _data_from_path.end(); ++it) {
+        ofs << it->second->describe_myself() << endl;
+    }
+}
+
 void MavSystem::_log(logmsgtype_e t, const std::string & str) {
     Logger::Instance().write(t, str, _logchannel);
 }
@@ -323,7 +393,7 @@ void MavSystem::_data_unregister_hierarchy(Data*const src) {
     }
 }
 
-void MavSystem::_del_data(Data*const src) {
+void MavSystem::_detach_data(Data*const src) {
     if (!src) return;
     const string fullpath = Data::get_fullname(src);
 
@@ -333,6 +403,12 @@ void MavSystem::_del_data(Data*const src) {
 
     // remove from hierarchy
     _data_unregister_hierarchy(src);
+    src->parent = NULL;
+}
+
+void MavSystem::_del_data(Data*const src) {
+    if (!src) return;
+    _detach_data(src);
 
     // delete the data itself
     delete src; // FIXME: deleting abstract class here...
@@ -341,31 +417,47 @@ void MavSystem::_del_data(Data*const src) {
 bool MavSystem::_add_data(const Data*const src) {
     // find data path and register to get it into the hierarchy
     if (!src) return false;
+    return _add_data(Data::get_fullname(src), std::vector<const Data*>(1, src));
+}
 
-    string fullname = Data::get_fullname(src);
+bool MavSystem::_add_data(const std::string & fullname, const std::vector<const Data*> & srcs) {
+    if (srcs.empty()) return false;
 
     // check whether data exists already
     Data * mydata = _get_data<Data>(fullname);
+    if (mydata && !mydata->is_present()) {
+        _del_data(mydata); // drop old, empty data!!
+        mydata = NULL;
+    }
     if (mydata) {
-        // could still be empty
-        if (mydata->is_present()) {
-            // already exists -> ask data class to merge it in
-            return mydata->merge_in(src);
-        } else {
-            _del_data(mydata); // drop old, empty data!!
-            // since there is nothing now, clone it
-            Data*const copiedData = src->Clone(); ///< call copy CTOR (covariant return)
-            _data_register_hierarchy(fullname, copiedData);
-            if (!copiedData) return false;
-            return true;
-        }
-    } else {
-        // does not exist -> take a deep copy and register it
-        Data*const copiedData = src->Clone(); ///< call copy CTOR (covariant return)
-        if (!copiedData) return false;
-        _data_register_hierarchy(fullname, copiedData);
-        return true;
+        // already exists -> ask data class to merge it in
+        return mydata->merge_in_all(srcs);
     }
+
+    // does not exist -> take a deep copy of the first and register it
+    Data*const copiedData = srcs.front()->Clone(); ///< call copy CTOR (covariant return)
+    if (!copiedData) return false;
+    _data_register_hierarchy(fullname, copiedData);
+    if (srcs.size() == 1) return true;
+    return copiedData->merge_in_all(std::vector<const Data*>(srcs.begin() + 1, srcs.end()));
+}
+
+bool MavSystem::_take_data(const std::string & fullname, const std::vector<Data*> & srcs) {
+    if (srcs.empty()) return false;
+
+    Data * mydata = _get_data<Data>(fullname);
+    if (mydata && !mydata->is_present()) {
+        _del_data(mydata); // drop old, empty data!!
+        mydata = NULL;
+    }
+    if (mydata) {
+        return mydata->take_in_all(srcs);
+    }
+
+    // does not exist -> the first becomes ours
+    _data_register_hierarchy(fullname, srcs.front());
+    if (srcs.size() == 1) return true;
+    return srcs.front()->take_in_all(std::vector<Data*>(srcs.begin() + 1, srcs.end()));
 }
 
 // DONE
@@ -562,10 +654,10 @@ void MavSystem::track_ambient(float temp_degC, float press_hPa) {
  * @param data_length length of an incoming packet, inkl. header
  * @param msgid MAVlink message identifier
  * @param whatwasdone to indicate how the caller processed the message; useful to see if MavLogAnalyzer misses messages
+ * @param compid component which sent the packet
+ * @param seq sequence number of the packet
  */
-void MavSystem::track_mavlink(unsigned int data_length_bytes, unsigned int msgid, mavlink_parsed_e whatwasdone) {
-    MAVSYSTEM_DATA_ITEM_OR_RETURN(DataTimeseries<float>, data_throughput, "radio/throughput", "kbps");
-
+void MavSystem::track_mavlink(unsigned int data_length_bytes, unsigned int msgid, mavlink_parsed_e whatwasdone, uint8_t compid, uint8_t seq) {
     // accumulate amount of sent data between two successive time references
     _mavlink_summary._link_throughput_bytes += data_length_bytes;
 
@@ -573,26 +665,97 @@ void MavSystem::track_mavlink(unsigned int data_length_bytes, unsigned int msgid
     switch (whatwasdone) {
     case MAVLINK_INTERPRETED:
         _mavlink_summary.num_interpreted++;
-        _mavlink_summary.mavlink_msgids_interpreted.insert(msgid);
         break;
     case MAVLINK_UNINTERPRETED:
         _mavlink_summary.num_uninterpreted++;
-        _mavlink_summary.mavlink_msgids_uninterpreted.insert(msgid);
         break;
     case MAVLINK_ERROR:
     default:
         _mavlink_summary.num_error++;
         break;
     }
+
     _mavlink_summary.num_received++;
 
-    // only add to series if time information is available
-    if (_have_time_update) {
-        data_throughput->add_elem(_mavlink_summary._link_throughput_bytes/128., _time);
-        _mavlink_summary._link_throughput_bytes = 0;
+    // per component and message id
+    const size_t ncomp = _mavlink_summary.components.size();
+    compstats_t & comp = _get_compstats(compid);
+    msgstats_t & ms = _get_msgstats(comp, msgid);
+    if (_mavlink_summary.components.size() > ncomp) {
+        // new component; nothing to compare the sequence number with
+        comp.first_seq = seq;
+        comp.first_msgid = msgid;
+    } else {
+        // the sequence number wraps; a jump backwards is a duplicate or reordered packet, not a loss
+        const uint8_t gap = (uint8_t) (seq - comp.last_seq - 1);
+        if (gap < 128) {
+            comp.seq_gaps += gap;
+            ms.seq_gaps += gap;
+        }
+    }
+    comp.last_seq = seq;
+    if (0 == ms.packets) ms.t_first = _time;
+    ms.t_last = _time;
+    ms.packets++;
+    ms.bytes += data_length_bytes;
+    ms.parsed |= (uint8_t) (1 << whatwasdone);
+
+    // only add to series if time information is available. Looked up only then (and with the first packet, to have it anyway)
+    if (_have_time_update || 1 == _mavlink_summary.num_received) {
+        MAVSYSTEM_DATA_ITEM_OR_RETURN(DataTimeseries<float>, data_throughput, "radio/throughput", "kbps");
+        if (_have_time_update) {
+            data_throughput->add_elem(_mavlink_summary._link_throughput_bytes/128., _time);
+            _mavlink_summary._link_throughput_bytes = 0;
+        }
     }
 }
 
+MavSystem::compstats_t & MavSystem::_get_compstats(uint8_t compid) {
+    std::vector<compstats_t> & comps = _mavlink_summary.components;
+    for (std::vector<compstats_t>::iterator it = comps.begin(); it != comps.end(); ++it) {
+        if (it->compid == compid) return *it;
+    }
+    comps.resize(comps.size() + 1);
+    compstats_t & c = comps.back();
+    c.compid = compid;
+    c.first_seq = c.last_seq = 0;
+    c.first_msgid = 0;
+    c.seq_gaps = 0;
+    memset(c.msgs, 0, sizeof(c.msgs));
+    return c;
+}
+
+MavSystem::msgstats_t & MavSystem::_get_msgstats(compstats_t &comp, unsigned int msgid) {
+    if (msgid < LINKSTATS_MSGIDS) return comp.msgs[msgid];
+    std::map<unsigned int, msgstats_t>::iterator it = comp.msgs_ext.find(msgid);
+    if (it == comp.msgs_ext.end()) {
+        msgstats_t ms;
+        memset(&ms, 0, sizeof(ms));
+        it = comp.msgs_ext.insert(std::make_pair(msgid, ms)).first;
+    }
+    return it->second;
+}
+
+const MavSystem::msgstats_t* MavSystem::_find_msgstats(const compstats_t &comp, unsigned int msgid) {
+    if (msgid < LINKSTATS_MSGIDS) return comp.msgs[msgid].packets > 0 ? &comp.msgs[msgid] : NULL;
+    std::map<unsigned int, msgstats_t>::const_iterator it = comp.msgs_ext.find(msgid);
+    return it == comp.msgs_ext.end() ? NULL : &it->second;
+}
+
+std::set<unsigned int> MavSystem::get_mavlink_msgids(mavlink_parsed_e whatwasdone) const {
+    std::set<unsigned int> ids;
+    const uint8_t bit = (uint8_t) (1 << whatwasdone);
+    for (std::vector<compstats_t>::const_iterator it = _mavlink_summary.components.begin(); it != _mavlink_summary.components.end(); ++it) {
+        for (unsigned int k=0; k < LINKSTATS_MSGIDS; ++k) {
+            if (it->msgs[k].parsed & bit) ids.insert(k);
+        }
+        for (std::map<unsigned int, msgstats_t>::const_iterator itm = it->msgs_ext.begin(); itm != it->msgs_ext.end(); ++itm) {
+            if (itm->second.parsed & bit) ids.insert(itm->first);
+        }
+    }
+    return ids;
+}
+
 /**
  * @brief keep track of flight data except location
  * @param airspeed_ms
@@ -989,9 +1152,10 @@ void MavSystem::_postprocess_glideperf_pos() {
         MAVSYSTEM_DATA_ITEM_OR_RETURN(DataTimeseries<float>, data_dist, "glideperf/cum. horz. dist.", "m");
         data_dist->set_type(Data::DATA_DERIVED);
         float x_pre, y_pre, hdist_pre;
+        DataTimeseries<float>::Cursor cur_y(data_y), cur_z(data_z);
         for (unsigned k=0; k<data_x->size(); ++k) {
             double t; float x, y, z;
-            if (data_x->get_data(k, t, x) && data_y->get_data_at_time(t, y) && data_z->get_data_at_time(t, z)) {
+            if (data_x->get_data(k, t, x) && cur_y.get_data_at_time(t, y) && cur_z.get_data_at_time(t, z)) {
                 if (k>0) {
                     const float hdist = sqrt(pow(x-x_pre,2) + pow(y-y_pre,2)) + hdist_pre;
                     data_dist->add_elem(hdist, t);
@@ -1089,13 +1253,21 @@ void MavSystem::_postprocess_glideperf_vel() {
         // FIXME: otherwise, try to get speed in N,E,D/X,Y,Z directions and compute vector length
         const DataTimeseries<float> * const data_try1 = get_data <const DataTimeseries<float> >("NKF1/VE", true);
         const DataTimeseries<float> * const data_try2 = get_data <const DataTimeseries<float> >("NKF1/VN", true);
+        Resampler<float> rs;
         if (data_try1 && data_try2) {
+            rs.add_series(data_try2);
+            rs.set_grid_series(data_try1);
+        }
+        if (data_try1 && data_try2 && rs.run()) {
             // if present, we believe the data
             // fuse to scalar
             MAVSYSTEM_DATA_ITEM_OR_RETURN(DataTimeseries<float>, data_newspeed, "glideperf/groundspeed", "VE and VN");
+            const std::vector<double> & col_vn = rs.get_column(0);
+            const std::vector<char> & has_vn = rs.get_valid(0);
             for (unsigned int k=0; k < data_try1->size(); ++k) {
                 double t; float vn, ve;
-                if (data_try1->get_data(k, t, ve) && data_try2->get_data_at_time(t, vn)) {
+                if (data_try1->get_data(k, t, ve) && has_vn[k]) {
+                    vn = col_vn[k];
                     float total = sqrt(pow(ve,2) + pow(vn,2));
                     data_newspeed->add_elem(total, t);
                 } else {
@@ -1189,10 +1361,11 @@ void MavSystem::_postprocess_glideperf_vel() {
             MAVSYSTEM_DATA_ITEM_OR_RETURN(DataTimeseries<float>, data_windspd, "glideperf/wind speed", "same units as VWE and VWN");
             data_winddir->set_type(Data::DATA_DERIVED);
             data_windspd->set_type(Data::DATA_DERIVED);
+            DataTimeseries<float>::Cursor cur_windN(data_windN), cur_yaw(data_yaw), cur_gspeed(data_gspeed);
             for (unsigned int k=0; k < data_windE->size(); ++k) {
                 double t; float wE, wN;
                 data_windE->get_data(k, t, wE); // wind blowing towards east direction
-                data_windN->get_data_at_time(t, wN); // wind blowing towards north direction
+                cur_windN.get_data_at_time(t, wN); // wind blowing towards north direction
 
 #if 0
                 // DEBUG: wind blowing from south to north (180°)
@@ -1206,7 +1379,7 @@ void MavSystem::_postprocess_glideperf_vel() {
                 data_windspd->add_elem(windspd, t);
 
                 // compute moew cool things
-                float yaw; data_yaw->get_data_at_time(t, yaw);
+                float yaw; cur_yaw.get_data_at_time(t, yaw);
                 yaw = DEG2RAD(angle360(yaw));
 
                 // aeronautic: if wind direction is opposite of yaw, then it's tail wind. So flip it.
@@ -1224,7 +1397,7 @@ void MavSystem::_postprocess_glideperf_vel() {
                     // we estimate airspeed...even when there is a sensor. That is a good exercise.
                     MAVSYSTEM_DATA_ITEM_OR_RETURN(DataTimeseries<float>, data_airspeedest, "glideperf/airspeed estimate", "same units as VWE and VWN");
                     data_airspeedest->set_type(Data::DATA_DERIVED);
-                    float airspeed = 0.; data_gspeed->get_data_at_time(t, airspeed);
+                    float airspeed = 0.; cur_gspeed.get_data_at_time(t, airspeed);
                     airspeed += windhd; // compensate with headwind
                     data_airspeedest->add_elem(airspeed, t);
                 }
@@ -1235,25 +1408,29 @@ void MavSystem::_postprocess_glideperf_vel() {
         // where sink is > 0 ...
         float maxratio = 0.;
         float optspeed = 0.;
+        const DataTimeseries<float> * data_airspeedsrc = data_airspeed;
+        if (!data_airspeedsrc) {
+            if (have_wind) {
+                MAVSYSTEM_READ_DATA(DataTimeseries<float>, data_airspeedest, "glideperf/airspeed estimate");
+                data_airspeedsrc = data_airspeedest; // only required once a sample needs it
+            } else {
+                data_airspeedsrc = data_gspeed;
+            }
+        }
+        DataTimeseries<float>::Cursor cur_accx(data_accx), cur_airspeed(data_airspeedsrc), cur_pitch(data_pitch), cur_roll(data_roll);
         for (unsigned int k=0; k < data_sink->size(); ++k) {
             double t;
             float sink;            
             if (data_sink->get_data(k, t, sink)) {
                 if (sink > 0.) {
-                    float airspeed = 0.f, pitch=0.f, roll=0.f, accx=0.f;
-                    data_accx->get_data_at_time(t, accx);
-                    if (data_airspeed) {
-                        data_airspeed->get_data_at_time(t, airspeed);
-                    } else {
-                        if (have_wind) {
-                            MAVSYSTEM_REQUIRE_DATA(DataTimeseries<float>, data_airspeedest, "glideperf/airspeed estimate");
-                            data_airspeedest->get_data_at_time(t, airspeed);
-                        } else {
-                            data_gspeed->get_data_at_time(t, airspeed);
-                        }
+                    if (!data_airspeedsrc) {
+                        MAVSYSTEM_REQUIRE_DATA(DataTimeseries<float>, data_airspeedest, "glideperf/airspeed estimate");
                     }
-                    data_pitch->get_data_at_time(t, pitch);
-                    data_roll->get_data_at_time(t, roll); // FIXME: check units. Some Autopilots may have scaling
+                    float airspeed = 0.f, pitch=0.f, roll=0.f, accx=0.f;
+                    cur_accx.get_data_at_time(t, accx);
+                    cur_airspeed.get_data_at_time(t, airspeed);
+                    cur_pitch.get_data_at_time(t, pitch);
+                    cur_roll.get_data_at_time(t, roll); // FIXME: check units. Some Autopilots may have scaling
 
                     // detect stationary flight: no kinectic energy being tranformed -> derivative of speed (AccX) close to zero
                     // and around normal attitude and moving ...
@@ -1324,12 +1501,18 @@ void MavSystem::_postprocess_powerstats() {
      *  POWER: TODO: union of samples
      *************************************/
     {
-        for (unsigned int k=0; k < data_battery_volt->size(); ++k) {
+        Resampler<float> rs;
+        rs.add_series(data_battery_amps);
+        rs.set_grid_series(data_battery_volt);
+        const bool have_amps = rs.run();
+        const std::vector<double> & col_amps = rs.get_column(0);
+        const std::vector<char> & has_amps = rs.get_valid(0);
+        for (unsigned int k=0; have_amps && k < data_battery_volt->size(); ++k) {
             float volt;
             double t;
             if (data_battery_volt->get_data(k, t, volt)) {
-                float amps;
-                if (data_battery_amps->get_data_at_time(t, amps)) {
+                if (has_amps[k]) {
+                    const float amps = col_amps[k];
                     float power_est_watts = volt*amps;
                     data_power->add_elem(power_est_watts, t);
                 }
@@ -1487,11 +1670,12 @@ void MavSystem::_postprocess_flightbook() {
     double t_last_landing=0.;
     unsigned int nflights=0;
     double flighttime = 0.;    
+    DataTimeseries<float>::Cursor cur_throttle(data_throttle_percent);
     for (unsigned int k=0; k<data_alt->size(); ++k) {
         float alt;
         if (data_alt->get_data(k, t, alt)) {
             float throttle;
-            if (data_throttle_percent->get_data_at_time(t, throttle)) {
+            if (cur_throttle.get_data_at_time(t, throttle)) {
                 // flying == alt > 0 && throttle > 20
                 bool seems_flying = alt > 1. && throttle > 20.f;
                 // FIXME: debounce
@@ -1528,6 +1712,7 @@ void MavSystem::postprocess() {
 
 int MavSystem::update_rel_time(uint64_t nowtime_relative_usec, bool allowjumps){
     double cand_time = nowtime_relative_usec/1E6;
+    _time_unsynced = false; // an actual timestamp
 
     // sanity check: refuse time stamps that are temporally too far apart from each other
     double diff = 0.;
@@ -1620,13 +1805,59 @@ void MavSystem::get_mavlink_stats(MavSystem::mavlink_summary_t & ret) const {
 
 // DONE
 bool MavSystem::merge_in(const MavSystem * const other) {
+    return merge_in_all(std::vector<const MavSystem*>(1, other));
+}
+
+bool MavSystem::merge_in_all(const std::vector<const MavSystem*> & others) {
+    // collect the data of all others by path, so that each of ours is merged only once
+    typedef std::map<std::string, std::vector<const Data*> > pathmap;
+    pathmap bypath;
+    for (std::vector<const MavSystem*>::const_iterator it = others.begin(); it != others.end(); ++it) {
+        for (data_accessmap::const_iterator ito = (*it)->_data_from_path.begin(); ito != (*it)->_data_from_path.end(); ++ito) {
+            const Data*const data = ito->second;
+            bypath[Data::get_fullname(data)].push_back(data);
+        }
+    }
+
     // copy data inside, the datagroup is not copied but created with our own functions again
     bool added=false;
-    for (data_accessmap::const_iterator ito = other->_data_from_path.begin(); ito != other->_data_from_path.end(); ++ito) {
-        const Data*const data = ito->second;
-        if (!_add_data(data)) {
-            _log(MSG_WARN, stringbuilder() << "WARNING: skipped data " << data->get_name() << " because it could not be merged");
-            // return false;
+    for (pathmap::const_iterator it = bypath.begin(); it != bypath.end(); ++it) {
+        if (!_add_data(it->first, it->second)) {
+            _log(MSG_WARN, stringbuilder() << "WARNING: skipped data " << it->first << " because it could not be merged");
+        } else {
+            added = true;
+        }
+    }
+    if (added) {
+        postprocess();
+        determine_absolute_time();
+    }
+    return true;
+}
+
+bool MavSystem::take_in_all(const std::vector<MavSystem*> & others) {
+    // collect the data of all others by path, and who owns the first of each
+    typedef std::map<std::string, std::vector<Data*> > pathmap;
+    pathmap bypath;
+    std::map<std::string, MavSystem*> owner;
+    for (std::vector<MavSystem*>::const_iterator it = others.begin(); it != others.end(); ++it) {
+        for (data_accessmap::const_iterator ito = (*it)->_data_from_path.begin(); ito != (*it)->_data_from_path.end(); ++ito) {
+            Data*const data = ito->second;
+            const std::string path = Data::get_fullname(data);
+            owner.insert(std::make_pair(path, *it));
+            bypath[path].push_back(data);
+        }
+    }
+
+    bool added=false;
+    for (pathmap::const_iterator it = bypath.begin(); it != bypath.end(); ++it) {
+        const Data*const mydata = _get_data<Data>(it->first);
+        if (!mydata || !mydata->is_present()) {
+            // the first one becomes ours; all others stay with their system
+            owner[it->first]->_detach_data(it->second.front());
+        }
+        if (!_take_data(it->first, it->second)) {
+            _log(MSG_WARN, stringbuilder() << "WARNING: skipped data " << it->first << " because it could not be merged");
         } else {
             added = true;
         }
@@ -1644,6 +1875,9 @@ void MavSystem::update_time_offset_guess(uint64_t nowtime_relative_usec, uint64_
 }
 
 bool MavSystem::is_absolute_time(uint64_t timestamp_usec) const {
+    // shortcut for the usual boot times: before 28.12.2000 is year 2000 or earlier in any timezone
+    if (timestamp_usec < 977961600ULL*1000000ULL) return false;
+
     // simple but effective: convert to yyyy-mm-dd; if it is earlier y2k, then assume relative time
     struct tm when = epoch_to_tm(timestamp_usec/1E6);
     when.tm_year += 1900; // because it is since 1900
@@ -1651,7 +1885,9 @@ bool MavSystem::is_absolute_time(uint64_t timestamp_usec) const {
 }
 
 void MavSystem::update_time_offset(uint64_t nowtime_relative_usec, uint64_t epoch_usec, bool allowjumps) {
-    update_rel_time(nowtime_relative_usec, allowjumps);
+    if (!_time_unsynced) { // otherwise callers can only pass a made-up relative time
+        update_rel_time(nowtime_relative_usec, allowjumps);
+    }
 
     if (epoch_usec > 0) { // sanity check
         _time_offset_raw.push_back(timeoffset_pair(nowtime_relative_usec, epoch_usec));
@@ -1659,6 +1895,170 @@ void MavSystem::update_time_offset(uint64_t nowtime_relative_usec, uint64_t epoc
 }
 
 
+/**
+ * @brief the events that track_system() only adds on change, i.e., which depend on the past
+ */
+static const char*const chunksync_events[] = {
+    "system/status", "mission/armed", "mission/stabilized", "mission/guided", "mission/manual"
+};
+
+void MavSystem::_get_latest_events(std::map<std::string, std::string> &ret) const {
+    ret.clear();
+    for (unsigned int k=0; k < sizeof(chunksync_events)/sizeof(chunksync_events[0]); ++k) {
+        const DataEvent<string>*const evt = _get_data<DataEvent<string> >(chunksync_events[k]);
+        if (evt && evt->size()) {
+            ret[chunksync_events[k]] = evt->get_latest();
+        }
+    }
+}
+
+void MavSystem::mark_chunksync(chunksync_t &mark) {
+    mark.time = _time;
+    mark.time_valid = _time_valid;
+    mark.link_throughput_bytes = _mavlink_summary._link_throughput_bytes;
+    mark.mavtype = mavtype;
+    mark.aptype = aptype;
+    _get_latest_events(mark.latest_events);
+
+    mark.data_size.clear();
+    for (data_accessmap::const_iterator it = _data_from_path.begin(); it != _data_from_path.end(); ++it) {
+        mark.data_size[it->first] = it->second->size();
+    }
+    mark.n_time_offset_raw = _time_offset_raw.size();
+    mark.mavlink_summary = _mavlink_summary;
+
+    // from here on, the time range only covers what comes after the mark
+    _time_min = _time;
+    _time_max = _time;
+}
+
+bool MavSystem::matches_chunksync(const chunksync_t &mark) const {
+    if (_time_valid != mark.time_valid || _time != mark.time) return false;
+    if (_mavlink_summary._link_throughput_bytes != mark.link_throughput_bytes) return false;
+    if (mavtype != mark.mavtype || aptype != mark.aptype) return false;
+
+    std::map<std::string, std::string> events;
+    _get_latest_events(events);
+    return events == mark.latest_events;
+}
+
+bool MavSystem::append_chunk(const MavSystem *const other, const chunksync_t &mark) {
+    if (!other || other->id != id) return false;
+
+    // check first, such that we either append all or nothing
+    for (data_accessmap::const_iterator ito = other->_data_from_path.begin(); ito != other->_data_from_path.end(); ++ito) {
+        const Data*const theirs = ito->second;
+        const Data*const mine = _get_data<Data>(ito->first);
+        if (mine && mine->get_typename() != theirs->get_typename()) {
+            _log(MSG_WARN, stringbuilder() << "(#" << id << ") cannot append data " << ito->first << " because of a type mismatch");
+            return false;
+        }
+        unsigned int first = 0;
+        std::map<std::string, unsigned int>::const_iterator itm = mark.data_size.find(ito->first);
+        if (itm != mark.data_size.end()) first = itm->second;
+        if (theirs->size() > first && !(mine ? mine : theirs)->can_append_from(theirs)) {
+            _log(MSG_WARN, stringbuilder() << "(#" << id << ") cannot append data " << ito->first);
+            return false;
+        }
+    }
+
+    bool ok = true;
+    for (data_accessmap::const_iterator ito = other->_data_from_path.begin(); ito != other->_data_from_path.end(); ++ito) {
+        const Data*const theirs = ito->second;
+        unsigned int first = 0;
+        std::map<std::string, unsigned int>::const_iterator itm = mark.data_size.find(ito->first);
+        if (itm != mark.data_size.end()) first = itm->second;
+
+        Data*mine = _get_data<Data>(ito->first);
+        if (!mine) {
+            // new item; also register empty ones, since tracking creates them
+            mine = theirs->Clone();
+            if (!mine) return false;
+            mine->clear();
+            _data_register_hierarchy(ito->first, mine);
+        }
+        if (theirs->size() > first) {
+            if (!mine->append_from(theirs, first)) {
+                _log(MSG_ERR, stringbuilder() << "(#" << id << ") could not append data " << ito->first);
+                ok = false;
+            }
+        }
+    }
+
+    // time
+    _time_offset_raw.insert(_time_offset_raw.end(), other->_time_offset_raw.begin() + mark.n_time_offset_raw,
+                            other->_time_offset_raw.end());
+    _time = other->_time;
+    _time_valid = other->_time_valid;
+    if (other->_time_min < _time_min) _time_min = other->_time_min;
+    if (other->_time_max > _time_max) _time_max = other->_time_max;
+
+    // link stats: counts accumulated after the mark
+    const mavlink_summary_t & theirs = other->_mavlink_summary;
+    _mavlink_summary.num_received += theirs.num_received - mark.mavlink_summary.num_received;
+    _mavlink_summary.num_interpreted += theirs.num_interpreted - mark.mavlink_summary.num_interpreted;
+    _mavlink_summary.num_uninterpreted += theirs.num_uninterpreted - mark.mavlink_summary.num_uninterpreted;
+    _mavlink_summary.num_error += theirs.num_error - mark.mavlink_summary.num_error;
+    _mavlink_summary._link_throughput_bytes = theirs._link_throughput_bytes;
+    _append_linkstats(theirs, mark.mavlink_summary);
+
+    // general info
+    mavtype = other->mavtype;
+    mavtype_str = other->mavtype_str;
+    aptype = other->aptype;
+    aptype_str = other->aptype_str;
+    if (other->has_been_armed) has_been_armed = true;
+
+    return ok;
+}
+
+void MavSystem::_append_linkstats(const mavlink_summary_t &theirs, const mavlink_summary_t &at_mark) {
+    for (std::vector<compstats_t>::const_iterator it = theirs.components.begin(); it != theirs.components.end(); ++it) {
+        const compstats_t & tc = *it;
+        const compstats_t*base = NULL;
+        for (std::vector<compstats_t>::const_iterator itb = at_mark.components.begin(); itb != at_mark.components.end(); ++itb) {
+            if (itb->compid == tc.compid) base = &(*itb);
+        }
+
+        const size_t ncomp = _mavlink_summary.components.size();
+        compstats_t & mc = _get_compstats(tc.compid);
+        if (_mavlink_summary.components.size() > ncomp) {
+            mc.first_seq = tc.first_seq;
+            mc.first_msgid = tc.first_msgid;
+        } else if (!base) {
+            // the other one saw the component first after the mark, so it could not compare the sequence number
+            const uint8_t gap = (uint8_t) (tc.first_seq - mc.last_seq - 1);
+            if (gap < 128) {
+                mc.seq_gaps += gap;
+                _get_msgstats(mc, tc.first_msgid).seq_gaps += gap;
+            }
+        }
+        mc.last_seq = tc.last_seq;
+        mc.seq_gaps += tc.seq_gaps - (base ? base->seq_gaps : 0);
+
+        std::vector<std::pair<unsigned int, const msgstats_t*> > tms;
+        for (unsigned int k=0; k < LINKSTATS_MSGIDS; ++k) {
+            if (tc.msgs[k].packets > 0) tms.push_back(std::make_pair(k, &tc.msgs[k]));
+        }
+        for (std::map<unsigned int, msgstats_t>::const_iterator itm = tc.msgs_ext.begin(); itm != tc.msgs_ext.end(); ++itm) {
+            tms.push_back(std::make_pair(itm->first, &itm->second));
+        }
+        for (std::vector<std::pair<unsigned int, const msgstats_t*> >::const_iterator itm = tms.begin(); itm != tms.end(); ++itm) {
+            const msgstats_t & t = *itm->second;
+            const msgstats_t*const b = base ? _find_msgstats(*base, itm->first) : NULL;
+            const unsigned long packets = t.packets - (b ? b->packets : 0);
+            if (0 == packets) continue;
+            msgstats_t & m = _get_msgstats(mc, itm->first);
+            if (0 == m.packets) m.t_first = t.t_first;
+            m.t_last = t.t_last;
+            m.packets += packets;
+            m.bytes += t.bytes - (b ? b->bytes : 0);
+            m.seq_gaps += t.seq_gaps - (b ? b->seq_gaps : 0);
+            m.parsed |= t.parsed;
+        }
+    }
+}
+
 void MavSystem::shift_time(double delay) {
     // add both to _time_offset_raw to _time_offset_guess_usec
     int64_t udelay = delay*1E6;
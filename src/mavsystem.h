@@ -31,6 +31,8 @@
 #include <ostream>
 #include <typeinfo>
 #include <set>
+#include <map>
+#include <vector>
 #include "data_timeseries.h" // FIXME: use data_timed and data_untimed
 #include "data_param.h"
 #include "data_event.h"
@@ -82,6 +84,11 @@ private:
 
     void _log(logmsgtype_e t, const std::string & str);
 
+    /**
+     * @brief latest values of those events, which are only added when they change
+     */
+    void _get_latest_events(std::map<std::string, std::string> & ret) const;
+
 #if 0
     /**
      * @brief shortcut to create new data
@@ -98,8 +105,24 @@ private:
      * @return true if data was inserted, else false
      */
     bool _add_data(const Data*const src);
+
+    /**
+     * @brief same as _add_data() for each of srcs, which all have the given path, but merged in one go
+     */
+    bool _add_data(const std::string & fullname, const std::vector<const Data*> & srcs);
+
+    /**
+     * @brief like _add_data(), but srcs are consumed. The first one is taken over if we
+     * do not have this data yet; the caller must have detached it from its system.
+     */
+    bool _take_data(const std::string & fullname, const std::vector<Data*> & srcs);
     void _del_data(Data*const src);
 
+    /**
+     * @brief remove data from the map and the hierarchy without deleting it
+     */
+    void _detach_data(Data*const src);
+
     void _data_cleanup();   
 
     /**
@@ -176,6 +199,43 @@ public:
      * TYPEDEFS
      **********************/
 
+    /**
+     * @brief for track_link_throughput
+     */
+    typedef enum  {
+        MAVLINK_INTERPRETED, ///< could be parsed, and was evaluated with track_()
+        MAVLINK_UNINTERPRETED, ///< could be parsed, but was NOT processed
+        MAVLINK_ERROR ///< problem parsing
+    } mavlink_parsed_e;
+
+    /**
+     * @brief the packets of one message id from one component
+     */
+    typedef struct {
+        unsigned long packets;
+        unsigned long bytes;    ///< including header and checksum
+        unsigned long seq_gaps; ///< packets of the component that went missing right before one of these
+        double        t_first;  ///< rel. time of the first packet [s]
+        double        t_last;   ///< rel. time of the last packet [s]
+        uint8_t       parsed;   ///< bit (1 << mavlink_parsed_e) set for what was done with them
+    } msgstats_t;
+
+    static const unsigned int LINKSTATS_MSGIDS = 256; ///< all MavLink 1 ids; higher ones (MavLink 2) go to a map
+
+    /**
+     * @brief the packets of one component of the system. The MavLink sequence number counts
+     * per component, so missing numbers are packets that went missing on the link.
+     */
+    typedef struct {
+        uint8_t       compid;
+        uint8_t       first_seq;   ///< of the first packet
+        unsigned int  first_msgid; ///< of the first packet
+        uint8_t       last_seq;    ///< of the latest packet
+        unsigned long seq_gaps;    ///< sum of msgstats_t::seq_gaps
+        msgstats_t    msgs[LINKSTATS_MSGIDS]; ///< by msgid
+        std::map<unsigned int, msgstats_t> msgs_ext; ///< msgid >= LINKSTATS_MSGIDS
+    } compstats_t;
+
     /**
      * @brief summarizing information about a mavlink connection
      */
@@ -184,20 +244,29 @@ public:
         unsigned long          num_interpreted; ///< number of messages that MavLogANalyzer did implement
         unsigned long          num_uninterpreted; ///< number of messages that MavLogAnalyzer doesn't implement, i.e., they were parsed but ignored.
         unsigned long          num_error; ///< number of broken messages (e.g., invalid CRC)        
-        std::set<unsigned int> mavlink_msgids_interpreted; ///< set of all evaluated MAVLink message IDs
-        std::set<unsigned int> mavlink_msgids_uninterpreted; ///< set of all unknown and thusly ignored MAVLink message IDs
+        std::vector<compstats_t> components; ///< per component, in the order they were seen
         // more internal stuff:
         unsigned int           _link_throughput_bytes; ///< this collects the number of bytes that were sent between two time references; so it is NOT the actual throughput
     } mavlink_summary_t;
 
     /**
-     * @brief for track_link_throughput
+     * @brief state of a system at some message, which is needed to continue with the
+     * next message. Two instances that agree on this will track the following messages
+     * the same way. Used to stitch together pieces of a log that were parsed separately.
      */
-    typedef enum  {
-        MAVLINK_INTERPRETED, ///< could be parsed, and was evaluated with track_()
-        MAVLINK_UNINTERPRETED, ///< could be parsed, but was NOT processed
-        MAVLINK_ERROR ///< problem parsing
-    } mavlink_parsed_e;
+    typedef struct chunksync_s {
+        // live state
+        double                             time;
+        bool                               time_valid;
+        unsigned int                       link_throughput_bytes;
+        unsigned int                       mavtype;
+        unsigned int                       aptype;
+        std::map<std::string, std::string> latest_events; ///< those events which are only added on change
+        // where the piece starts
+        std::map<std::string, unsigned int> data_size;
+        unsigned int                        n_time_offset_raw;
+        mavlink_summary_t                   mavlink_summary;
+    } chunksync_t;
 
     /**********************
      * FUNCTIONS
@@ -230,7 +299,7 @@ public:
     void track_radio(uint8_t rssi);
     void track_radio_droprate(float percent);
     void track_nav(float nav_roll_deg, float nav_pitch_deg, float nav_bear_deg, float tar_bear_deg, float wp_dist_m, float err_alt_m, float err_airspeed_ms, float err_xtrack_m);
-    void track_mavlink(unsigned int data_length_bytes, unsigned int msgid, mavlink_parsed_e whatwasdone);
+    void track_mavlink(unsigned int data_length_bytes, unsigned int msgid, mavlink_parsed_e whatwasdone, uint8_t compid = 0, uint8_t seq = 0);
     // FIXME: ugly, but one message can have invalid fields, so we need separate fcns for HIGHRES_IMU:
     void track_imu_highres_acc(const float acc_ms[]);
     void track_imu_highres_gyr(const float gyr_rs[]);
@@ -266,6 +335,16 @@ public:
         return data;
     }
 
+    /**
+     * @brief get or create a series once, to append many samples to it later (see get_rel_time_sec())
+     * @return NULL if something with the same name but a different type exists
+     */
+    template <typename T1>
+    DataTimeseries<T1>* bind_generic_timeseries(const std::string & fullname, const std::string &units = "") {
+        MAVSYSTEM_DATA_ITEM(DataTimeseries<T1>, data, fullname, units);
+        return data;
+    }
+
     template <typename T2>
     DataParam<T2>* track_generic_untimed(const std::string & fullname, const T2 & arg_data, const std::string &units = "") {
         MAVSYSTEM_DATA_ITEM(DataParam<T2>, data, fullname, units);
@@ -282,6 +361,15 @@ public:
         return data;
     }
 
+    /**
+     * @brief like bind_generic_timeseries(), but for events
+     */
+    template <typename T3>
+    DataEvent<T3>* bind_generic_event(const std::string & fullname, const std::string &units = "") {
+        MAVSYSTEM_DATA_ITEM(DataEvent<T3>, data, fullname, units);
+        return data;
+    }
+
     /**
      * @brief same as _get_data(), but for external use, where
      * the returned pointer is const.
@@ -330,6 +418,13 @@ public:
         return ((uint64_t)(_time * 1E6));
     }
 
+    /**
+     * @brief the time that track_*() currently uses
+     */
+    double get_rel_time_sec() const {
+        return _time;
+    }
+
     /**
      * @brief call this before you track any new message.
      */
@@ -337,6 +432,41 @@ public:
         _have_time_update = false;
     }
 
+    /**
+     * @brief forget the current time, because this instance starts in the middle of a log.
+     * No time is assumed until the next actual timestamp, which is then trusted.
+     */
+    void set_time_unsynced(void) {
+        _time_unsynced = true;
+        _time_valid = false;
+    }
+
+    /**
+     * @brief true until set_time_unsynced() was followed by an actual timestamp
+     */
+    bool is_time_unsynced(void) const {
+        return _time_unsynced;
+    }
+
+    /**
+     * @brief remember the current state, such that it can be checked with matches_chunksync()
+     * and everything thereafter can be appended to another instance with append_chunk().
+     */
+    void mark_chunksync(chunksync_t & mark);
+
+    /**
+     * @brief check whether this instance is in the state given by the mark
+     */
+    bool matches_chunksync(const chunksync_t & mark) const;
+
+    /**
+     * @brief append everything that other has tracked after its mark to this instance. Call this
+     * only if matches_chunksync(mark) is true; then the result is the same as if the messages
+     * were tracked here.
+     * @return false if the data does not fit. This instance is not modified then.
+     */
+    bool append_chunk(const MavSystem*const other, const chunksync_t & mark);
+
     /**
      * @brief use this to help correlate relative time since boot with absolute time.
      * invokes update_rel_time() with the first parameter internally
@@ -391,12 +521,29 @@ public:
         return _time_maxbackjump_sec;
     }
 
+    /**
+     * @brief writes the description of every data item, e.g., to compare two instances
+     */
+    void describe_data(std::ostream & ofs) const;
+
     /**
      * @brief returns a textual summary of the system
      * @param buf where to write the text
      */
     void get_summary(std::string &buf) const;
 
+    /**
+     * @brief writes a table of the MavLink packets per component and message id: rate,
+     * share of the bandwidth and the packets lost on the way, estimated from the sequence numbers.
+     * Writes nothing if there were no MavLink packets.
+     */
+    void describe_link(std::ostream & ofs) const;
+
+    /**
+     * @brief ids of the MavLink messages that were treated as given
+     */
+    std::set<unsigned int> get_mavlink_msgids(mavlink_parsed_e whatwasdone) const;
+
     /**     
      * @return absolute time of system boot/shutdown as unix epoch given in double with decimals
      */
@@ -422,6 +569,21 @@ public:
      */
     bool merge_in(const MavSystem *const other);
 
+    /**
+     * @brief same as merge_in() with each of others in turn, but every series is merged only
+     * once, and the derived data is only computed once at the end.
+     * @param others systems with the same id, e.g., from several logfiles
+     * @return true if successful, else false
+     */
+    bool merge_in_all(const std::vector<const MavSystem*> & others);
+
+    /**
+     * @brief same as merge_in_all(), but the data of others is moved here instead of copied.
+     * Data which we do not have yet changes its owner, series which we have take over the
+     * buffers of others where they can. Afterwards, others are incomplete and must be deleted.
+     */
+    bool take_in_all(const std::vector<MavSystem*> & others);
+
     /**
      * @brief return information about mavlink and what was ignored by MavLogAnalyzer
      * @param ret reference to variable where information is returned
@@ -443,6 +605,18 @@ public:
     bool deferredLoad;          ///< if true, the data in here is not complete and needs to be loaded when requested
 
 private:
+    /**
+     * @brief link statistics helpers
+     */
+    compstats_t & _get_compstats(uint8_t compid);
+    static msgstats_t & _get_msgstats(compstats_t & comp, unsigned int msgid);
+    static const msgstats_t* _find_msgstats(const compstats_t & comp, unsigned int msgid);
+
+    /**
+     * @brief add what the other summary counted after the mark; see append_chunk()
+     */
+    void _append_linkstats(const mavlink_summary_t & theirs, const mavlink_summary_t & at_mark);
+
     /********************************************
      *    DATA MEMBERS
      ********************************************/
@@ -458,6 +632,7 @@ private:
     double _time_maxfwdjump_sec; ///< how much seconds may pass between two data points to be regarded as connected
     double _time_maxbackjump_sec; ///< same but other direction...must be positive
     bool   _have_time_update;
+    bool   _time_unsynced; ///< see set_time_unsynced()
 
     // more data (time series, ...)
     DataGroup::groupmap mav_data_groups;  ///< hierarchy for data...you can browse through data with associative array (map)
@@ -0,0 +1,82 @@
+/**
+ * @file onboardcolumns.cpp
+ * @brief Many onboard log messages at once, stored column by column
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include "onboardcolumns.h"
+
+using namespace std;
+
+const uint16_t OnboardColumns::OTHER;
+
+void OnboardColumns::clear() {
+    for (vector<table_t>::iterator it = tables.begin(); it != tables.end(); ++it) {
+        for (vector<column_t>::iterator itc = it->columns.begin(); itc != it->columns.end(); ++itc) {
+            itc->floatdata.clear();
+            itc->intdata.clear();
+            itc->uintdata.clear();
+        }
+        it->rows = 0;
+    }
+    order.clear();
+    others.clear();
+}
+
+unsigned int OnboardColumns::get_or_add_table(const OnboardSchema *schema) {
+    // only happens once per message type, so no need for a map
+    const std::string & msgname_orig = schema->get_message_origname();
+    for (unsigned int k=0; k < tables.size(); ++k) {
+        if (tables[k].msgname_orig == msgname_orig) return k;
+    }
+    table_t t;
+    t.msgname_orig = msgname_orig;
+    t.msgname_readable = schema->get_message_name();
+    t.schema = schema;
+    t.rows = 0;
+    t.columns.resize(schema->size());
+    for (unsigned int k=0; k < schema->size(); ++k) {
+        const OnboardSchema::field_t & f = schema->get_field(k);
+        column_t & c = t.columns[k];
+        c.name = f.name;
+        c.units = f.units;
+        switch (f.type) {
+        case OnboardSchema::FIELD_INT:  c.type = COL_INT; break;
+        case OnboardSchema::FIELD_UINT: c.type = COL_UINT; break;
+        default:                        c.type = COL_FLOAT; break;
+        }
+    }
+    tables.push_back(t);
+    return tables.size() - 1;
+}
+
+void OnboardColumns::get_row(unsigned int table, unsigned int row, OnboardData &d) const {
+    const table_t & t = tables[table];
+    d.reset(t.schema);
+    for (unsigned int k=0; k < t.columns.size(); ++k) {
+        const column_t & c = t.columns[k];
+        switch (c.type) {
+        case COL_FLOAT: d.set_float(k, c.floatdata[row]); break;
+        case COL_INT:   d.set_int(k, c.intdata[row]); break;
+        case COL_UINT:  d.set_uint(k, c.uintdata[row]); break;
+        }
+    }
+    d._valid = true;
+}
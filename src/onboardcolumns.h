@@ -0,0 +1,119 @@
+/**
+ * @file onboardcolumns.h
+ * @brief Many onboard log messages at once, stored column by column
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef ONBOARDCOLUMNS_H
+#define ONBOARDCOLUMNS_H
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include "onboarddata.h"
+
+/**
+ * Parsers which can decode without building an OnboardData per message fill this
+ * (see OnboardLogParser::get_columns()). Each message type gets a table, where every field
+ * of its OnboardSchema is a column of the same type. Messages which do not fit into a table
+ * (e.g., text) are kept as OnboardData. The order of all messages is remembered, since the
+ * time base of the scenario depends on it.
+ *
+ * Use the same instance for all batches of a log: clear() drops the rows, but keeps the
+ * tables and the memory, so that steady-state parsing does not allocate.
+ */
+class OnboardColumns {
+public:
+    typedef enum {
+        COL_FLOAT, ///< like OnboardSchema::FIELD_FLOAT
+        COL_INT,   ///< like OnboardSchema::FIELD_INT
+        COL_UINT   ///< like OnboardSchema::FIELD_UINT
+    } coltype_e;
+
+    /**
+     * @brief one field of a message type. Only the vector matching the type is used.
+     */
+    typedef struct column_s {
+        std::string           name;
+        coltype_e             type;
+        std::string           units;  ///< if the log tells, else empty
+        std::vector<float>    floatdata;
+        std::vector<int64_t>  intdata;
+        std::vector<uint64_t> uintdata;
+    } column_t;
+
+    /**
+     * @brief all messages of one type
+     */
+    typedef struct table_s {
+        std::string           msgname_orig;     ///< as in OnboardSchema
+        std::string           msgname_readable; ///< as in OnboardSchema
+        const OnboardSchema*  schema;           ///< the columns are its fields, in order
+        std::vector<column_t> columns;
+        unsigned int          rows;
+    } table_t;
+
+    static const uint16_t OTHER = 0xFFFF; ///< in order: the message is the next one in others
+
+    OnboardColumns() {}
+
+    /**
+     * @brief drop all messages, but keep tables and memory
+     */
+    void clear(void);
+
+    /**
+     * @brief find a table by message name, or add an empty one with a column for each field
+     * @param schema must not have strings, and must live as long as the table is used
+     * @return index into tables
+     */
+    unsigned int get_or_add_table(const OnboardSchema*schema);
+
+    /**
+     * @brief turn one row back into a message
+     * @param d is overwritten
+     */
+    void get_row(unsigned int table, unsigned int row, OnboardData & d) const;
+
+    /**
+     * @brief what a column of given type is in OnboardSchema
+     */
+    static OnboardSchema::fieldtype_e get_field_type(coltype_e type) {
+        switch (type) {
+        case COL_INT:  return OnboardSchema::FIELD_INT;
+        case COL_UINT: return OnboardSchema::FIELD_UINT;
+        default:       return OnboardSchema::FIELD_FLOAT;
+        }
+    }
+
+    /**
+     * @brief number of messages
+     */
+    unsigned int size(void) const { return order.size(); }
+
+    /****************************************
+     *     DATA MEMBERS
+     ****************************************/
+    std::vector<table_t>     tables;
+    std::vector<uint16_t>    order;  ///< table of each message as in the log, or OTHER
+    std::vector<OnboardData> others; ///< messages that are not in a table, in order
+};
+
+#endif // ONBOARDCOLUMNS_H
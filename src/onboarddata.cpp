@@ -25,3 +25,64 @@
 
 
 
+
+#include <string.h>
+
+using namespace std;
+
+const std::string OnboardData::_none;
+
+unsigned int OnboardSchema::add_field(const std::string &name, fieldtype_e type, const std::string &units) {
+    const int existing = find_field(name.c_str(), type);
+    if (existing >= 0) return existing; // like a map: the last value wins
+
+    field_t f;
+    f.name = name;
+    f.type = type;
+    f.units = units;
+    const unsigned int id = _fields.size();
+    _fields.push_back(f);
+
+    // keep the order sorted
+    vector<unsigned int>::iterator it = _order.begin();
+    while (it != _order.end() && (_fields[*it].type < type || (_fields[*it].type == type && _fields[*it].name < name))) {
+        ++it;
+    }
+    _order.insert(it, id);
+    return id;
+}
+
+int OnboardSchema::find_field(const char *name, fieldtype_e type) const {
+    for (unsigned int k=0; k < _fields.size(); ++k) {
+        if (_fields[k].type == type && _fields[k].name == name) return k;
+    }
+    return -1;
+}
+
+void OnboardData::reset(const OnboardSchema *schema) {
+    _valid = false;
+    _schema = schema;
+    const unsigned int n = schema ? schema->size() : 0;
+    if (_values.size() < n) {
+        _values.resize(n);
+        _strings.resize(n);
+        _present.resize(n);
+    }
+    if (n > 0) memset(&_present[0], 0, n);
+}
+
+bool OnboardData::find_uint(const char *name, uint64_t &val) const {
+    if (!_schema) return false;
+    const int id = _schema->find_field(name, OnboardSchema::FIELD_UINT);
+    if (id < 0 || !has(id)) return false;
+    val = get_uint(id);
+    return true;
+}
+
+bool OnboardData::find_float(const char *name, float &val) const {
+    if (!_schema) return false;
+    const int id = _schema->find_field(name, OnboardSchema::FIELD_FLOAT);
+    if (id < 0 || !has(id)) return false;
+    val = get_float(id);
+    return true;
+}
@@ -26,26 +26,88 @@
 
 #include <inttypes.h>
 #include <string>
-#include <map>
+#include <vector>
 
+/**
+ * @brief describes one message type: its names, and name, type and id of each field.
+ * A parser makes one per message type and keeps it; every OnboardData of that type
+ * refers to it, and only carries the values.
+ */
+class OnboardSchema
+{
+public:
+    /**
+     * @brief the scenario takes the fields in this order, then by name
+     */
+    typedef enum {
+        FIELD_BOOL,
+        FIELD_INT,    ///< int64_t
+        FIELD_UINT,   ///< uint64_t
+        FIELD_FLOAT,
+        FIELD_STRING
+    } fieldtype_e;
+
+    typedef struct {
+        std::string name;
+        fieldtype_e type;
+        std::string units; ///< if the log tells, else empty
+    } field_t;
+
+    OnboardSchema(const std::string & msgname_orig = "", const std::string & msgname_readable = "") :
+        _msgname_orig(msgname_orig), _msgname_readable(msgname_readable) {}
+
+    /**
+     * @brief add a field, unless there is one with the same name and type already
+     * @return id of the field, i.e., where its value is in OnboardData
+     */
+    unsigned int add_field(const std::string & name, fieldtype_e type, const std::string & units = "");
+
+    /**
+     * @return id of the field, or -1
+     */
+    int find_field(const char*name, fieldtype_e type) const;
+
+    void set_units(unsigned int id, const std::string & units) { _fields[id].units = units; }
+
+    const std::string & get_message_origname(void) const { return _msgname_orig; }
+    const std::string & get_message_name(void) const { return _msgname_readable; }
+
+    unsigned int size(void) const { return _fields.size(); }
+    bool empty(void) const { return _fields.empty(); }
+    const field_t & get_field(unsigned int id) const { return _fields[id]; }
+
+    /**
+     * @return ids of all fields, sorted by type and name
+     */
+    const std::vector<unsigned int> & get_order(void) const { return _order; }
 
+private:
+    std::string  _msgname_orig;  ///< msg name as in the log, e.g. "CTUN"
+    std::string  _msgname_readable; ///< a more readable string, e.g. "Controller Tuning"
+    std::vector<field_t>      _fields; ///< by id
+    std::vector<unsigned int> _order;
+};
+
+/**
+ * @brief one message from an onboard log: a schema and a value per field.
+ * Reuse the same instance for all messages; once it has seen the largest message type,
+ * it does not allocate anymore.
+ */
 class OnboardData
 {
 public:
 
-    /**********************************
-     *  TYPES
-     **********************************/
-    typedef std::map<std::string, float> floatdata_t;
-    typedef std::map<std::string, int64_t> intdata_t;
-    typedef std::map<std::string, uint64_t>  uintdata_t;
-    typedef std::map<std::string, bool> booldata_t;
-    typedef std::map<std::string, std::string> stringdata_t;
-
     /**********************************
      *  METHODS
      **********************************/
-    OnboardData() : _valid(false) {}
+    OnboardData() : _valid(false), _schema(NULL) {}
+
+    /**
+     * @brief start a new message with given schema, where no field is set yet. Invalid until
+     * the parser says otherwise.
+     * @param schema must live as long as this message is used
+     */
+    void reset(const OnboardSchema*schema);
 
     /**
      * @brief only if this returns true, this class carries actual data
@@ -53,23 +115,57 @@ public:
      */
     bool is_valid(void) const { return _valid; }
 
+    /**
+     * @return schema, or NULL if there is no message
+     */
+    const OnboardSchema* get_schema(void) const { return _schema; }
+
     /**
      * @brief returns a string describing the collection of data this class contains
      * @return string
      */
-    std::string get_message_origname(void) const { return _msgname_orig; }
-    std::string get_message_name(void) const { return _msgname_readable; }
+    const std::string & get_message_origname(void) const { return _schema ? _schema->get_message_origname() : _none; }
+    const std::string & get_message_name(void) const { return _schema ? _schema->get_message_name() : _none; }
 
     /**
-     * @brief access the data
-     * @return
+     * @brief whether the field with given id is in this message. Fields can be missing
+     * if the message was shorter than its format.
+     */
+    bool has(unsigned int id) const { return 0 != _present[id]; }
+
+    /**
+     * @brief access the data by field id. Only the one matching the type of the field is valid.
      */
-    const floatdata_t & get_floatdata(void) const { return _float_data; }
-    const intdata_t & get_intdata(void) const { return _int_data; }
-    const uintdata_t & get_uintdata(void) const { return _uint_data; }
-    const booldata_t & get_booldata(void) const { return _bool_data; }
-    const stringdata_t & get_stringdata(void) const { return _string_data; }
+    bool get_bool(unsigned int id) const { return _values[id].b; }
+    int64_t get_int(unsigned int id) const { return _values[id].i; }
+    uint64_t get_uint(unsigned int id) const { return _values[id].u; }
+    float get_float(unsigned int id) const { return _values[id].f; }
+    const std::string & get_string(unsigned int id) const { return _strings[id]; }
 
+    /**
+     * @return units of the given field, or empty if unknown
+     */
+    const std::string & get_units(unsigned int id) const { return _schema->get_field(id).units; }
+
+    /**
+     * @brief look up a field by name; for the few fields which are needed by name
+     * @return true if the message has it
+     */
+    bool find_uint(const char*name, uint64_t & val) const;
+    bool find_float(const char*name, float & val) const;
+
+    /**
+     * @brief set the data by field id
+     */
+    void set_bool(unsigned int id, bool v) { _values[id].b = v; _present[id] = 1; }
+    void set_int(unsigned int id, int64_t v) { _values[id].i = v; _present[id] = 1; }
+    void set_uint(unsigned int id, uint64_t v) { _values[id].u = v; _present[id] = 1; }
+    void set_float(unsigned int id, float v) { _values[id].f = v; _present[id] = 1; }
+
+    /**
+     * @return the string to be assigned; keeps its memory from earlier messages
+     */
+    std::string & set_string(unsigned int id) { _present[id] = 1; return _strings[id]; }
 
 public:
     /**********************************
@@ -77,16 +173,21 @@ public:
      **********************************/
     bool _valid;
 
-    std::string  _msgname_orig;  ///< msg name as in the log, e.g. "CTUN"
-    std::string  _msgname_readable; ///< a more readable string, e.g. "Controller Tuning"
+private:
+    typedef union {
+        bool     b;
+        int64_t  i;
+        uint64_t u;
+        float    f;
+    } value_t;
 
-    // colums by type. first=col name, second=value
-    floatdata_t  _float_data;
-    intdata_t    _int_data;
-    uintdata_t   _uint_data;
-    booldata_t   _bool_data;
-    stringdata_t _string_data;
+    static const std::string _none;
 
+    const OnboardSchema*     _schema;
+    // by field id. These only grow, so that nothing is allocated once they are large enough
+    std::vector<value_t>     _values;
+    std::vector<std::string> _strings;
+    std::vector<uint8_t>     _present;
 };
 
 #endif // ONBOARDDATA_H
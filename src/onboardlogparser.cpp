@@ -23,6 +23,27 @@
 
 #include "onboardlogparser.h"
 
+OnboardSchema* OnboardLogParser::_add_schema(const std::string &msgname_orig) {
+    _schemas.push_back(OnboardSchema(msgname_orig, _make_readable_name(msgname_orig)));
+    return &_schemas.back();
+}
+
+OnboardSchema& OnboardLogParser::_get_keyed_schema(const std::string &msgname_orig, const std::string &key) {
+    _schema_key.assign(msgname_orig);
+    _schema_key.push_back('\0');
+    _schema_key.append(key);
+    std::map<std::string, OnboardSchema>::iterator it = _keyed_schemas.find(_schema_key);
+    if (it == _keyed_schemas.end()) {
+        it = _keyed_schemas.insert(std::make_pair(_schema_key, OnboardSchema(msgname_orig, _make_readable_name(msgname_orig)))).first;
+    }
+    return it->second;
+}
+
+void OnboardLogParser::_clear_schemas(void) {
+    _schemas.clear();
+    _keyed_schemas.clear();
+}
+
 /**
  * @brief assign a more readable name to the messages, s.g. "CTUN" becomes "Controller Tuning"
  * @param msgname original name as in log
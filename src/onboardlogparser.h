@@ -24,12 +24,16 @@
 #ifndef ONBOARDLOGPARSER_H
 #define ONBOARDLOGPARSER_H
 
+#include <inttypes.h>
 #include <string>
 #include "onboarddata.h"
+#include "onboardcolumns.h"
 #include "logger.h"
 
 #include <vector>
 #include <string>
+#include <deque>
+#include <map>
 
 /**
  * @brief The OnboardLogParser class
@@ -51,10 +55,35 @@ public:
 
     /**
      * @brief get_data
-     * @return class holding one data item. Use has_more_data before,
-     * to see whether this returs a valid result
+     * @param ret overwritten with the next data item. Use has_more_data before, and
+     * is_valid() after, to see whether this is a valid result. Pass the same object every
+     * time, so that its memory is reused. It refers to a schema of this parser, hence it
+     * is only valid as long as the parser lives and has not loaded another file.
      */
-    virtual OnboardData get_data(void) = 0;
+    virtual void get_data(OnboardData & ret) = 0;
+
+    /**
+     * @brief whether this parser implements get_columns()
+     */
+    virtual bool has_columns(void) const { return false; }
+
+    /**
+     * @brief decode the next messages at once into columns, instead of one by one with get_data().
+     * Pass the same object every time and call clear() in between.
+     * @param max_msgs stop after this many messages
+     * @return false on error or if not supported
+     */
+    virtual bool get_columns(OnboardColumns & /*cols*/, unsigned int /*max_msgs*/) { return false; }
+
+    /**
+     * @brief parsers which can decode with several threads use up to this many
+     */
+    virtual void set_threads(unsigned int /*nthreads*/) {}
+
+    /**
+     * @brief how far parsing has progressed, in bytes of the file. For progress bars.
+     */
+    virtual uint64_t get_bytes_consumed(void) const { return 0; }
 
     /**
      * @return  name of the underlying parser
@@ -86,6 +115,27 @@ public:
 
 protected:
     std::string _make_readable_name(std::string msgname);
+
+    /**
+     * @brief a new schema for a message type, owned by the parser
+     */
+    OnboardSchema* _add_schema(const std::string & msgname_orig);
+
+    /**
+     * @brief the schema for messages whose fields are only known from the data, e.g. PARM
+     * with the name of the parameter. It has no fields the first time a key is seen.
+     */
+    OnboardSchema& _get_keyed_schema(const std::string & msgname_orig, const std::string & key);
+
+    /**
+     * @brief forget all schemas; for Load()
+     */
+    void _clear_schemas(void);
+
+private:
+    std::deque<OnboardSchema>            _schemas; ///< deque, because the data refers to them
+    std::map<std::string, OnboardSchema> _keyed_schemas;
+    std::string                          _schema_key; ///< scratch
 };
 
 #endif // ONBOARDLOGPARSER_H
@@ -23,203 +23,342 @@
  */
 
 #include <iostream>
+#include <string.h>
 #include "stringfun.h"
 #include "onboardlogparser_apm.h"
 
+using namespace std;
+
+const int OnboardLogParserAPM::TABLE_UNKNOWN;
+const int OnboardLogParserAPM::TABLE_NONE;
+
 const std::string &OnboardLogParserAPM::get_filename(void) const {
     return _filename;
 }
 
 OnboardLogParserAPM::~OnboardLogParserAPM() {
+    delete _src;
 }
 
-OnboardLogParserAPM::OnboardLogParserAPM() : _filename(""), _logchannel(NULL) {
-    valid = _parser.init(_filename.c_str());
+OnboardLogParserAPM::OnboardLogParserAPM() : _filename(""), _logchannel(NULL), _srctype(ByteSource::SOURCE_AUTO),
+    _chunksize(ByteSource::DEFAULT_CHUNKSIZE), _src(NULL), _tok(field_terminator, line_terminator),
+    _buckets(NUM_BUCKETS, -1) {
+}
 
-    if (valid) {
-        _parser.set_enclosed_char(enclosure_char, ENCLOSURE_NONE);
-        _parser.set_field_term_char(field_terminator);
-        _parser.set_line_term_char(line_terminator);
+unsigned int OnboardLogParserAPM::_hash(const field_t &name) {
+    unsigned int h = 0;
+    for (unsigned int k=0; k < name.len; ++k) {
+        h = h*31 + (unsigned char) name.str[k];
     }
+    return h % NUM_BUCKETS;
+}
 
+/**
+ * @brief look up the format of a line
+ * @param name trimmed
+ * @return index in _formats, or -1
+ */
+int OnboardLogParserAPM::_find_format(const field_t &name) const {
+    for (int i = _buckets[_hash(name)]; i >= 0; i = _formats[i].next) {
+        const string & n = _formats[i].name;
+        if (n.size() == name.len && 0 == memcmp(n.data(), name.str, name.len)) return i;
+    }
+    return -1;
 }
 
 /**
- * @brief parse a csv row into a class.
- * @param row data is read from here.
- * @param data class instance. Data is written to here.
- * @return true if parsed, else false
+ * @brief how a field of given type goes into OnboardData
+ * @return false if it is kept as string
  */
-bool OnboardLogParserAPM::_parse_message(const csv_row & row, OnboardData & ret) {
+bool OnboardLogParserAPM::_get_coltype(char type, OnboardColumns::coltype_e &coltype) {
+    switch (type) {
+    case 'i': // int32_t
+    case 'h': // int16_t
+    case 'b': // int8_t
+        coltype = OnboardColumns::COL_INT;
+        return true;
 
-    string msgname = row[0];
-    string_trim(msgname);
+    case 'I': // uint32_t
+    case 'H': // uint16_t
+    case 'B': // uint8_t
+    case 'Q': // uint64_t
+        coltype = OnboardColumns::COL_UINT;
+        return true;
 
-    ret._msgname_orig = msgname; // original name can be used better to compare the message with the spec
-    string_trim(ret._msgname_orig);
-    ret._msgname_readable = _make_readable_name(ret._msgname_orig); // .. but to the user we want to show pretty names
+    case 'L': // uint32_t -> but is given as float
+    case 'E': // uint32_t*100 -> but is given as float
+    case 'e': // int32_t*100 -> but is given as float
+    case 'C': // uint16*100 -> but is given as float
+    case 'c': // int16*100 -> but is given as float
+    case 'f': // float
+        coltype = OnboardColumns::COL_FLOAT;
+        return true;
 
-    map<string, lineformat>::const_iterator rit = _formats.find(msgname);
-    if (rit == _formats.end()) return false;
+    case 'M': // mode-string
+    case 'Z': // string
+    case 'N': // char[16]
+    default:
+        // unknown datatypes are mapped as strings
+        return false;
+    }
+}
 
-    /************
-     * FOUND IT!
-     ************/    
+OnboardSchema::fieldtype_e OnboardLogParserAPM::_get_field_type(const colformat &c) {
+    return c.is_string ? OnboardSchema::FIELD_STRING : OnboardColumns::get_field_type(c.coltype);
+}
 
-    /*
-     * for parameters it is is different: [1]=name, [2]=value. We must not store "name" in
-     * strings and "value" in float, but only in float and use [1] as the name
-     */
-    const bool is_param = (msgname.compare("PARM")==0);
-    unsigned int k0 = is_param ? 2 : 1;
-
-    if (row.size() > 1) {
-        for (unsigned int k=k0; k<row.size(); k++) {
-            const lineformat f = rit->second;
-            unsigned int colidx = k-1;
-
-            if (colidx >= f.size()) break;
-
-            const colformat c = f[colidx];
-            string colname;
-            if (is_param) {
-                colname = row[1];
-            } else {
-                colname = c.first;
-            }
-            string_trim(colname);
-
-            // demux datatype
-            switch (c.second) {
-            case 'i': // int32_t
-            case 'h': // int16_t
-            case 'b': // int8_t
-                ret._int_data[colname] = atoi(row[k].c_str());
-                break;
+inline void OnboardLogParserAPM::_set_field(const colformat &c, const field_t &f, unsigned int id, OnboardData &ret) {
+    // demux datatype
+    if (c.is_string) {
+        ret.set_string(id).assign(f.str, f.len);
+        return;
+    }
+    switch (c.coltype) {
+    case OnboardColumns::COL_INT:
+        ret.set_int(id, (int32_t) TextTokenizer::to_int(f));
+        break;
+    case OnboardColumns::COL_UINT:
+        if (c.type == 'Q') {
+            ret.set_uint(id, TextTokenizer::to_uint(f));
+        } else {
+            ret.set_uint(id, (uint32_t) TextTokenizer::to_uint(f));
+        }
+        break;
+    case OnboardColumns::COL_FLOAT:
+        ret.set_float(id, (float) TextTokenizer::to_double(f));
+        break;
+    }
+}
 
-            case 'I': // uint32_t
-            case 'H': // uint16_t
-            case 'B': // uint8_t
-                ret._uint_data[colname] = ((unsigned int) atoll(row[k].c_str()));
-                break;
+/**
+ * @brief parse the current line into a class.
+ * @param fmt format of the line
+ * @param data class instance. Data is written to here.
+ * @return true if parsed, else false
+ */
+bool OnboardLogParserAPM::_parse_message(const lineformat & fmt, OnboardData & ret) {
+    if (fmt.is_param) return _parse_param(fmt, ret);
 
-            case 'L': // uint32_t -> but is given as float
-            case 'E': // uint32_t*100 -> but is given as float
-            case 'e': // int32_t*100 -> but is given as float
-            case 'C': // uint16*100 -> but is given as float
-            case 'c': // int16*100 -> but is given as float
-            case 'f': // float
-                ret._float_data[colname] = atof(row[k].c_str());
-                break;
+    ret.reset(fmt.schema);
+    for (unsigned int k=1; k<_row.size(); k++) {
+        const unsigned int colidx = k-1;
+        if (colidx >= fmt.columns.size()) break; // shorter lines just miss the last fields
+        const colformat & c = fmt.columns[colidx];
+        _set_field(c, _row[k], c.id, ret);
+    }
+    return true;
+}
 
-            case 'Q':
-                ret._uint_data[colname] = ((u_int64_t) atoll(row[k].c_str()));
-                break;
+/**
+ * @brief for parameters it is is different: [1]=name, [2]=value. We must not store "name" in
+ * strings and "value" in float, but only in float and use [1] as the name
+ */
+bool OnboardLogParserAPM::_parse_param(const lineformat &fmt, OnboardData &ret) {
+    const std::string paramname = (_row.size() > 1) ? TextTokenizer::to_string(TextTokenizer::trim(_row[1])) : "";
+    OnboardSchema & schema = _get_keyed_schema(fmt.name, paramname);
 
-            case 'M': // mode-string
-            case 'Z': // string
-            case 'N': // char[16]
-            default:
-                // unknown datatypes are mapped as strings
-                ret._string_data[colname] = row[k];
-                break;
-            }
-        }
+    // the first time, the fields have to be added before the values can go in
+    const unsigned int k0 = 2;
+    for (unsigned int k=k0; k<_row.size() && k-1 < fmt.columns.size(); k++) {
+        const colformat & c = fmt.columns[k-1];
+        schema.add_field(paramname, _get_field_type(c));
+    }
+    ret.reset(&schema);
+    for (unsigned int k=k0; k<_row.size() && k-1 < fmt.columns.size(); k++) {
+        const colformat & c = fmt.columns[k-1];
+        const int id = schema.find_field(paramname.c_str(), _get_field_type(c));
+        _set_field(c, _row[k], id, ret);
     }
     return true;
 }
 
-OnboardData OnboardLogParserAPM::get_data(void) {
-    OnboardData ret;
+/**
+ * @brief compile the current FMT line into a lineformat. A later FMT with the same
+ * name replaces the earlier one.
+ */
+void OnboardLogParserAPM::_handle_fmt(void) {
+    // these rows give column headers and data types. Do not return anything, but store it internally.
+    // a line is formatted as follows
+    // 0 -> FMT
+    // 1 -> message ID
+    // 2 -> message/row length
+    // 3 -> message/row name
+    // 4 -> data types for fields, encoded as format characters:
+    /*
+        +Format characters in the format string for binary log messages
+        + b : int8_t -- OK
+        + B : uint8_t -- OK
+        + h : int16_t -- OK
+        + H : uint16_t -- OK
+        + i : int32_t -- OK
+        + I : uint32_t -- OK
+        + f : float -- OK
+        + N : char[16] -- OK
+        + c : int16_t * 100 -- OK
+        + C : uint16_t * 100 -- OK
+        + e : int32_t * 100 -- OK
+        + E : uint32_t * 100
+        + L : uint32_t latitude/longitude
+        + Z : string (null-terminated?)
+    */
+    // 5+ -> labels for fields
+
+    if (_row.size() < 5) return;
+
+    string formats = TextTokenizer::to_string(_row[4]);
+    string_trim(formats, true);
+
+    const field_t rowname = TextTokenizer::trim(_row[3]);
+    lineformat lf;
+    lf.name = TextTokenizer::to_string(rowname);
+    lf.is_param = (lf.name.compare("PARM")==0);
+    lf.schema = lf.is_param ? NULL : _add_schema(lf.name);
+    lf.columnar = !lf.is_param;
+    lf.table = TABLE_UNKNOWN;
+    lf.next = -1;
+    for (unsigned int k=5; k<_row.size(); k++) { // labels of fields in message
+        colformat cf;
+        cf.name = TextTokenizer::to_string(TextTokenizer::trim(_row[k]));
+        cf.type = (k-5 < formats.size()) ? formats[k-5] : 0;
+        cf.is_string = !_get_coltype(cf.type, cf.coltype);
+        cf.id = -1;
+        if (lf.schema) {
+            cf.id = lf.schema->add_field(cf.name, _get_field_type(cf));
+        }
+        if (cf.is_string) lf.columnar = false;
+        for (unsigned int j=0; j < lf.columns.size(); ++j) {
+            if (lf.columns[j].name == cf.name) lf.columnar = false;
+        }
+        lf.columns.push_back(cf);
+    }
 
-    csv_row row = _parser.get_row();
-    // now row is a vector<string>
-    if (row.empty()) {
-        return ret;
+    const int i = _find_format(rowname);
+    if (i >= 0) {
+        lf.next = _formats[i].next;
+        _formats[i] = lf;
+    } else {
+        const unsigned int h = _hash(rowname);
+        lf.next = _buckets[h];
+        _buckets[h] = _formats.size();
+        _formats.push_back(lf);
+    }
+}
+
+void OnboardLogParserAPM::get_data(OnboardData & ret) {
+    ret.reset(NULL);
+    if (!valid || !_tok.next_line(_row)) {
+        return;
     }
 
     /*
      * first look up the type of data, then use polymorphism
      * to create the right class to return
      */
-    if (row[0].compare("FMT")==0) {
-        // these rows give column headers and data types. Do not return anything, but store it internally.
-        // a line is formatted as follows
-        // 0 -> FMT
-        // 1 -> message ID
-        // 2 -> message/row length
-        // 3 -> message/row name
-        // 4 -> data types for fields, encoded as format characters:
-        /*
-            +Format characters in the format string for binary log messages
-            + b : int8_t -- OK
-            + B : uint8_t -- OK
-            + h : int16_t -- OK
-            + H : uint16_t -- OK
-            + i : int32_t -- OK
-            + I : uint32_t -- OK
-            + f : float -- OK
-            + N : char[16] -- OK
-            + c : int16_t * 100 -- OK
-            + C : uint16_t * 100 -- OK
-            + e : int32_t * 100 -- OK
-            + E : uint32_t * 100
-            + L : uint32_t latitude/longitude
-            + Z : string (null-terminated?)
-        */
-        // 5+ -> labels for fields
-
-        if (row.size() < 5) return ret;
-
-        string formats = row[4];
-        string_trim(formats, true);
-
-        string rowname = row[3];
-        string_trim(rowname);
-        lineformat lf;
-        if (row.size() > 5) { // labels of fields in message
-            for (unsigned int k=5; k<row.size(); k++) {
-                colformat cf;
-                string colname = row[k]; string_trim(colname);
-                const string typespec = formats.substr(k-5,1);
-                const char typechar = typespec.c_str()[0];
-                cf = make_pair(colname, typechar);
-                lf.push_back(cf);
-            }
-        }
-        _formats[rowname] = lf;
-        return ret;
+    if (TextTokenizer::equals(_row[0], "FMT")) {
+        _handle_fmt();
+        return;
     } else {
         /*
          * Now all the rest here are rows which are described by FMT.
          * All we do is demux them into vectors of their respective data
          * types and label them according to column names.
          */
-        ret._valid = _parse_message(row, ret);
+        const int i = _find_format(TextTokenizer::trim(_row[0]));
+        if (i >= 0) {
+            ret._valid = _parse_message(_formats[i], ret);
+        }
     }
     // -- END
     if (!ret.is_valid()) {
-        std::cerr << "OnboardLogParserAPM: unrecognized data row: " << row[0] << std::endl;
+        std::cerr << "OnboardLogParserAPM: unrecognized data row: " << TextTokenizer::to_string(_row[0]) << std::endl;
+    }
+}
+
+int OnboardLogParserAPM::_get_table(lineformat &fmt, OnboardColumns &cols) {
+    if (TABLE_UNKNOWN != fmt.table) return fmt.table;
+
+    int t = TABLE_NONE;
+    if (fmt.columnar) {
+        t = cols.get_or_add_table(fmt.schema);
+        const OnboardColumns::table_t & tab = cols.tables[t];
+        // a redefined format with the same name must look the same
+        bool same = (tab.columns.size() == fmt.columns.size()) && t < (int)OnboardColumns::OTHER;
+        for (unsigned int k=0; same && k < fmt.columns.size(); ++k) {
+            same = tab.columns[k].name == fmt.columns[k].name && tab.columns[k].type == fmt.columns[k].coltype;
+        }
+        if (!same) t = TABLE_NONE;
     }
-    return ret;
+    fmt.table = t;
+    return t;
+}
+
+bool OnboardLogParserAPM::get_columns(OnboardColumns &cols, unsigned int max_msgs) {
+    if (!valid) return false;
+
+    unsigned int n = 0;
+    while (n < max_msgs && _tok.next_line(_row)) {
+        if (TextTokenizer::equals(_row[0], "FMT")) {
+            _handle_fmt();
+            continue;
+        }
+        const int i = _find_format(TextTokenizer::trim(_row[0]));
+        if (i < 0) {
+            std::cerr << "OnboardLogParserAPM: unrecognized data row: " << TextTokenizer::to_string(_row[0]) << std::endl;
+            continue;
+        }
+        lineformat & fmt = _formats[i];
+        const int t = _get_table(fmt, cols);
+        if (t < 0 || _row.size() <= fmt.columns.size()) {
+            // rare (or short lines), so these stay as they are
+            _other._valid = _parse_message(fmt, _other);
+            cols.others.push_back(_other);
+            cols.order.push_back(OnboardColumns::OTHER);
+            n++;
+            continue;
+        }
+
+        OnboardColumns::table_t & tab = cols.tables[t];
+        for (unsigned int k=0; k < fmt.columns.size(); ++k) {
+            const field_t & f = _row[k+1];
+            OnboardColumns::column_t & c = tab.columns[k];
+            switch (c.type) {
+            case OnboardColumns::COL_INT:
+                c.intdata.push_back((int32_t) TextTokenizer::to_int(f));
+                break;
+            case OnboardColumns::COL_UINT:
+                if (fmt.columns[k].type == 'Q') {
+                    c.uintdata.push_back(TextTokenizer::to_uint(f));
+                } else {
+                    c.uintdata.push_back((uint32_t) TextTokenizer::to_uint(f));
+                }
+                break;
+            case OnboardColumns::COL_FLOAT:
+                c.floatdata.push_back((float) TextTokenizer::to_double(f));
+                break;
+            }
+        }
+        tab.rows++;
+        cols.order.push_back((uint16_t) t);
+        n++;
+    }
+    return valid;
 }
 
 bool OnboardLogParserAPM::has_more_data(void) {
     if (!valid) return false;
-    return _parser.has_more_rows();
+    return !_tok.at_end();
 }
 
 bool OnboardLogParserAPM::Load (std::string filename, Logger::logchannel * ch) {
     // initialize buffer
     _filename = filename;
     _logchannel = ch;
-
-    valid = _parser.init(_filename.c_str());
-
-    if (valid) {
-        _parser.set_enclosed_char(enclosure_char, ENCLOSURE_NONE);
-        _parser.set_field_term_char(field_terminator);
-        _parser.set_line_term_char(line_terminator);
-    }
+    delete _src;
+    _src = ByteSource::open(filename, _srctype, _chunksize);
+    _tok.reset(_src);
+    _formats.clear();
+    _buckets.assign(NUM_BUCKETS, -1);
+    _clear_schemas();
+    valid = _src->valid;
     return valid;
 }
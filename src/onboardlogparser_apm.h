@@ -30,12 +30,16 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <string>
-#include <csv_parser/csv_parser.hpp>
 #include "onboardlogparser.h"
+#include "bytesource.h"
+#include "texttokenizer.h"
 #include "logger.h"
 
-class OnboardData; ///< forward decl
-
+/**
+ * @brief The lines are split in place by a TextTokenizer on the mmap'd file. Each FMT line
+ * is compiled once into a lineformat, so that the other lines only need a lookup of their
+ * name and a conversion of each field.
+ */
 class OnboardLogParserAPM : public OnboardLogParser
 {
 public:   
@@ -51,16 +55,31 @@ public:
     bool has_more_data(void);
 
     // implements OnboardLogParser::get_data
-    OnboardData get_data(void);
+    void get_data(OnboardData & ret);
+
+    // implements OnboardLogParser::get_columns
+    bool has_columns(void) const { return true; }
+    bool get_columns(OnboardColumns & cols, unsigned int max_msgs);
 
     static std::string get_extension(void) { return "log"; }
 
     // implement super
     std::string get_parser_name(void) const { return "apm"; }
 
+    // implement super
+    uint64_t get_bytes_consumed(void) const { return _src ? _src->get_position() : 0; }
+
     //implement super
     bool Load (std::string filename, Logger::logchannel * ch = NULL);
 
+    /**
+     * @brief how to read the file; takes effect with the next Load(). Default is mmap, if possible.
+     */
+    void set_source_type(ByteSource::sourcetype_e type, size_t chunksize = ByteSource::DEFAULT_CHUNKSIZE) {
+        _srctype = type;
+        _chunksize = chunksize;
+    }
+
     static OnboardLogParser* make_instance() { return new OnboardLogParserAPM; }
 
     /****************************************
@@ -68,32 +87,64 @@ public:
      ****************************************/    
 
     // how fields and stuff are separated in the log file
-    static const char enclosure_char   = '"';
     static const char field_terminator = ',';
     static const char line_terminator  = '\n';
 
 private:
+    // types
+    typedef TextTokenizer::field_t field_t;
+
+    typedef struct {
+        std::string name;      ///< label of the column
+        char        type;      ///< type character as in FMT
+        bool        is_string;
+        OnboardColumns::coltype_e coltype; ///< if not a string
+        int         id;        ///< in the schema
+    } colformat;
+
+    typedef struct {
+        std::string name;          ///< as in OnboardSchema
+        OnboardSchema* schema;     ///< NULL for PARM, which has one per parameter
+        bool        is_param;      ///< PARM lines are (name, value) pairs
+        bool        columnar;      ///< can be decoded into a table (no strings, no duplicate labels)
+        int         table;         ///< in OnboardColumns, or TABLE_*
+        int         next;          ///< next format in the same hash bucket, or -1
+        std::vector<colformat> columns; ///< each entry is one column. So this maps index to column format
+    } lineformat;
+
+    static const int TABLE_UNKNOWN = -1; ///< type has not been seen in get_columns() yet
+    static const int TABLE_NONE = -2;    ///< type goes through OnboardData
+    static const unsigned int NUM_BUCKETS = 256;
+
     /****************************************
      *     METHODS
      ****************************************/    
-    bool _parse_message(const csv_row & row, OnboardData & data);
+    void _handle_fmt(void);
+    bool _parse_message(const lineformat & fmt, OnboardData & data);
+    bool _parse_param(const lineformat & fmt, OnboardData & data);
+    inline void _set_field(const colformat & c, const field_t & f, unsigned int id, OnboardData & data);
+    int  _find_format(const field_t & name) const;
+    int  _get_table(lineformat & fmt, OnboardColumns & cols);
+    static unsigned int _hash(const field_t & name);
+    static bool _get_coltype(char type, OnboardColumns::coltype_e & coltype);
+    static OnboardSchema::fieldtype_e _get_field_type(const colformat & c);
 
     /****************************************
      *     DATA MEMBERS
      ****************************************/
     // general
     std::string _filename;
-    csv_parser  _parser;
     Logger::logchannel*_logchannel;
-
-    // types
-    typedef char datatype;
-    typedef std::pair<std::string, datatype> colformat; ///< (column name, data type)
-    typedef std::vector<colformat> lineformat; ///< each entry is one column. So this maps index to column format
+    ByteSource::sourcetype_e _srctype;
+    size_t        _chunksize;
+    ByteSource*   _src;
+    TextTokenizer _tok;
+    std::vector<field_t> _row; ///< fields of the current line
+    OnboardData   _other;      ///< scratch for lines which are not in a table
 
     // hash table for formats
-    std::map<std::string, lineformat> _formats; ///< maps line ID -> lineformat
-
+    std::vector<lineformat> _formats;
+    std::vector<int>        _buckets; ///< hash of name -> first format in _formats, or -1
 };
 
 #endif // OnboardLogParserAPMAPM_H
@@ -0,0 +1,130 @@
+/**
+ * @file onboardlogparser_bin.cpp
+ * @brief can parse the binary DataFlash logs (*.bin) of ArduPilot, as downloaded
+ * from the autopilot, without converting them to text first.
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <string.h>
+#include "onboardlogparser_bin.h"
+
+using namespace std;
+
+static std::string get_string(const uint8_t*p, size_t maxlen) {
+    const char*const str = (const char*)p;
+    const char*const end = (const char*) memchr(str, 0, maxlen);
+    return std::string(str, end ? end - str : maxlen);
+}
+
+bool OnboardLogParserBIN::Load(std::string filename, Logger::logchannel *ch) {
+    _unit_labels.clear();
+    _multipliers.clear();
+    return OnboardLogParserPX4::Load(filename, ch);
+}
+
+const OnboardLogParserBIN::field_t* OnboardLogParserBIN::_find_field(const msgformat &fmt, const char *name, char type) {
+    for (vector<field_t>::const_iterator it = fmt.fields.begin(); it != fmt.fields.end(); ++it) {
+        if (it->type == type && it->name == name) return &(*it);
+    }
+    return NULL;
+}
+
+void OnboardLogParserBIN::_apply_units(int typ, const std::string &unit_ids, const std::string &mult_ids) {
+    if (typ < 0 || typ >= (int)_formats.size() || !_formats[typ].defined) return;
+
+    const msgformat & fmt = _formats[typ];
+    for (unsigned int k=0; k < fmt.fields.size() && k < unit_ids.size(); ++k) {
+        const field_t & f = fmt.fields[k];
+        if (f.id < 0) continue;
+        const map<char, string>::const_iterator itu = _unit_labels.find(unit_ids[k]);
+        if (itu == _unit_labels.end() || itu->second.empty()) continue;
+
+        double mult = 1.;
+        if (k < mult_ids.size()) {
+            const map<char, double>::const_iterator itm = _multipliers.find(mult_ids[k]);
+            if (itm != _multipliers.end() && itm->second != 0.) mult = itm->second;
+        }
+        // these are scaled while decoding, so they are in the unit already
+        const bool scaled = (NULL != strchr("cCeEL", f.type));
+        if (scaled || 1. == mult) {
+            fmt.schema->set_units(f.id, itu->second);
+        } else {
+            fmt.schema->set_units(f.id, stringbuilder() << mult << " " << itu->second);
+        }
+    }
+}
+
+bool OnboardLogParserBIN::_handle_special(const msgformat &fmt) {
+    if (OnboardLogParserPX4::_handle_special(fmt)) return true;
+
+    const bool is_unit = (fmt.name_trimmed == "UNIT");
+    const bool is_mult = (fmt.name_trimmed == "MULT");
+    const bool is_fmtu = (fmt.name_trimmed == "FMTU");
+    if (!is_unit && !is_mult && !is_fmtu) return false;
+
+    const uint8_t*const payload = _read_payload(fmt);
+    if (!payload) return true;
+
+    if (is_unit) {
+        // UNIT: TimeUS,Id,Label
+        const field_t*const id = _find_field(fmt, "Id", 'b');
+        const field_t*const label = _find_field(fmt, "Label", 'Z');
+        if (id && label) {
+            _unit_labels[(char) payload[id->offset]] = get_string(payload + label->offset, label->size);
+        }
+    } else if (is_mult) {
+        // MULT: TimeUS,Id,Mult
+        const field_t*const id = _find_field(fmt, "Id", 'b');
+        const field_t*const mult = _find_field(fmt, "Mult", 'd');
+        if (id && mult) {
+            double val;
+            memcpy(&val, payload + mult->offset, sizeof(val));
+            _multipliers[(char) payload[id->offset]] = val;
+        }
+    } else {
+        // FMTU: TimeUS,FmtType,UnitIds,MultIds
+        const field_t*const typ = _find_field(fmt, "FmtType", 'B');
+        const field_t*const units = _find_field(fmt, "UnitIds", 'N');
+        const field_t*const mults = _find_field(fmt, "MultIds", 'N');
+        if (typ && units && mults) {
+            _apply_units(payload[typ->offset], get_string(payload + units->offset, units->size),
+                         get_string(payload + mults->offset, mults->size));
+        }
+    }
+    return true;
+}
+
+void OnboardLogParserBIN::_parse_message(const msgformat &fmt, OnboardData &ret) {
+    OnboardLogParserPX4::_parse_message(fmt, ret);
+    if (!ret.is_valid() || fmt.name_trimmed != "PARM") return;
+
+    // like in the text logs: the value under the name of the parameter
+    const int idn = fmt.schema->find_field("Name", OnboardSchema::FIELD_STRING);
+    const int idv = fmt.schema->find_field("Value", OnboardSchema::FIELD_FLOAT);
+    if (idn < 0 || idv < 0) return;
+    _param_name = ret.get_string(idn);
+    const float value = ret.get_float(idv);
+
+    OnboardSchema & schema = _get_keyed_schema(fmt.name_trimmed, _param_name);
+    if (schema.empty()) schema.add_field(_param_name, OnboardSchema::FIELD_FLOAT);
+    ret.reset(&schema);
+    ret.set_float(0, value);
+    ret._valid = true;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file onboardlogparser_bin.h
+ * @brief can parse the binary DataFlash logs (*.bin) of ArduPilot, as downloaded
+ * from the autopilot, without converting them to text first.
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef ONBOARDLOGPARSERBIN_H
+#define ONBOARDLOGPARSERBIN_H
+
+#include <string>
+#include <map>
+#include "onboardlogparser_px4.h"
+
+/**
+ * @brief DataFlash logs are framed and self-described (FMT) exactly like px4logs, which
+ * were derived from them, so the decoding is inherited. On top of that, FMTU messages
+ * (with UNIT and MULT) give the units of the fields, and PARM messages are turned into
+ * name/value pairs like in the text logs.
+ *
+ * The messages are the same as in the text logs which MissionPlanner makes from these
+ * files, hence the parser presents itself as "apm".
+ */
+class OnboardLogParserBIN : public OnboardLogParserPX4
+{
+public:
+    OnboardLogParserBIN() {}
+
+    static std::string get_extension(void) { return "bin"; }
+
+    // implement super
+    std::string get_parser_name(void) const { return "apm"; }
+
+    // implement super
+    bool Load (std::string filename, Logger::logchannel * ch = NULL);
+
+    static OnboardLogParser* make_instance() { return new OnboardLogParserBIN; }
+
+private:
+    // implement super
+    bool _handle_special(const msgformat & fmt);
+    void _parse_message(const msgformat & fmt, OnboardData& ret);
+
+    /**
+     * @return the field with given name and type, or NULL
+     */
+    static const field_t* _find_field(const msgformat & fmt, const char*name, char type);
+
+    /**
+     * @brief set the units of all fields of a message type from the ids in FMTU
+     */
+    void _apply_units(int typ, const std::string & unit_ids, const std::string & mult_ids);
+
+    std::map<char, std::string> _unit_labels; ///< from UNIT messages
+    std::map<char, double>      _multipliers; ///< from MULT messages
+    std::string                 _param_name;  ///< scratch
+};
+
+#endif // ONBOARDLOGPARSERBIN_H
@@ -22,6 +22,7 @@
  */
 
 #include <iostream>
+#include <string.h>
 #include <inttypes.h>
 #include "onboardlogparser_px4.h"
 #include "stringfun.h"
@@ -41,30 +42,38 @@
 #define PX4_HEAD1 0XA3
 #define PX4_HEAD2 0X95
 #define PX4_HEADERLEN 3
+#define PX4_FMT_PAYLOADLEN (1 + 1 + 4 + 16 + 64)
 
 // more types are defined by message FMT itself...
 
 using namespace std;
 
-OnboardLogParserPX4::OnboardLogParserPX4() : _filename(""), _logchannel(NULL), _consumed(0)
+const int OnboardLogParserPX4::TABLE_UNKNOWN;
+const int OnboardLogParserPX4::TABLE_NONE;
+
+/**
+ * @brief load a value from the log, which need not be aligned
+ */
+template <typename T>
+static inline T load(const uint8_t*const p) {
+    T val;
+    memcpy(&val, p, sizeof(T)); // FIXME: endianness. assumes all is little
+    return val;
+}
+
+OnboardLogParserPX4::OnboardLogParserPX4() : _filename(""), _logchannel(NULL), _srctype(ByteSource::SOURCE_AUTO),
+    _chunksize(ByteSource::DEFAULT_CHUNKSIZE), _src(NULL)
 {
+    msgformat undefined;
+    undefined.defined = false;
+    _formats.resize(256, undefined);
+
     // bootstrap
     _register_fmt(0x80, 89, "FMT", "BBnNZ", "Type,Length,Name,Format,Labels");
 }
 
 OnboardLogParserPX4::~OnboardLogParserPX4() {
-    _filebuf.close();
-}
-
-std::string OnboardLogParserPX4::_filebuf_get_string(unsigned int len) {
-    std::string ret;
-    for (unsigned int k=0; k < len; k++) {
-        int c = _filebuf.sbumpc();
-        if (char_traits<char>::eof() == c) break;
-        ret += (char(c));
-        _consumed++;
-    }
-    return ret;
+    delete _src;
 }
 
 void OnboardLogParserPX4::_log(logmsgtype_e t, const std::string & str) {
@@ -79,10 +88,79 @@ void OnboardLogParserPX4::_log(logmsgtype_e t, const std::string & str) {
     }
 }
 
+/**
+ * @brief set size, type and whether it is a string from the type character
+ * @return false if the type is unknown
+ */
+bool OnboardLogParserPX4::_get_field_layout(field_t &field) {
+    field.is_string = false;
+    field.is_array = false;
+    field.coltype = OnboardColumns::COL_FLOAT;
+    switch (field.type) {
+    case 'b': field.size = 1; field.coltype = OnboardColumns::COL_INT; break;  // int8_t
+    case 'h': field.size = 2; field.coltype = OnboardColumns::COL_INT; break;  // int16_t
+    case 'i': field.size = 4; field.coltype = OnboardColumns::COL_INT; break;  // int32_t
+    case 'q': field.size = 8; field.coltype = OnboardColumns::COL_INT; break;  // int64_t
+    case 'M': // mode-string
+    case 'B': field.size = 1; field.coltype = OnboardColumns::COL_UINT; break; // uint8_t
+    case 'H': field.size = 2; field.coltype = OnboardColumns::COL_UINT; break; // uint16_t
+    case 'I': field.size = 4; field.coltype = OnboardColumns::COL_UINT; break; // uint32_t
+    case 'Q': field.size = 8; field.coltype = OnboardColumns::COL_UINT; break; // uint64_t
+    case 'c': // int16*100
+    case 'C': field.size = 2; break; // uint16*100
+    case 'e': // int32*100
+    case 'E': // uint32*100
+    case 'L': // int32*1E7, lat/lon
+    case 'f': field.size = 4; break; // float
+    case 'd': field.size = 8; break; // double
+    case 'n': field.size = 4; field.is_string = true; break;  // char[4]
+    case 'N': field.size = 16; field.is_string = true; break; // char[16]
+    case 'Z': field.size = 64; field.is_string = true; break; // char[64]
+    case 'a': field.size = 64; field.is_array = true; break;  // int16_t[32]
+    default:
+        field.size = 0;
+        return false;
+    }
+    return true;
+}
+
+inline void OnboardLogParserPX4::_load_field(const field_t &field, const uint8_t *p, value_t &v) {
+    // demux into OnboardData: FIXME: check types (could differ from APM)
+    v.type = field.coltype;
+    switch (field.type) {
+    case 'b': v.i = load<int8_t>(p); break;
+    case 'h': v.i = load<int16_t>(p); break;
+    case 'i': v.i = load<int32_t>(p); break;
+    case 'q': v.i = load<int64_t>(p); break;
+    case 'M': // fallthrough
+    case 'B': v.u = load<uint8_t>(p); break;
+    case 'H': v.u = load<uint16_t>(p); break;
+    case 'I': v.u = load<uint32_t>(p); break;
+    case 'Q': v.u = load<uint64_t>(p); break;
+    case 'L': v.f = load<int32_t>(p)*1E-7; break;  // int32_t -> but encodes a float
+    case 'E': v.f = load<uint32_t>(p)*1E-2; break; // uint32_t*100
+    case 'e': v.f = load<int32_t>(p)*1E-2; break;  // int32_t*100
+    case 'C': v.f = load<uint16_t>(p)*1E-2; break; // uint16*100
+    case 'c': v.f = load<int16_t>(p)*1E-2; break;  // int16*100 -> but is given as float
+    case 'f': v.f = load<float>(p); break;
+    case 'd': v.f = (float) load<double>(p); break;
+    default: break;
+    }
+}
+
 void OnboardLogParserPX4::_register_fmt(int typ, int len, const std::string & name, const std::string & informat, const std::string & fields) {
+    if (typ < 0 || typ >= (int)_formats.size()) return;
+    if (_formats[typ].defined) return; // first one wins
+
     msgformat fmt;
+    fmt.defined = true;
     fmt.name = name;
+    fmt.name_trimmed = name; // original name can be used better to compare the message with the spec
+    string_trim(fmt.name_trimmed);
+    fmt.schema = NULL;
     fmt.length = len;
+    fmt.payload_len = 0;
+    fmt.columnar = true;
 
     vector<string> labels;
     string_split(fields, ',', labels);
@@ -99,237 +177,215 @@ void OnboardLogParserPX4::_register_fmt(int typ, int len, const std::string & na
         return;
     }
 
+    // compile the layout
     for (unsigned int k=0; k<format.length(); k++) {
-        char typechar = format.at(k);
-        std::string fname = labels.at(k); string_trim(fname);
-        fieldformat ff = make_pair(fname, typechar);
-        fmt.format.push_back(ff);
-    }
-
-    _log(MSG_DBG, stringbuilder() << "OnboardLogParserPX4::new message type: " << name << ", id=" << typ << ", len=" << len << ", " << format << ", " << fields);
-    _formats.insert(std::make_pair(typ, fmt));
-}
-
-void OnboardLogParserPX4::_parse_message(const msgformat & fmt, OnboardData& ret) {
-    if (fmt.length < PX4_HEADERLEN) {
-        ret._valid = false;
-        return;
-    }
-    const unsigned int LEN = fmt.length - PX4_HEADERLEN;
-
-    ret._msgname_orig = fmt.name; // original name can be used better to compare the message with the spec
-    string_trim(ret._msgname_orig);
-    ret._msgname_readable = _make_readable_name(ret._msgname_orig); // .. but to the user we want to show pretty names
-
-    // we later check that we dont actually not read more than rem
-    _filebuf_resetcount();
-
-    // all fields
-    for (unsigned f = 0; f < fmt.format.size(); f++) {
-        const std::string fieldlabel = fmt.format[f].first;
-        const char fieldtype = fmt.format[f].second;
-
-        // demux into OnboardData: FIXME: check types (could differ from APM)
-        switch (fieldtype) {
-        case 'i': // int32_t - OK
-        {
-            int32_t v; _filebuf_get(v);
-            ret._int_data[fieldlabel] = v;
-        }
-            break;
-
-        case 'h': // int16_t - OK
-        {
-            int16_t v; _filebuf_get(v);
-            ret._int_data[fieldlabel] = v;
-        }
-            break;
-
-        case 'Q': // Uint64
-        {
-            uint64_t v; _filebuf_get(v);
-            ret._uint_data[fieldlabel] = v;
-        }
-            break;
-
-        case 'q': //Int64
-        {
-            int64_t v; _filebuf_get(v);
-            ret._int_data[fieldlabel] = v;
-        }
-            break;
-
-        case 'b': // int8_t - OK
-        {
-            int8_t v; _filebuf_get(v);
-            ret._int_data[fieldlabel] = v;
-        }
-            break;
-
-        case 'I': // uint32_t - OK
-        {
-            uint32_t v; _filebuf_get(v);
-            ret._uint_data[fieldlabel] = v;
-        }
-            break;
-
-        case 'H': // uint16_t - OK
-        {
-            uint16_t v; _filebuf_get(v);
-            ret._uint_data[fieldlabel] = v;
-        }
-            break;
-
-        case 'M': // mode-string - OK
-        case 'B': // uint8_t
-        {
-            uint8_t v; _filebuf_get(v);
-            ret._uint_data[fieldlabel] = v;
-        }
-            break;
-
-        case 'L': // int32_t -> but encodes a float - OK
-        {
-            int32_t v; _filebuf_get(v);
-            float vf = v*1E-7;
-            ret._float_data[fieldlabel] = vf;
+        field_t f;
+        f.type = format.at(k);
+        f.name = labels.at(k); string_trim(f.name);
+        f.offset = fmt.payload_len;
+        if (!_get_field_layout(f)) {
+            // unknown datatypes are ignored...
+            _log(MSG_ERR, stringbuilder() << "OnboardLogParserPX4::_register_fmt: unknown field type: "<< f.type <<"; messages " + fmt.name_trimmed + " might be garbage ");
+            fmt.columnar = false;
         }
-            break;
-
-        case 'E': // uint32_t*100 - OK
-        {
-            uint32_t v; _filebuf_get(v);
-            float vf = v*1E-2;
-            ret._float_data[fieldlabel] = vf;
+        if (f.is_string || f.is_array) fmt.columnar = false;
+        for (unsigned int j=0; j < fmt.fields.size(); ++j) {
+            if (fmt.fields[j].name == f.name) fmt.columnar = false; // would be one series
         }
-            break;
+        fmt.payload_len += f.size;
+        fmt.fields.push_back(f);
+    }
 
-        case 'e': // int32_t*100 - OK
-        {
-            int32_t v; _filebuf_get(v);
-            float vf = v*1E-2;
-            ret._float_data[fieldlabel] = vf;
+    // .. but to the user we want to show pretty names
+    fmt.schema = _add_schema(fmt.name_trimmed);
+    for (vector<field_t>::iterator it = fmt.fields.begin(); it != fmt.fields.end(); ++it) {
+        if (0 == it->size || it->is_array) {
+            it->id = -1;
+        } else if (it->is_string) {
+            it->id = fmt.schema->add_field(it->name, OnboardSchema::FIELD_STRING);
+        } else {
+            it->id = fmt.schema->add_field(it->name, OnboardColumns::get_field_type(it->coltype));
         }
-            break;
+    }
 
-        case 'C': // uint16*100 - ok
-        {
-            uint16_t v; _filebuf_get(v);
-            float vf = v*1E-2;
-            ret._float_data[fieldlabel] = vf;
-        }
-            break;
+    _log(MSG_DBG, stringbuilder() << "OnboardLogParserPX4::new message type: " << name << ", id=" << typ << ", len=" << len << ", " << format << ", " << fields);
+    _formats[typ] = fmt;
+}
 
-        case 'c': // int16*100 -> but is given as float - OK
-        {
-            int16_t v; _filebuf_get(v);
-            float vf = v*1E-2;
-            ret._float_data[fieldlabel] = vf;
-        }
-            break;
+void OnboardLogParserPX4::_handle_fmt(void) {
+    // FMT message is build like follows: type, length, name, format, labels
+    const uint8_t*const p = _cur.read(PX4_FMT_PAYLOADLEN);
+    if (!p) return;
+    const int type = p[0];
+    const int length = p[1];
+    const std::string name((const char*)p + 2, 4);
+    const std::string fmt((const char*)p + 6, 16);
+    const std::string labels((const char*)p + 22, 64);
+    _register_fmt(type, length, name, fmt, labels);
+}
 
-        case 'f': // float - OK
-        {
-            float v; _filebuf_get(v);
-            ret._float_data[fieldlabel] = v;
-        }
-            break;
+bool OnboardLogParserPX4::_handle_special(const msgformat &fmt) {
+    if (fmt.name != "FMT") return false;
+    _handle_fmt();
+    return true;
+}
 
-        case 'Z': // char[64] - OK
-        {
-            std::string s = _filebuf_get_string(64);
-            ret._string_data[fieldlabel] = s;
-        }
-            break;
+/**
+ * @brief consume the payload of a message
+ * @return pointer to it, or NULL if it is inconsistent with its format or incomplete
+ */
+const uint8_t* OnboardLogParserPX4::_read_payload(const msgformat &fmt) {
+    if (fmt.length < PX4_HEADERLEN) return NULL;
+    const unsigned int LEN = fmt.length - PX4_HEADERLEN;
+    if (LEN != fmt.payload_len) {
+        _cur.skip(fmt.payload_len); // as much as the fields take, then look for the next header
+        _log(MSG_ERR, stringbuilder() << "OnboardLogParserPX4::_parse_message: message \"" + fmt.name + "\" inconsistent. Ignoring it.");
+        return NULL;
+    }
+    const uint8_t*const p = _cur.read(LEN);
+    if (!p) {
+        _log(MSG_ERR, stringbuilder() << "OnboardLogParserPX4::_parse_message: message \"" + fmt.name + "\" incomplete. Ignoring it.");
+    }
+    return p;
+}
 
-        case 'N': // char[16] - OK
-        {
-            std::string s = _filebuf_get_string(16);
-            ret._string_data[fieldlabel] = s;
-        }
-            break;
+void OnboardLogParserPX4::_parse_message(const msgformat & fmt, OnboardData& ret) {
+    ret.reset(fmt.schema);
+    const uint8_t*const payload = _read_payload(fmt);
+    if (!payload) return;
 
-        case 'n': // char[4] - OK
-        {
-            std::string s = _filebuf_get_string(4);
-            ret._string_data[fieldlabel] = s;
+    // all fields
+    value_t v = value_t();
+    for (vector<field_t>::const_iterator it = fmt.fields.begin(); it != fmt.fields.end(); ++it) {
+        const field_t & f = *it;
+        if (f.id < 0) continue;
+        const uint8_t*const p = payload + f.offset;
+        if (f.is_string) {
+            // padded with zeros
+            const char*const str = (const char*)p;
+            const char*const end = (const char*) memchr(str, 0, f.size);
+            ret.set_string(f.id).assign(str, end ? end - str : f.size);
+            continue;
         }
-            break;
-
-        default:
-            // unknown datatypes are ignored...
-            _log(MSG_ERR, stringbuilder() << "OnboardLogParserPX4::_parse_message: unknown field type: "<< fieldtype <<"; rest of this message (" + fmt.name + ") might by garbage ");
-            break;
+        _load_field(f, p, v);
+        switch (v.type) {
+        case OnboardColumns::COL_INT:   ret.set_int(f.id, v.i); break;
+        case OnboardColumns::COL_UINT:  ret.set_uint(f.id, v.u); break;
+        case OnboardColumns::COL_FLOAT: ret.set_float(f.id, v.f); break;
         }
     }
-
-    if (LEN != _filebuf_getcount()) {
-        ret._valid = false;
-        _log(MSG_ERR, stringbuilder() << "OnboardLogParserPX4::_parse_message: message \"" + fmt.name + "\" inconsistent. Ignoring it.");
-    } else {
-        ret._valid = true;
-    }
-
+    ret._valid = true;
 }
 
 // implement OnboardLogParser::get_data
-OnboardData OnboardLogParserPX4::get_data(void) {
-    OnboardData ret;
-    if (!valid) return ret;
+void OnboardLogParserPX4::get_data(OnboardData & ret) {
+    ret.reset(NULL);
+    if (!valid) return;
 
     // 1. try to read next message
     int typ;
     if (_get_next_message(typ)) {
         // see if we know the format and handle it
-
-        formatmap::const_iterator it = _formats.find(typ);
-        if (it != _formats.end()) {
-            if (it->second.name == "FMT") {
-                // defines more messages
-                // FMT message is build like follows:
-                int type = _filebuf.sbumpc();
-                //_log(MSG_INFO, stringbuilder() << "OnboardLogParserPX4: got FMT (" << type <<")" );
-                int length = _filebuf.sbumpc();
-                std::string name = _filebuf_get_string(4);
-                std::string fmt = _filebuf_get_string(16);
-                std::string labels = _filebuf_get_string(64);
-                _register_fmt(type, length, name, fmt, labels);
-            } else {
-                // is a message with data -> parse it
-                //_log(MSG_INFO, stringbuilder() << "OnboardLogParserPX4: got data " << ((int)typ) );
-                _parse_message(it->second,ret);
-            }
-        } else {
+        const msgformat & fmt = _formats[typ];
+        if (!fmt.defined) {
             _log(MSG_INFO, stringbuilder() << "OnboardLogParserPX4: unknown message type " << ((int)typ) );
+        } else if (_handle_special(fmt)) {
+            // defines more messages, or describes them
+        } else {
+            // is a message with data -> parse it
+            _parse_message(fmt, ret);
         }
     }
+}
 
+/**
+ * @brief find the table for a message type, and set it up the first time
+ * @return index of table, or TABLE_NONE
+ */
+int OnboardLogParserPX4::_get_table(int typ, OnboardColumns &cols) {
+    if (TABLE_UNKNOWN != _table_of_type[typ]) return _table_of_type[typ];
+
+    const msgformat & fmt = _formats[typ];
+    int t = TABLE_NONE;
+    if (fmt.columnar) {
+        t = cols.get_or_add_table(fmt.schema);
+        const OnboardColumns::table_t & tab = cols.tables[t];
+        // another type with the same name must look the same
+        bool same = (tab.columns.size() == fmt.fields.size()) && t < (int)OnboardColumns::OTHER;
+        for (unsigned int k=0; same && k < fmt.fields.size(); ++k) {
+            same = tab.columns[k].name == fmt.fields[k].name && tab.columns[k].type == fmt.fields[k].coltype;
+        }
+        if (!same) t = TABLE_NONE;
+    }
+    _table_of_type[typ] = t;
+    return t;
+}
 
-    return ret;
+bool OnboardLogParserPX4::get_columns(OnboardColumns &cols, unsigned int max_msgs) {
+    if (!valid) return false;
+
+    unsigned int n = 0;
+    int typ;
+    while (n < max_msgs && _get_next_message(typ)) {
+        const msgformat & fmt = _formats[typ];
+        if (!fmt.defined) {
+            _log(MSG_INFO, stringbuilder() << "OnboardLogParserPX4: unknown message type " << ((int)typ) );
+            continue;
+        }
+        if (_handle_special(fmt)) continue;
+
+        const int t = _get_table(typ, cols);
+        if (t < 0) {
+            // rare, so these stay as they are
+            _parse_message(fmt, _other);
+            if (_other.is_valid()) {
+                cols.others.push_back(_other);
+                cols.order.push_back(OnboardColumns::OTHER);
+                n++;
+            }
+            continue;
+        }
+
+        const uint8_t*const payload = _read_payload(fmt);
+        if (!payload) continue;
+        OnboardColumns::table_t & tab = cols.tables[t];
+        value_t v = value_t();
+        for (unsigned int k=0; k < fmt.fields.size(); ++k) {
+            const field_t & f = fmt.fields[k];
+            _load_field(f, payload + f.offset, v);
+            OnboardColumns::column_t & c = tab.columns[k];
+            switch (v.type) {
+            case OnboardColumns::COL_INT:   c.intdata.push_back(v.i); break;
+            case OnboardColumns::COL_UINT:  c.uintdata.push_back(v.u); break;
+            case OnboardColumns::COL_FLOAT: c.floatdata.push_back(v.f); break;
+            }
+        }
+        tab.rows++;
+        cols.order.push_back((uint16_t) t);
+        n++;
+    }
+    return valid;
 }
 
 /**
  * @brief OnboardLogParserPX4::_get_next_message
  * @param ret (out) message type
- * @return true if there is a message (scans entire file). when returned, then filebuf is positioned at first payload byte
+ * @return true if there is a message (scans entire file). when returned, then the cursor is positioned at first payload byte
  */
 bool OnboardLogParserPX4::_get_next_message(int&ret) {
     if (!valid) return false;
 
-    bool found = false;
     for(;;) {
-        ret = _filebuf.sbumpc(); // read current and proceed -> at second header byte now
-        if (PX4_HEAD1 == ret && PX4_HEAD2 == _filebuf.sgetc()) {
-            found = true;
-            break;
-        }
-        if (char_traits<char>::eof() == ret) break;
+        const uint8_t*const c = _cur.read(1);
+        if (!c) return false;
+        if (PX4_HEAD1 == *c && PX4_HEAD2 == _cur.peek()) break;
     }
-    if (!found) return false;
+    _cur.skip(1);
 
     // return type
-    ret = _filebuf.snextc(); // proceed and read -> ptr is now on the type (3rd header field)
-    _filebuf.snextc(); // now points to first payload
+    const uint8_t*const typ = _cur.read(1);
+    if (!typ) return false;
+    ret = *typ;
     return true;
 }
 
@@ -337,14 +393,17 @@ bool OnboardLogParserPX4::_get_next_message(int&ret) {
 bool OnboardLogParserPX4::has_more_data(void) {
     if (!valid) return false;
 
-    return (_filebuf.sgetc() != std::char_traits<char>::eof());
+    return !_cur.at_end();
 }
 
 bool OnboardLogParserPX4::Load (std::string filename, Logger::logchannel * ch) {
     // initialize buffer
     _filename = filename;
     _logchannel = ch;
-    _filebuf.open(filename.c_str(), std::ios_base::binary | std::ios_base::in);
-    valid = _filebuf.is_open();
+    delete _src;
+    _src = ByteSource::open(filename, _srctype, _chunksize);
+    _cur.reset(_src);
+    _table_of_type.assign(_formats.size(), TABLE_UNKNOWN);
+    valid = _src->valid;
     return valid;
 }
@@ -26,10 +26,19 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <inttypes.h>
 #include "onboardlogparser.h"
+#include "bytesource.h"
 #include "logger.h"
 
+/**
+ * @brief parser for the binary logs of the PX4 sdlog2 app (.px4log).
+ *
+ * Every FMT message is compiled once into a layout (offset, size and type of each field).
+ * Records are then read in one piece through a ByteCursor (mmap'd or buffered), and the
+ * fields are loaded from there, either into an OnboardData with get_data(), or into
+ * columns with get_columns().
+ */
 class OnboardLogParserPX4 : public OnboardLogParser
 {
 public:
@@ -37,80 +46,106 @@ public:
     ~OnboardLogParserPX4();
 
     // implement OnboardLogParser::get_data
-    OnboardData get_data(void);
+    void get_data(OnboardData & ret);
 
     // implement OnboardLogParser::has_more_data
     bool has_more_data(void);
 
+    // implement OnboardLogParser::get_columns
+    bool has_columns(void) const { return true; }
+    bool get_columns(OnboardColumns & cols, unsigned int max_msgs);
+
     static std::string get_extension(void) { return "px4log"; }
 
 
     // implement super
     std::string get_parser_name(void) const { return "px4"; }
 
+    // implement super
+    uint64_t get_bytes_consumed(void) const { return _src ? _src->get_position() : 0; }
+
     // implement super
     bool Load (std::string filename, Logger::logchannel * ch = NULL);
 
+    /**
+     * @brief how to read the file; takes effect with the next Load(). Default is mmap, if possible.
+     */
+    void set_source_type(ByteSource::sourcetype_e type, size_t chunksize = ByteSource::DEFAULT_CHUNKSIZE) {
+        _srctype = type;
+        _chunksize = chunksize;
+    }
+
     static OnboardLogParser* make_instance() { return new OnboardLogParserPX4; }
-private:
+protected:
     // types
-    typedef char datatype;
-    typedef std::pair<std::string, datatype> fieldformat; ///< (column name, data type)
     typedef struct {
         std::string name;
-        int length; // length of this message in bytes, incl. header length
-        std::vector<fieldformat> format; // fields in this message
+        char        type;     ///< type character as in FMT
+        uint16_t    offset;   ///< from beginning of payload
+        uint8_t     size;     ///< bytes in the log, 0 if type is unknown
+        bool        is_string;
+        bool        is_array; ///< not decoded
+        OnboardColumns::coltype_e coltype; ///< if neither string nor array
+        int         id;       ///< in the schema, or -1 if not decoded
+    } field_t;
+
+    typedef struct {
+        bool        defined;
+        std::string name;          ///< as in FMT
+        std::string name_trimmed;  ///< as in OnboardSchema
+        OnboardSchema* schema;     ///< the decoded fields
+        int length;                ///< length of this message in bytes, incl. header length
+        unsigned int payload_len;  ///< sum of all field sizes; must be length - header length
+        bool        columnar;      ///< can be decoded into a table (no strings or arrays, no unknown types, no duplicate labels)
+        std::vector<field_t> fields;
     } msgformat;
 
+    /**
+     * @brief a field loaded from the log, and how it goes into OnboardData or a column
+     */
+    typedef struct {
+        OnboardColumns::coltype_e type;
+        int64_t  i;
+        uint64_t u;
+        float    f;
+    } value_t;
+
+    static const int TABLE_UNKNOWN = -1; ///< type has not been seen in get_columns() yet
+    static const int TABLE_NONE = -2;    ///< type goes through OnboardData
+
     /*******************
      * METHODS
      *******************/
     bool _get_next_message(int &type);
-    void _register_fmt(int typ, int len, const std::string & name, const std::string & format, const std::string & fields);    
-    void _parse_message(const msgformat & fmt, OnboardData& ret);
+    void _register_fmt(int typ, int len, const std::string & name, const std::string & format, const std::string & fields);
+    void _handle_fmt(void);
+
+    /**
+     * @brief messages which describe the log rather than the vehicle (FMT)
+     * @return true if the message was consumed
+     */
+    virtual bool _handle_special(const msgformat & fmt);
+
+    const uint8_t* _read_payload(const msgformat & fmt);
+    virtual void _parse_message(const msgformat & fmt, OnboardData& ret);
+    int  _get_table(int typ, OnboardColumns & cols);
+    static bool _get_field_layout(field_t & field);
+    static inline void _load_field(const field_t & field, const uint8_t*p, value_t & v);
     void _log(logmsgtype_e t, const std::string & str);
 
-    // string reader
-    std::string _filebuf_get_string(unsigned int len);
-
-    // generic type reader
-    template <typename T>
-    void _filebuf_get(T &var) {
-        // FIXME: endianness. assumes all is little
-        const int LEN = sizeof(T);
-        if (LEN <= 0) return;
-
-        char*p = (char*)&var;
-        for (int l=0; l<LEN; l++) {
-            *p++ = (char)_filebuf.sbumpc();
-        }
-
-        // that doesn't work, because filebuf::pubseekoff() is not always seeking
-        //_filebuf.sgetn((char*)&var, LEN);
-        //_filebuf.pubseekoff(LEN, std::ios_base::cur,std::ios_base::in); // consume -> not working. why??!
-        _consumed += LEN;
-    }
-    // count consumption
-    unsigned int _filebuf_getcount(void) const {
-        return _consumed;
-    }
-    // reset consumption counter
-    void _filebuf_resetcount(void) {
-        _consumed = 0;
-    }
-
-
     /*******************
      * ATTRIBUTES
      *******************/
     std::string _filename;
-    std::filebuf _filebuf;
     Logger::logchannel*_logchannel;
-    unsigned int _consumed;
-
-    // hash table for formats
-    typedef std::map<int, msgformat> formatmap;
-    formatmap _formats; ///< maps message ID -> format
+    ByteSource::sourcetype_e _srctype;
+    size_t      _chunksize;
+    ByteSource* _src;
+    ByteCursor  _cur;
+
+    std::vector<msgformat> _formats;  ///< message type -> format
+    std::vector<int>       _table_of_type; ///< message type -> table in OnboardColumns, or TABLE_*
+    OnboardData            _other; ///< scratch for messages which are not in a table
 };
 
 #endif // ONBOARDLOGPARSERPX4_H
@@ -24,6 +24,9 @@
 
 #include <iostream>
 #include <cassert>
+#include <string.h>
+#include <algorithm>
+#include <QRunnable>
 #include "stringfun.h"
 #include "onboardlogparser_ulg.h"
 
@@ -46,12 +49,11 @@
 #define ULOG_HEADER_SIZE 16
 #define ULOG_MAGIC {0x55, 0x4C, 0x6F, 0x67, 0x01, 0x12, 0x35}
 
-// header for defs
+// header for defs: uint16_t msg_size, uint8_t msg_type
 #define ULOG_MSG_HEADER_LEN 3
-typedef struct ulog_message_header_s {
-    uint16_t msg_size;
-    uint8_t  msg_type;
-} ulog_message_header_t;
+
+// data messages: uint16_t msg_id, then the fields
+#define ULOG_DATA_OFF 2
 
 #define ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK (1<<0)
 
@@ -68,35 +70,69 @@ struct message_info_s {
 
 using namespace std;
 
+const int OnboardLogParserULG::TABLE_UNKNOWN;
+const int OnboardLogParserULG::TABLE_BROKEN;
+const unsigned int OnboardLogParserULG::ROWS_PER_WORKER;
+
+/**
+ * @brief load a value from the log, which need not be aligned
+ */
+template <typename T>
+static inline T load(const uint8_t*const p) {
+    T val;
+    memcpy(&val, p, sizeof(T)); // FIXME: endianness fails if host=big
+    return val;
+}
+
+static inline uint16_t load_u16le(const uint8_t*const p) {
+    return ((uint16_t) p[0]) | (((uint16_t) p[1]) << 8);
+}
+
+OnboardLogParserULG::OnboardLogParserULG() :
+    _logchannel(NULL), _src(NULL), _msg(NULL),
+    _buflen(0), _state(WAIT_HEADER), _have_pending_header(false), _pending_size(0), _pending_type(0),
+    _nthreads(1) {}
+
+OnboardLogParserULG::~OnboardLogParserULG() {
+    _pool.waitForDone();
+    delete _src;
+}
+
 bool OnboardLogParserULG::Load (std::string filename, Logger::logchannel * ch) {
     // initialize buffer
     _filename = filename;
     _logchannel = ch;
-    _filebuf.open(filename.c_str(), std::ios_base::binary | std::ios_base::in);
-    valid = _filebuf.is_open();
+    delete _src;
+    _src = ByteSource::open(filename);
+    valid = _src->valid;
+    _cur.reset(_src);
     _state = WAIT_HEADER;
+    _msg = NULL;
     _buflen = 0;
-    _read_until_file_position = 1ULL << 60; ///< read limit if log contains appended data
+    _have_pending_header = false;
+    _formats.clear();
+    _clear_schemas();
+    _message_name.clear();
+    _table_of_id.clear();
+    _format_of_id.clear();
+    _format_of_table.clear();
+    _msgs_of_table.clear();
     return valid;
 }
 
-
 /**
  * @brief consume format message
  * @param siz
  * @return true on success, else false
  */
 bool OnboardLogParserULG::_get_defs_format(uint16_t siz) {
-    char *format = (char *)_buffer;
-    int n = _filebuf.sgetn(_buffer, siz);
-    if (n < siz) {
+    const char*const format = (const char*) _cur.read(siz);
+    if (!format) {
         _log(MSG_ERR, stringbuilder() << "Log file incomplete");
         return false;
     }
 
-    format[siz] = 0; // zero-terminate
-
-    string str_format(format);
+    string str_format(format, strnlen(format, siz));
     size_t pos = str_format.find(':');
     if (pos == string::npos) {
         return false;
@@ -108,19 +144,6 @@ bool OnboardLogParserULG::_get_defs_format(uint16_t siz) {
     return true;
 }
 
-
-/**
- * @brief consume PARAM message
- * @param siz
- * @return true on success, else false
- */
-bool OnboardLogParserULG::_get_defs_param(uint16_t siz) {
-    // TODO: not just skip
-    //_log(MSG_DBG, stringbuilder() << "PARM ignored");
-    _filebuf.pubseekoff(siz, ios_base::cur, ios_base::in);
-    return true;
-}
-
 /**
  * @brief consume flags message
  * @param siz
@@ -134,14 +157,13 @@ bool OnboardLogParserULG::_get_defs_flagbits(uint16_t siz) {
         return false;
     }
 
-    int n = _filebuf.sgetn(_buffer, MSGLEN);
-    if (n < MSGLEN) {
+    const uint8_t*const message = _cur.read(siz);
+    if (!message) {
         _log(MSG_ERR, stringbuilder() << "Log file incomplete");
         return false;
     }
 
-    uint8_t *message = (uint8_t *)_buffer;
-    uint8_t *incompat_flags = message + 8;
+    const uint8_t *incompat_flags = message + 8;
 
     // handle & validate the flags
     bool contains_appended_data = incompat_flags[0] & ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK;
@@ -169,7 +191,7 @@ bool OnboardLogParserULG::_get_defs_flagbits(uint16_t siz) {
         if (appended_offsets[0] > 0) {
             // the appended data is currently only used for hardfault dumps, so it's safe to ignore it.
             _log(MSG_ERR, stringbuilder() << "Log contains appended data. Replay will ignore this data");
-            _read_until_file_position = appended_offsets[0];
+            _cur.set_limit(appended_offsets[0]);
         }
     }
 
@@ -182,28 +204,33 @@ bool OnboardLogParserULG::_get_defs_flagbits(uint16_t siz) {
  */
 bool OnboardLogParserULG::_get_defs(void) {
 
-    const ulog_message_header_t*const head = (ulog_message_header_t*) _buffer;
     for(;;) {
-        int n = _filebuf.sgetn(_buffer, ULOG_MSG_HEADER_LEN);
-        if (n < ULOG_MSG_HEADER_LEN) return false; // is it?
+        const uint8_t*const head = _cur.read(ULOG_MSG_HEADER_LEN);
+        if (!head) return false; // is it?
+        const uint16_t msg_size = load_u16le(head);
+        const uint8_t msg_type = head[2];
 
-        switch (head->msg_type) {
+        switch (msg_type) {
         case (int) FLAG_BITS:
-            if (!_get_defs_flagbits(head->msg_size)) return false;
+            if (!_get_defs_flagbits(msg_size)) return false;
             break;
 
         case (int) FORMAT:
-            if (!_get_defs_format(head->msg_size)) return false;
+            if (!_get_defs_format(msg_size)) return false;
             break;
 
         case (int) PARAMETER:
-            if (!_get_defs_param(head->msg_size)) return false;
+            // TODO: not just skip
+            //_log(MSG_DBG, stringbuilder() << "PARM ignored");
+            if (!_cur.skip(msg_size)) return false;
             break;
 
         case (int) ADD_LOGGED_MSG: ///< indicates end of definitions
             _log(MSG_DBG, stringbuilder() << "ADD_LOGGED_MSG");
-            // seek back by header length
-            _filebuf.pubseekoff(-ULOG_MSG_HEADER_LEN, ios_base::cur, ios_base::in);
+            // this header already belongs to the data section
+            _have_pending_header = true;
+            _pending_size = msg_size;
+            _pending_type = msg_type;
             return true;
             break;
 
@@ -211,11 +238,11 @@ bool OnboardLogParserULG::_get_defs(void) {
         case (int) INFO_MULTIPLE: // fallthrough
             //_log(MSG_DBG, stringbuilder() << "INFO");
             // SKIP THESE. FIXME: don't skip.
-            _filebuf.pubseekoff(head->msg_size, ios_base::cur, ios_base::in);
+            if (!_cur.skip(msg_size)) return false;
             break;
 
         default:
-            _log(MSG_ERR, stringbuilder() << "Unknown message in def section: " << head->msg_type);
+            _log(MSG_ERR, stringbuilder() << "Unknown message in def section: " << msg_type);
             return false;
             break;
         }
@@ -225,28 +252,18 @@ bool OnboardLogParserULG::_get_defs(void) {
 }
 
 /**
- * @brief find and consume the ULOG header
+ * @brief consume the ULOG header
  * @return true if all ok, else false
  */
 bool OnboardLogParserULG::_get_header(void) {
     const uint8_t magic[] = ULOG_MAGIC;
 
-    for(;;) {
-        if (_buflen >= ULOG_HEADER_SIZE) {
-            memccpy(_buffer, _buffer+1, ULOG_HEADER_SIZE - 1, 1); // shift left if necessary
-        }
-
-        int c = _filebuf.sbumpc();
-        if (char_traits<char>::eof() == c) return false;
-
-        _buffer[_buflen++] = c;
-
-        // complete?
-        if (_buflen == ULOG_HEADER_SIZE && memcmp(_buffer, _buffer, sizeof(magic)) == 0) {
-            return true; // now points to right after header
-        }
+    const uint8_t*const header = _cur.read(ULOG_HEADER_SIZE);
+    if (!header) return false;
+    if (memcmp(header, magic, sizeof(magic)) != 0) {
+        _log(MSG_WARN, stringbuilder() << "File magic does not match. Trying anyway");
     }
-    _buflen = 0;
+    return true; // now points to right after header
 }
 
 /**
@@ -265,22 +282,25 @@ void OnboardLogParserULG::_log(logmsgtype_e t, const std::string & str) {
 }
 
 /**
- * @brief read next msg to buffer, return typ and set _buflen
+ * @brief read next msg, return typ and set _msg and _buflen
  * @param typ returns the header type
  * @return
  */
 bool OnboardLogParserULG::_get_log_message(int&typ) {
-    int n = _filebuf.sgetn(_buffer, ULOG_MSG_HEADER_LEN);
-    if (n < ULOG_MSG_HEADER_LEN) return false;
-
-    ulog_message_header_t*head = (ulog_message_header_t*) _buffer;
-    _buflen = head->msg_size; // FIXME: endianness?
-    typ = head->msg_type;
+    if (_have_pending_header) {
+        _have_pending_header = false;
+        _buflen = _pending_size;
+        typ = _pending_type;
+    } else {
+        const uint8_t*const head = _cur.read(ULOG_MSG_HEADER_LEN);
+        if (!head) return false;
+        _buflen = load_u16le(head);
+        typ = head[2];
+    }
     if (_buflen == 0) return false;
 
-    n = _filebuf.sgetn(_buffer, _buflen);
-    if (n < (int)_buflen) return false;
-    _buffer[_buflen] = 0;
+    _msg = _cur.read(_buflen);
+    if (!_msg) return false;
 
     //std::cout << "Reading log message " << typ << ": len=" << _buflen << std::endl;
 
@@ -288,7 +308,7 @@ bool OnboardLogParserULG::_get_log_message(int&typ) {
 }
 
 /**
- * @brief read next data message into _buffer.
+ * @brief read next data message into _msg.
  * Silently consumes header & definitions.
  * @return true on success, false on error (e.g., eof)
  */
@@ -321,51 +341,68 @@ bool OnboardLogParserULG::_get_next_message(int&typ) {
     return _get_log_message(typ);
 }
 
-bool is_padding (const string  & str) {
+static bool is_padding (const string  & str) {
     return str.substr(0, strlen("_padding")) == "_padding";
 }
 
-#define READ_FUNCTION(funcname, type, target) \
-    static int funcname (const char*const buf, const std::string &nam, OnboardData &data) { \
-        if (!is_padding(nam)) { \
-            data.target [nam] = *((type*)buf); /*FIXME: endianness fails if host=big*/ \
-        } \
-        return sizeof(type); \
-    }
-
-READ_FUNCTION(read_int8,   int8_t,   _int_data)
-READ_FUNCTION(read_uint8,  uint8_t,  _uint_data)
-READ_FUNCTION(read_int16,  int16_t,  _int_data)
-READ_FUNCTION(read_uint16, uint16_t, _uint_data)
-READ_FUNCTION(read_int32,  int32_t,  _int_data)
-READ_FUNCTION(read_uint32, uint32_t, _uint_data)
-READ_FUNCTION(read_int64,  int64_t,  _int_data)
-READ_FUNCTION(read_uint64, uint64_t, _uint_data)
-READ_FUNCTION(read_float,  float,    _float_data)
-READ_FUNCTION(read_double, double,   _float_data)
-
 /**
- * @brief find read function corresponding to data type
- * @return ptr to function, or NULL if unknown
+ * @brief find how to load a field of given data type
+ * @return false if unknown
  */
-Read_Field_Function OnboardLogParserULG::_get_field_reader (const std::string & fieldtype) {
+bool OnboardLogParserULG::_get_field_type (const std::string & fieldtype, fieldtype_e & type) {
     if (fieldtype == "uint8_t" ||
         fieldtype == "bool" ||
         fieldtype == "char")
-        return &read_uint8;
-    if (fieldtype == "int8_t") return &read_int8;
-    if (fieldtype == "uint16_t") return &read_uint16;
-    if (fieldtype == "int16_t") return &read_int16;
+        type = FIELD_UINT8;
+    else if (fieldtype == "int8_t") type = FIELD_INT8;
+    else if (fieldtype == "uint16_t") type = FIELD_UINT16;
+    else if (fieldtype == "int16_t") type = FIELD_INT16;
 
-    if (fieldtype == "uint32_t") return &read_uint32;
-    if (fieldtype == "int32_t") return &read_int32;
+    else if (fieldtype == "uint32_t") type = FIELD_UINT32;
+    else if (fieldtype == "int32_t") type = FIELD_INT32;
 
-    if (fieldtype == "uint64_t") return &read_uint64;
-    if (fieldtype == "int64_t") return &read_int64;
+    else if (fieldtype == "uint64_t") type = FIELD_UINT64;
+    else if (fieldtype == "int64_t") type = FIELD_INT64;
 
-    if (fieldtype == "float") return &read_float;
-    if (fieldtype == "double") return &read_double;
-    return NULL;
+    else if (fieldtype == "float") type = FIELD_FLOAT;
+    else if (fieldtype == "double") type = FIELD_DOUBLE;
+    else return false;
+    return true;
+}
+
+unsigned int OnboardLogParserULG::_get_field_size (fieldtype_e type) {
+    switch (type) {
+    case FIELD_INT8:   // fallthrough
+    case FIELD_UINT8:  return 1;
+    case FIELD_INT16:  // fallthrough
+    case FIELD_UINT16: return 2;
+    case FIELD_INT32:  // fallthrough
+    case FIELD_UINT32: // fallthrough
+    case FIELD_FLOAT:  return 4;
+    case FIELD_INT64:  // fallthrough
+    case FIELD_UINT64: // fallthrough
+    case FIELD_DOUBLE: return 8;
+    }
+    return 0;
+}
+
+/**
+ * @brief which column/OnboardData map a field goes to
+ */
+OnboardColumns::coltype_e OnboardLogParserULG::_get_column_type (fieldtype_e type) {
+    switch (type) {
+    case FIELD_INT8:   // fallthrough
+    case FIELD_INT16:  // fallthrough
+    case FIELD_INT32:  // fallthrough
+    case FIELD_INT64:  return OnboardColumns::COL_INT;
+    case FIELD_UINT8:  // fallthrough
+    case FIELD_UINT16: // fallthrough
+    case FIELD_UINT32: // fallthrough
+    case FIELD_UINT64: return OnboardColumns::COL_UINT;
+    case FIELD_FLOAT:  // fallthrough
+    case FIELD_DOUBLE: return OnboardColumns::COL_FLOAT;
+    }
+    return OnboardColumns::COL_FLOAT;
 }
 
 template <typename Iter, typename Cont>
@@ -404,6 +441,9 @@ unsigned int OnboardLogParserULG::_find_array_spec (std::string & fieldtype) {
     return elems;
 }
 
+/**
+ * @brief compile the decode plan for a message type
+ */
 void OnboardLogParserULG::_register_format
 (const std::string & name, const std::string & strfields)
 {
@@ -418,9 +458,6 @@ void OnboardLogParserULG::_register_format
         return;
     }
 
-    OnboardData trashdata;
-    char        trashbuf [8];
-
     for (vector<string>::const_iterator it = fields.begin(); it != fields.end(); ++it) {
         const string & fieldspec = *it;        
         /* each <field> is "<fieldtype>(\[array length\])? <fieldname>" */
@@ -449,39 +486,39 @@ void OnboardLogParserULG::_register_format
 
             /* TODO: consolidate char[] to string */
 
-            /* register field while unrolling arrays, if any */
-            for (unsigned int e=0; e<elems;++e) {
-                field_t      field;
-                unsigned int flen = 0;
-
-                if (elems > 1) {
-                    stringstream ss;
-                    ss << fieldname;
-                    ss << "_" << e;
-                    field.name = ss.str();
-                } else {
-                    field.name = fieldname;
-                }
-
-                // TODO: They also use types that they defined in defs, and furthermore types can be used before they are defined.
+            // TODO: They also use types that they defined in defs, and furthermore types can be used before they are defined.
+            field_t field;
+            if (!_get_field_type (fieldtype, field.type)) {
+                _log (MSG_ERR, stringbuilder() <<
+                      "Unsupported field type '" << fieldtype <<
+                      "' in field '" << fieldname << "' in FMT for " << name);
+                return;
+            }
+            const unsigned int flen = _get_field_size (field.type);
 
-                // set up callback and accumulate msg length
-                field.decode = _get_field_reader (fieldtype);
-                if (NULL == field.decode) {
-                    _log (MSG_ERR, stringbuilder() <<
-                          "Unsupported field type '" << fieldtype <<
-                          "' in field '" << fieldname << "' in FMT for " << name);
-                    return;
+            /* register field while unrolling arrays, if any. Padding takes space, but is not decoded. */
+            const bool padding = is_padding (fieldname);
+            for (unsigned int e=0; e<elems;++e) {
+                if (!padding) {
+                    if (elems > 1) {
+                        stringstream ss;
+                        ss << fieldname;
+                        ss << "_" << e;
+                        field.name = ss.str();
+                    } else {
+                        field.name = fieldname;
+                    }
+                    field.offset = fmt.datalen;
+                    fmt.fields.push_back(field);
                 }
-
-                // dry run to find field length
-                flen = field.decode (trashbuf, field.name, trashdata);
-                fmt.fields.push_back(field);
-
                 fmt.datalen += flen;
             }
         }
     }
+    fmt.schema = _add_schema(name);
+    for (vector<field_t>::iterator it = fmt.fields.begin(); it != fmt.fields.end(); ++it) {
+        it->id = fmt.schema->add_field(it->name, OnboardColumns::get_field_type(_get_column_type(it->type)));
+    }
     _formats [name] = fmt;
     _log (MSG_DBG, stringbuilder() << "FMT: " << name <<", len=" << fmt.datalen << ", fmt=" << strfields);    
 }
@@ -506,11 +543,19 @@ void OnboardLogParserULG::_register_message_id
     }
 }
 
+void OnboardLogParserULG::_handle_add_logged_msg(void) {
+    if (_buflen < 3) return;
+    const char*const topic = (const char*)_msg + 3;
+    string topic_name(topic, strnlen(topic, _buflen - 3));
+    uint16_t msg_id = load_u16le(_msg + 1);
+    uint8_t  multi_id = _msg[0];
+    _register_message_id (topic_name, multi_id, msg_id);
+}
+
 bool OnboardLogParserULG::_decode_str_msg (uint16_t msglen, OnboardData & ret) {
-    uint8_t lvl = (uint8_t)_buffer[0];
-    int n = read_uint64(_buffer + 1, "timestamp", ret);
-    assert (n==8);
     const unsigned int STRING_OFF = 9;
+    if (msglen < STRING_OFF) return false;
+    uint8_t lvl = _msg[0];
     const unsigned int elems = msglen - STRING_OFF;
 
     string strlvl = "UNKNOWN";
@@ -526,9 +571,14 @@ bool OnboardLogParserULG::_decode_str_msg (uint16_t msglen, OnboardData & ret) {
         default: break;
     }
 
-    ret._msgname_orig = "messages";
-    ret._msgname_readable = _make_readable_name (ret._msgname_orig);
-    ret._string_data [strlvl] = string(_buffer + STRING_OFF, elems);
+    OnboardSchema & schema = _get_keyed_schema("messages", strlvl);
+    if (schema.empty()) {
+        schema.add_field("timestamp", OnboardSchema::FIELD_UINT);
+        schema.add_field(strlvl, OnboardSchema::FIELD_STRING);
+    }
+    ret.reset(&schema);
+    ret.set_uint(0, load<uint64_t>(_msg + 1));
+    ret.set_string(1).assign((const char*)_msg + STRING_OFF, elems);
     ret._valid = true;
     return true;
 }
@@ -538,8 +588,9 @@ bool OnboardLogParserULG::_decode_str_msg (uint16_t msglen, OnboardData & ret) {
  * @return true if successfully parsed, else false
  */
 bool OnboardLogParserULG::_decode_info_msg (uint16_t msglen, OnboardData & ret) {
-    const uint8_t keylen = _buffer[0];
-    string strkey (_buffer+1, keylen);
+    const uint8_t keylen = _msg[0];
+    if (1U + keylen > msglen) return false;
+    string strkey ((const char*)_msg+1, keylen);
 
     size_t pos = strkey.find(' ');
     if (pos == string::npos) {
@@ -557,91 +608,221 @@ bool OnboardLogParserULG::_decode_info_msg (uint16_t msglen, OnboardData & ret)
     }
 
     // good to parse now
-    char*read = _buffer + 1 + keylen;
-    if (typname == "char") {
-        assert ((int)elems == msglen - keylen - 1); // not sure about this one. doc does not say what value elems would be carrying
-        ret._string_data [desc] = string(read, elems);
-    } else if (typname == "uint32_t") {
-        for (unsigned int e=0; e<elems; ++e) {
-            read += read_uint32 (read, desc, ret);
-        }
-    } else if (typname == "int32_t") {
-        for (unsigned int e=0; e<elems; ++e) {
-            read += read_uint32 (read, desc, ret);
-        }
-    } else {
+    const uint8_t*read = _msg + 1 + keylen;
+    const uint8_t*const end = _msg + msglen;
+    const bool is_string = (typname == "char");
+    if (!is_string && typname != "uint32_t" && typname != "int32_t") {
         _log (MSG_ERR, stringbuilder() <<
               "Unsupported type of info message '" << desc << "'");
         return false;
     }
-    ret._msgname_orig = "info";
-    ret._msgname_readable = _make_readable_name (ret._msgname_orig);
+    OnboardSchema & schema = _get_keyed_schema("info", strkey);
+    if (schema.empty()) {
+        schema.add_field(desc, is_string ? OnboardSchema::FIELD_STRING : OnboardSchema::FIELD_UINT);
+    }
+    ret.reset(&schema);
+    if (is_string) {
+        assert ((int)elems == msglen - keylen - 1); // not sure about this one. doc does not say what value elems would be carrying
+        ret.set_string(0).assign((const char*)read, end - read);
+    } else {
+        for (unsigned int e=0; e<elems && read + 4 <= end; ++e) {
+            ret.set_uint(0, load<uint32_t>(read));
+            read += 4;
+        }
+    }
     ret._valid = true;
     return true;
 }
 
 /**
- * @brief read _buffer and decode data message
- * @return true on success, else false
+ * @brief find the decode plan for a data message
+ * @return NULL if there is none
  */
-bool OnboardLogParserULG::_decode_data_msg(uint16_t msg_id, OnboardData & ret) {
+const OnboardLogParserULG::format_t* OnboardLogParserULG::_find_format(uint16_t msg_id) const {
     name_map_t::const_iterator it_name = _message_name.find (msg_id);
-    if (it_name == _message_name.end()) return false;
+    if (it_name == _message_name.end()) return NULL;
 
-    // find format spec
-    const std::string & message_name = it_name->second;
-    format_map_t::const_iterator it_fmt = _formats.find (message_name);
-    if (it_fmt == _formats.end()) return false;
-    const format_t & fmt = it_fmt->second;
+    format_map_t::const_iterator it_fmt = _formats.find (it_name->second);
+    if (it_fmt == _formats.end()) return NULL;
+    return &it_fmt->second;
+}
 
-    // message is already in _buffer
-    // first two bytes are the msg_id
-    const unsigned int DATA_OFF = 2;
-    assert (_buflen == fmt.datalen + DATA_OFF);
+/**
+ * @brief decode data message in _msg into an OnboardData
+ * @return true on success, else false
+ */
+bool OnboardLogParserULG::_decode_data_msg(uint16_t msg_id, OnboardData & ret) {
+    const format_t*const fmt = _find_format(msg_id);
+    if (!fmt) return false;
+    if (_buflen < fmt->datalen + (unsigned int) ULOG_DATA_OFF) return false;
+    ret.reset(fmt->schema);
 
     // decode fields one by one
-    char*readptr = _buffer + DATA_OFF; // data starts after msg_id
-    for (std::vector<field_t>::const_iterator it = fmt.fields.begin(); it != fmt.fields.end(); ++it) {
+    const uint8_t*const data = _msg + ULOG_DATA_OFF; // data starts after msg_id
+    for (std::vector<field_t>::const_iterator it = fmt->fields.begin(); it != fmt->fields.end(); ++it) {
         const field_t & f = *it;
-        assert (NULL != f.decode);
-        readptr += f.decode (readptr, f.name, ret);
-        assert (readptr <= _buffer + fmt.datalen + DATA_OFF);
+        const uint8_t*const p = data + f.offset;
+        switch (f.type) {
+        case FIELD_INT8:   ret.set_int(f.id, load<int8_t>(p)); break;
+        case FIELD_UINT8:  ret.set_uint(f.id, load<uint8_t>(p)); break;
+        case FIELD_INT16:  ret.set_int(f.id, load<int16_t>(p)); break;
+        case FIELD_UINT16: ret.set_uint(f.id, load<uint16_t>(p)); break;
+        case FIELD_INT32:  ret.set_int(f.id, load<int32_t>(p)); break;
+        case FIELD_UINT32: ret.set_uint(f.id, load<uint32_t>(p)); break;
+        case FIELD_INT64:  ret.set_int(f.id, load<int64_t>(p)); break;
+        case FIELD_UINT64: ret.set_uint(f.id, load<uint64_t>(p)); break;
+        case FIELD_FLOAT:  ret.set_float(f.id, load<float>(p)); break;
+        case FIELD_DOUBLE: ret.set_float(f.id, load<double>(p)); break;
+        }
     }
-    assert (readptr == _buffer + fmt.datalen + DATA_OFF);
-
-    // set message name et. al
-    ret._msgname_orig = message_name;
-    ret._msgname_readable = _make_readable_name (ret._msgname_orig);
     ret._valid = true;
 
     return true;
 }
 
-OnboardData OnboardLogParserULG::get_data(void) {
-    OnboardData ret;
-    if (!valid) return ret;
+/**
+ * @brief decodes a piece of a table in the thread pool
+ */
+class ULogRowsWorker : public QRunnable {
+public:
+    ULogRowsWorker(const OnboardLogParserULG::format_t & fmt, const uint8_t*const*msgs, unsigned int n,
+                   OnboardColumns::table_t & tab, unsigned int row0) :
+        _fmt(fmt), _msgs(msgs), _n(n), _tab(tab), _row0(row0) {}
+    void run() { OnboardLogParserULG::_decode_rows(_fmt, _msgs, _n, _tab, _row0); }
+private:
+    const OnboardLogParserULG::format_t & _fmt;
+    const uint8_t*const* _msgs;
+    unsigned int         _n;
+    OnboardColumns::table_t & _tab;
+    unsigned int         _row0;
+};
+
+/**
+ * @brief find the table for a msg_id, and set it up the first time
+ * @return index of table, or TABLE_BROKEN
+ */
+int OnboardLogParserULG::_get_table(uint16_t msg_id, OnboardColumns &cols) {
+    if (msg_id >= _table_of_id.size()) {
+        _table_of_id.resize(msg_id + 1, TABLE_UNKNOWN);
+        _format_of_id.resize(msg_id + 1, NULL);
+    }
+    if (TABLE_UNKNOWN != _table_of_id[msg_id]) return _table_of_id[msg_id];
+
+    const format_t*const fmt = _find_format(msg_id);
+    int t = TABLE_BROKEN;
+    if (fmt) {
+        t = cols.get_or_add_table(fmt->schema);
+        const OnboardColumns::table_t & tab = cols.tables[t];
+        if (tab.columns.size() != fmt->fields.size() || t >= (int)OnboardColumns::OTHER) {
+            t = TABLE_BROKEN;
+        } else {
+            if ((unsigned int) t >= _format_of_table.size()) _format_of_table.resize(t + 1, NULL);
+            _format_of_table[t] = fmt;
+        }
+    }
+    if (TABLE_BROKEN == t) {
+        _log (MSG_ERR, stringbuilder() << "Cannot decode messages with id " << msg_id << ". Skipping all of them.");
+    }
+    _table_of_id[msg_id] = t;
+    _format_of_id[msg_id] = fmt;
+    return t;
+}
+
+void OnboardLogParserULG::_resize_columns(OnboardColumns::table_t &tab, unsigned int rows) {
+    for (vector<OnboardColumns::column_t>::iterator it = tab.columns.begin(); it != tab.columns.end(); ++it) {
+        switch (it->type) {
+        case OnboardColumns::COL_FLOAT: it->floatdata.resize(rows); break;
+        case OnboardColumns::COL_INT:   it->intdata.resize(rows); break;
+        case OnboardColumns::COL_UINT:  it->uintdata.resize(rows); break;
+        }
+    }
+}
+
+void OnboardLogParserULG::_decode_rows(const format_t &fmt, const uint8_t*const*msgs, unsigned int n,
+                                       OnboardColumns::table_t &tab, unsigned int row0) {
+    // column by column, which keeps the writes sequential
+    const unsigned int nfields = fmt.fields.size();
+    for (unsigned int k=0; k < nfields; ++k) {
+        const field_t & f = fmt.fields[k];
+        OnboardColumns::column_t & c = tab.columns[k];
+        const unsigned int off = ULOG_DATA_OFF + f.offset; // data starts after msg_id
+        for (unsigned int j=0; j < n; ++j) {
+            const uint8_t*const p = msgs[j] + off;
+            const unsigned int row = row0 + j;
+            switch (f.type) {
+            case FIELD_INT8:   c.intdata[row] = load<int8_t>(p); break;
+            case FIELD_UINT8:  c.uintdata[row] = load<uint8_t>(p); break;
+            case FIELD_INT16:  c.intdata[row] = load<int16_t>(p); break;
+            case FIELD_UINT16: c.uintdata[row] = load<uint16_t>(p); break;
+            case FIELD_INT32:  c.intdata[row] = load<int32_t>(p); break;
+            case FIELD_UINT32: c.uintdata[row] = load<uint32_t>(p); break;
+            case FIELD_INT64:  c.intdata[row] = load<int64_t>(p); break;
+            case FIELD_UINT64: c.uintdata[row] = load<uint64_t>(p); break;
+            case FIELD_FLOAT:  c.floatdata[row] = load<float>(p); break;
+            case FIELD_DOUBLE: c.floatdata[row] = load<double>(p); break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief decode data message in _msg by appending a row to its table
+ * @return true on success, else false
+ */
+bool OnboardLogParserULG::_decode_data_columns(uint16_t msg_id, OnboardColumns &cols) {
+    const int t = _get_table(msg_id, cols);
+    if (t < 0) return false;
+
+    const format_t & fmt = *_format_of_id[msg_id];
+    if (_buflen < fmt.datalen + (unsigned int) ULOG_DATA_OFF) {
+        _log (MSG_ERR, stringbuilder() << "Cannot decode message with id " << msg_id);
+        return false;
+    }
+
+    OnboardColumns::table_t & tab = cols.tables[t];
+    _resize_columns(tab, tab.rows + 1);
+    _decode_rows(fmt, &_msg, 1, tab, tab.rows);
+    tab.rows++;
+    cols.order.push_back((uint16_t) t);
+    return true;
+}
+
+/**
+ * @brief decode an INFO or LOGGING message in _msg into OnboardColumns::others
+ * @return true on success, else false
+ */
+bool OnboardLogParserULG::_decode_other_columns(int typ, OnboardColumns &cols) {
+    // rare, so these stay as they are
+    const bool ok = (typ == (int)INFO) ? _decode_info_msg (_buflen, _other) : _decode_str_msg (_buflen, _other);
+    if (!ok) {
+        _log (MSG_ERR, stringbuilder() << "Cannot decode " << (typ == (int)INFO ? "info" : "string (logging)") << " message");
+        return false;
+    }
+    cols.others.push_back(_other);
+    cols.order.push_back(OnboardColumns::OTHER);
+    return true;
+}
+
+void OnboardLogParserULG::get_data(OnboardData & ret) {
+    ret.reset(NULL);
+    if (!valid) return;
 
     int typ;
     if (_get_next_message(typ)) {
 
-        // _buffer now contains the message only
+        // _msg now points to the message only
 
         switch (typ) {
         case (int) ADD_LOGGED_MSG: // 65
-            {
-                string topic_name(_buffer + 3);
-                uint16_t msg_id = ((uint16_t) _buffer[1]) | (((uint16_t) _buffer[2]) << 8);
-                uint8_t  multi_id = (uint8_t) _buffer[0];
-                _register_message_id (topic_name, multi_id, msg_id);
-            }
+            _handle_add_logged_msg();
             break;
 
         case (int)DATA: // 68
             {
-                uint16_t msg_id = ((uint16_t) _buffer[0]) | (((uint16_t) _buffer[1]) << 8);
+                uint16_t msg_id = load_u16le(_msg);
                 if (!_decode_data_msg (msg_id, ret)) {
                     _log (MSG_ERR, stringbuilder() << "Cannot decode message with id " << msg_id);                    
-                    return OnboardData();
+                    return; // invalid
                 }
             }
             break;
@@ -650,7 +831,7 @@ OnboardData OnboardLogParserULG::get_data(void) {
             {
                 if (!_decode_info_msg (_buflen, ret)) {
                     _log (MSG_ERR, stringbuilder() << "Cannot decode info message");
-                    return OnboardData();
+                    return; // invalid
                 }
             }
             break;
@@ -659,7 +840,7 @@ OnboardData OnboardLogParserULG::get_data(void) {
             {
                 if (!_decode_str_msg (_buflen, ret)) {
                     _log (MSG_ERR, stringbuilder() << "Cannot decode string (logging) message");
-                    return OnboardData();
+                    return; // invalid
                 }
             }
             break;
@@ -674,17 +855,132 @@ OnboardData OnboardLogParserULG::get_data(void) {
 
         default:
             _log (MSG_ERR, stringbuilder() << "Unknown message type " << typ);
-            return OnboardData();
+            return; // invalid
             assert (false); // must not happen
             break;
         }
     }
+}
+
+bool OnboardLogParserULG::get_columns(OnboardColumns &cols, unsigned int max_msgs) {
+    if (!valid) return false;
+    if (_nthreads > 1 && _src->get_data()) {
+        return _get_columns_parallel(cols, max_msgs);
+    }
+
+    unsigned int n = 0;
+    int typ;
+    while (n < max_msgs && _get_next_message(typ)) {
+        switch (typ) {
+        case (int) ADD_LOGGED_MSG:
+            _handle_add_logged_msg();
+            break;
+
+        case (int)DATA:
+            if (_buflen >= ULOG_DATA_OFF && _decode_data_columns (load_u16le(_msg), cols)) {
+                n++;
+            }
+            break;
+
+        case (int)INFO: // fallthrough
+        case (int)LOGGING:
+            if (_decode_other_columns(typ, cols)) {
+                n++;
+            }
+            break;
+
+        case (int)SYNC://fallthrough
+        case (int)REMOVE_LOGGED_MSG://fallthrough
+        case (int)PARAMETER://fallthrough
+        case (int)INFO_MULTIPLE://fallthrough
+        case (int)DROPOUT://fallthrough
+            // skip;
+            break;
+
+        default:
+            _log (MSG_ERR, stringbuilder() << "Unknown message type " << typ);
+            break;
+        }
+    }
+    return valid;
+}
+
+bool OnboardLogParserULG::_get_columns_parallel(OnboardColumns &cols, unsigned int max_msgs) {
+    for (vector<vector<const uint8_t*> >::iterator it = _msgs_of_table.begin(); it != _msgs_of_table.end(); ++it) {
+        it->clear();
+    }
 
-    return ret;
+    /*
+     * Framing pass: with mmap, _msg points into the file and stays valid, so it suffices
+     * to remember where the DATA messages are. Everything else is rare and handled right away.
+     */
+    unsigned int n = 0;
+    int typ;
+    while (n < max_msgs && _get_next_message(typ)) {
+        switch (typ) {
+        case (int) ADD_LOGGED_MSG:
+            _handle_add_logged_msg();
+            break;
+
+        case (int)DATA:
+        {
+            if (_buflen < ULOG_DATA_OFF) break;
+            const uint16_t msg_id = load_u16le(_msg);
+            const int t = _get_table(msg_id, cols);
+            if (t < 0) break;
+            if (_buflen < _format_of_id[msg_id]->datalen + (unsigned int) ULOG_DATA_OFF) {
+                _log (MSG_ERR, stringbuilder() << "Cannot decode message with id " << msg_id);
+                break;
+            }
+            if ((unsigned int) t >= _msgs_of_table.size()) _msgs_of_table.resize(t + 1);
+            _msgs_of_table[t].push_back(_msg);
+            cols.order.push_back((uint16_t) t);
+            n++;
+        }
+            break;
+
+        case (int)INFO: // fallthrough
+        case (int)LOGGING:
+            if (_decode_other_columns(typ, cols)) {
+                n++;
+            }
+            break;
+
+        case (int)SYNC://fallthrough
+        case (int)REMOVE_LOGGED_MSG://fallthrough
+        case (int)PARAMETER://fallthrough
+        case (int)INFO_MULTIPLE://fallthrough
+        case (int)DROPOUT://fallthrough
+            // skip;
+            break;
+
+        default:
+            _log (MSG_ERR, stringbuilder() << "Unknown message type " << typ);
+            break;
+        }
+    }
+
+    // decoding pass: every worker fills its own rows of one table
+    _pool.setMaxThreadCount(_nthreads);
+    for (unsigned int t=0; t < _msgs_of_table.size(); ++t) {
+        const vector<const uint8_t*> & msgs = _msgs_of_table[t];
+        if (msgs.empty()) continue;
+        OnboardColumns::table_t & tab = cols.tables[t];
+        const unsigned int row0 = tab.rows;
+        _resize_columns(tab, row0 + msgs.size());
+        for (unsigned int j=0; j < msgs.size(); j += ROWS_PER_WORKER) {
+            unsigned int m = msgs.size() - j;
+            if (m > ROWS_PER_WORKER) m = ROWS_PER_WORKER;
+            _pool.start(new ULogRowsWorker(*_format_of_table[t], &msgs[j], m, tab, row0 + j));
+        }
+        tab.rows += msgs.size();
+    }
+    _pool.waitForDone();
+    return valid;
 }
 
 bool OnboardLogParserULG::has_more_data(void) {
     if (!valid) return false;
 
-    return (_filebuf.sgetc() != std::char_traits<char>::eof());
+    return _have_pending_header || !_cur.at_end();
 }
@@ -21,42 +21,57 @@
 
  */
 
+
 #ifndef ONBOARDLOGPARSERULG_H
 #define ONBOARDLOGPARSERULG_H
 
-#include <fstream>
 #include <inttypes.h>
 #include <string>
+#include <vector>
 #include <map>
+#include <QThreadPool>
 #include "onboardlogparser.h"
+#include "bytesource.h"
 #include "logger.h"
 
-#define ULOG_BUFLEN 2048
-
-/**
- * @brief callback function pointer for field/type readers
- */
-typedef int (*Read_Field_Function)(const char*const buf, const std::string &name, OnboardData & data);
-
 /**
  * @brief implements a Ulog parser. See https://dev.px4.io/en/log/ulog_file_format.html
  * Closefly following PX4 firmware / replay (Apache 2.0 license).
+ *
+ * Every FORMAT is compiled once into a decode plan (offset and type of each field). DATA
+ * messages are then read straight from the (mapped) file, either into an OnboardData with
+ * get_data(), or much faster into columns with get_columns().
+ *
+ * With several threads (set_threads()) and a mapped file, get_columns() first only frames the
+ * messages of the batch and sorts the DATA messages by table. The tables are then decoded in
+ * pieces on a thread pool, each piece into its own rows. The order of the messages is kept
+ * in OnboardColumns::order, so the scenario gets the same result as before.
  */
 class OnboardLogParserULG : public OnboardLogParser {
 public:    
+    OnboardLogParserULG();
+    ~OnboardLogParserULG();
 
     // implement OnboardLogParser::get_data
-    OnboardData get_data(void);
+    void get_data(OnboardData & ret);
 
     // implement OnboardLogParser::has_more_data
     bool has_more_data(void);
 
+    // implement OnboardLogParser::get_columns
+    bool has_columns(void) const { return true; }
+    bool get_columns(OnboardColumns & cols, unsigned int max_msgs);
+    void set_threads(unsigned int nthreads) { _nthreads = nthreads > 0 ? nthreads : 1; }
+
     static std::string get_extension(void) { return "ulg"; }
 
 
     // implement super
     std::string get_parser_name(void) const { return "ulg"; }
 
+    // implement super
+    uint64_t get_bytes_consumed(void) const { return _src ? _src->get_position() : 0; }
+
     // implement super
     bool Load (std::string filename, Logger::logchannel * ch = NULL);
 
@@ -82,18 +97,36 @@ private:
         LOGGING = 'L' ///< Logged string message
     } ULogMessageType;
 
+    /**
+     * @brief how to load a field
+     */
+    typedef enum {
+        FIELD_INT8, FIELD_UINT8, FIELD_INT16, FIELD_UINT16, FIELD_INT32, FIELD_UINT32,
+        FIELD_INT64, FIELD_UINT64, FIELD_FLOAT, FIELD_DOUBLE
+    } fieldtype_e;
+
     typedef struct field_s {
-        std::string          name;
-        Read_Field_Function  decode; ///< callback to decode field
+        std::string  name;
+        fieldtype_e  type;
+        uint16_t     offset; ///< from beginning of the data (after msg_id)
+        unsigned int id;     ///< in the schema
     } field_t;
 
+    /**
+     * @brief decode plan for one message type
+     */
     typedef struct format_s {
         uint16_t             datalen;
-        std::vector<field_t> fields;
+        std::vector<field_t> fields; ///< padding is not in here
+        OnboardSchema*       schema;
     } format_t;
 
     typedef std::map<std::string, format_t> format_map_t;
-    typedef std::map<uint8_t, std::string>  name_map_t;
+    typedef std::map<uint16_t, std::string> name_map_t;
+
+    static const int TABLE_UNKNOWN = -1; ///< msg_id has not been seen in get_columns() yet
+    static const int TABLE_BROKEN = -2;  ///< msg_id cannot be decoded
+    static const unsigned int ROWS_PER_WORKER = 16384; ///< piece of a table that one worker decodes
 
     /*******************
      * METHODS
@@ -103,34 +136,64 @@ private:
     bool _get_defs(void);
     bool _get_defs_flagbits(uint16_t siz);
     bool _get_defs_format(uint16_t siz);
-    bool _get_defs_param(uint16_t siz);
     bool _get_log_message(int&typ);
     void _register_format(const std::string & name, const std::string & strfields);
     void _register_message_id(const std::string & name, uint8_t, uint16_t msg_id);
+    void _handle_add_logged_msg(void);
+    const format_t* _find_format(uint16_t msg_id) const;
     bool _decode_data_msg(uint16_t msg_id, OnboardData & ret);
+    bool _decode_data_columns(uint16_t msg_id, OnboardColumns & cols);
+    int  _get_table(uint16_t msg_id, OnboardColumns & cols);
+    bool _decode_other_columns(int typ, OnboardColumns & cols);
+    bool _get_columns_parallel(OnboardColumns & cols, unsigned int max_msgs);
+
+    /**
+     * @brief decode DATA messages into the given rows of a table; columns must be large enough
+     * @param msgs the messages, without header
+     */
+    static void _decode_rows(const format_t & fmt, const uint8_t*const*msgs, unsigned int n,
+                             OnboardColumns::table_t & tab, unsigned int row0);
+    static void _resize_columns(OnboardColumns::table_t & tab, unsigned int rows);
     bool _decode_info_msg(uint16_t msglen, OnboardData & ret);
     bool _decode_str_msg(uint16_t msglen, OnboardData & ret);
     unsigned int _find_array_spec (std::string & fieldtype);
-    Read_Field_Function _get_field_reader (const std::string & fieldtype);
+    static bool _get_field_type (const std::string & fieldtype, fieldtype_e & type);
+    static unsigned int _get_field_size (fieldtype_e type);
+    static OnboardColumns::coltype_e _get_column_type (fieldtype_e type);
     void _log(logmsgtype_e t, const std::string & str);
 
     /*******************
      * ATTRIBUTES
      *******************/
     std::string        _filename;
-    std::filebuf       _filebuf;
     Logger::logchannel*_logchannel;
 
     typedef enum state_s {WAIT_HEADER, WAIT_DEFS, WAIT_DATA} state_e;
 
-    char         _buffer[ULOG_BUFLEN];
-    unsigned int _buflen;
-    state_e      _state;
+    // reading
+    ByteSource*          _src;
+    ByteCursor           _cur;      ///< stops before appended data
 
-    uint64_t     _read_until_file_position; ///< read limit if log contains appended data
+    const uint8_t* _msg;    ///< the current message, without header
+    unsigned int   _buflen; ///< length of _msg
+    state_e        _state;
+    bool           _have_pending_header; ///< header of first data message has been read with the defs
+    uint16_t       _pending_size;
+    uint8_t        _pending_type;
 
     format_map_t _formats;
     name_map_t   _message_name;
+    std::vector<int>             _table_of_id;  ///< msg_id -> table in OnboardColumns, or TABLE_*
+    std::vector<const format_t*> _format_of_id; ///< msg_id -> plan, valid if _table_of_id >= 0
+    std::vector<const format_t*> _format_of_table; ///< table in OnboardColumns -> plan
+
+    // threads
+    unsigned int   _nthreads;
+    QThreadPool    _pool;
+    std::vector<std::vector<const uint8_t*> > _msgs_of_table; ///< DATA messages of the batch, by table
+    OnboardData    _other; ///< scratch for messages which are not in a table
+
+    friend class ULogRowsWorker;
 };
 
 #endif // ONBOARDLOGPARSERULG_H
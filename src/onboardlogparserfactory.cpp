@@ -25,11 +25,13 @@
 #include "onboardlogparser_apm.h"
 #include "onboardlogparser_px4.h"
 #include "onboardlogparser_ulg.h"
+#include "onboardlogparser_bin.h"
 
 OnboardLogParserFactory::OnboardLogParserFactory() {
     Register (OnboardLogParserPX4::get_extension(), &OnboardLogParserPX4::make_instance);
     Register (OnboardLogParserAPM::get_extension(), &OnboardLogParserAPM::make_instance);
     Register (OnboardLogParserULG::get_extension(), &OnboardLogParserULG::make_instance);
+    Register (OnboardLogParserBIN::get_extension(), &OnboardLogParserBIN::make_instance);
 }
 
 bool OnboardLogParserFactory::Register (const std::string & ext, Create_Parser_Function func) {
@@ -0,0 +1,297 @@
+/**
+ * @file resampler.h
+ * @brief Brings several timeseries onto one time base
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <vector>
+#include <algorithm>
+#include <math.h>
+#include "data_timeseries.h"
+
+/**
+ * @brief samples K timeseries at the same times, e.g.:
+ *
+ *   Resampler<float> rs(Resampler<float>::RESAMPLE_LINEAR);
+ *   const unsigned int c_volt = rs.add_series(data_volt);
+ *   const unsigned int c_amps = rs.add_series(data_amps);
+ *   rs.set_grid_series(data_volt);
+ *   rs.run();
+ *   ... rs.get_time()[k], rs.get_column(c_volt)[k], rs.get_column(c_amps)[k]
+ *
+ * Each series is walked once alongside the grid. Between two samples, the values are written
+ * by a short loop over plain arrays, without branches. Where a series has no value (before its first or
+ * after its last sample, i.e., no extrapolation), get_valid() is false and its column holds NAN.
+ * Use the former to tell, since a series can have NAN samples.
+ *
+ * The series may have different epochs. Times are relative to get_epoch_datastart(), which
+ * is the earliest epoch of all series involved. The times of each series must be ordered.
+ */
+template <typename T>
+class Resampler {
+public:
+    typedef enum {
+        RESAMPLE_LINEAR,   ///< like DataTimeseries::get_data_at_time()
+        RESAMPLE_PREVIOUS, ///< last sample at or before
+        RESAMPLE_NEAREST   ///< closest sample; the earlier one on a tie
+    } method_e;
+
+    Resampler(method_e method = RESAMPLE_LINEAR) : _method(method), _grid(GRID_UNION), _grid_rate(0.), _grid_series(NULL), _epoch_usec(0) {}
+
+    /**
+     * @brief adds a column
+     * @return the index of the column, for get_column()
+     */
+    unsigned int add_series(const DataTimeseries<T>*ts) {
+        _series.push_back(ts);
+        return _series.size() - 1;
+    }
+
+    /**
+     * @brief sample at every time where any series has a sample. This is the default.
+     */
+    void set_grid_union(void) {
+        _grid = GRID_UNION;
+    }
+
+    /**
+     * @brief sample periodically over the time spanned by all series
+     */
+    void set_grid_rate(double rate_hz) {
+        _grid = GRID_RATE;
+        _grid_rate = rate_hz;
+    }
+
+    /**
+     * @brief sample at the times of this series. It does not need to be a column, too.
+     */
+    void set_grid_series(const DataTimeseries<T>*ts) {
+        _grid = GRID_SERIES;
+        _grid_series = ts;
+    }
+
+    /**
+     * @brief builds the grid and the columns
+     * @return false if there is no grid, e.g., because of a NULL series. The columns are empty then.
+     */
+    bool run(void) {
+        _time.clear();
+        _columns.assign(_series.size(), std::vector<double>());
+        _valid.assign(_series.size(), std::vector<char>());
+        if (!_choose_epoch()) return false;
+        _build_grid();
+        if (_time.empty()) return false;
+
+        for (unsigned int c=0; c < _series.size(); ++c) {
+            _resample(*_series[c], _columns[c], _valid[c]);
+        }
+        return true;
+    }
+
+    unsigned long get_epoch_datastart() const {
+        return _epoch_usec;
+    }
+
+    /**
+     * @brief how many samples each column has
+     */
+    size_t size() const {
+        return _time.size();
+    }
+
+    const std::vector<double>& get_time() const {
+        return _time;
+    }
+
+    const std::vector<double>& get_column(unsigned int c) const {
+        return _columns[c];
+    }
+
+    /**
+     * @brief like get_column(), but whether the series has a value there
+     */
+    const std::vector<char>& get_valid(unsigned int c) const {
+        return _valid[c];
+    }
+
+private:
+    typedef enum {
+        GRID_UNION,
+        GRID_RATE,
+        GRID_SERIES
+    } grid_e;
+
+    /**
+     * @brief the earliest epoch of all series which have data
+     */
+    bool _choose_epoch(void) {
+        if (_grid == GRID_SERIES && !_grid_series) return false;
+        bool first = true;
+        for (unsigned int c=0; c <= _series.size(); ++c) {
+            const DataTimeseries<T>*const ts = (c < _series.size()) ? _series[c] : _grid_series;
+            if (!ts) {
+                if (c < _series.size()) return false;
+                continue;
+            }
+            if (ts->get_time().empty()) continue;
+            if (first || ts->get_epoch_datastart() < _epoch_usec) {
+                _epoch_usec = ts->get_epoch_datastart();
+                first = false;
+            }
+        }
+        return !first;
+    }
+
+    /**
+     * @brief add this to the times of ts to get ours
+     */
+    double _offset(const DataTimeseries<T> & ts) const {
+        return (((double)ts.get_epoch_datastart()) - ((double)_epoch_usec)) / 1E6;
+    }
+
+    void _append_times(const DataTimeseries<T> & ts) {
+        const typename DataTimeseries<T>::timevector & t = ts.get_time();
+        const double offset = _offset(ts);
+        const size_t first = _time.size();
+        _time.resize(first + t.size());
+        size_t n;
+        for (size_t k=0; k < t.size(); k += n) {
+            const double*const seg = t.segment(k, n);
+            double*const out = &_time[first + k];
+            for (size_t j=0; j < n; ++j) out[j] = seg[j] + offset;
+        }
+    }
+
+    void _build_grid(void) {
+        switch (_grid) {
+        case GRID_SERIES:
+            _append_times(*_grid_series);
+            break;
+
+        case GRID_UNION:
+            // the series are sorted already, so merge them one by one
+            for (unsigned int c=0; c < _series.size(); ++c) {
+                const size_t mid = _time.size();
+                _append_times(*_series[c]);
+                std::inplace_merge(_time.begin(), _time.begin() + mid, _time.end());
+            }
+            _time.erase(std::unique(_time.begin(), _time.end()), _time.end());
+            break;
+
+        case GRID_RATE:
+        {
+            if (!(_grid_rate > 0.)) break;
+            double tmin = INFINITY, tmax = -INFINITY;
+            for (unsigned int c=0; c < _series.size(); ++c) {
+                const typename DataTimeseries<T>::timevector & t = _series[c]->get_time();
+                if (t.empty()) continue;
+                const double offset = _offset(*_series[c]);
+                if (t.front() + offset < tmin) tmin = t.front() + offset;
+                if (t.back() + offset > tmax) tmax = t.back() + offset;
+            }
+            if (tmax < tmin) break;
+            const double dt = 1.0 / _grid_rate;
+            const size_t n = (size_t)floor((tmax - tmin) / dt) + 1;
+            _time.resize(n);
+            for (size_t k=0; k < n; ++k) {
+                _time[k] = tmin + dt*k;
+            }
+            break;
+        }
+        }
+    }
+
+    /**
+     * @brief one pass over grid and series. Between two samples, the grid times form a contiguous
+     * range, and the values there follow from the two samples alone.
+     */
+    void _resample(const DataTimeseries<T> & ts, std::vector<double> & col, std::vector<char> & valid) const {
+        const typename DataTimeseries<T>::timevector & time = ts.get_time();
+        const typename DataTimeseries<T>::datavector & data = ts.get_data();
+        const size_t n = _time.size();
+        const size_t m = time.size();
+        col.resize(n);
+        const double*const g = &_time[0];
+        double*const out = &col[0];
+
+        // times of ts are shifted like in _append_times(), so that they hit its own grid exactly
+        const double offset = _offset(ts);
+        size_t i = 0, first = 0;
+        if (m > 0) {
+            // no extrapolation before the first sample
+            const double tfirst = time.front() + offset;
+            while (i < n && g[i] < tfirst) out[i++] = NAN;
+            first = i;
+
+            double t0 = tfirst, v0 = data[0];
+            for (size_t k=0; k < m && i < n; ++k) {
+                const double t1 = time[k] + offset, v1 = data[k];
+                size_t end = i;
+                while (end < n && g[end] < t1) ++end;
+
+                // strictly between samples k-1 and k
+                switch (_method) {
+                case RESAMPLE_LINEAR:
+                {
+                    // same arithmetic as DataTimeseries::get_data_at_time()
+                    const double slope = (v1 - v0)/(t1 - t0);
+                    for (size_t j=i; j < end; ++j) out[j] = v0 + (g[j] - t0)*slope;
+                    break;
+                }
+                case RESAMPLE_PREVIOUS:
+                    for (size_t j=i; j < end; ++j) out[j] = v0;
+                    break;
+
+                case RESAMPLE_NEAREST:
+                    for (size_t j=i; j < end; ++j) out[j] = (g[j] - t0 > t1 - g[j]) ? v1 : v0;
+                    break;
+                }
+
+                // exactly at sample k; the first one, if several have the same time
+                while (end < n && g[end] == t1) out[end++] = v1;
+                i = end;
+                t0 = t1;
+                v0 = v1;
+            }
+        }
+        // no extrapolation after the last sample
+        const size_t end = i;
+        while (i < n) out[i++] = NAN;
+
+        valid.assign(n, 0);
+        std::fill(valid.begin() + first, valid.begin() + end, 1);
+    }
+
+    method_e                                _method;
+    grid_e                                  _grid;
+    double                                  _grid_rate;
+    const DataTimeseries<T>*                _grid_series;
+    std::vector<const DataTimeseries<T>*>   _series;
+    unsigned long                           _epoch_usec;
+
+    std::vector<double>                     _time;
+    std::vector<std::vector<double> >       _columns;
+    std::vector<std::vector<char> >         _valid;   ///< like _columns
+};
+
+#endif // RESAMPLER_H
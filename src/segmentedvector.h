@@ -0,0 +1,296 @@
+/**
+ * @file segmentedvector.h
+ * @brief A sequence stored in fixed-size blocks, for long data series
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef SEGMENTEDVECTOR_H
+#define SEGMENTEDVECTOR_H
+
+#include <stddef.h>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+/**
+ * @brief like std::vector, but the elements are kept in blocks of BLOCK_SIZE, which never move.
+ * Growing at either end never copies what is there already, only the list of blocks. Random
+ * access is still O(1). Use segment() for loops over many elements, because the elements of
+ * one block are contiguous.
+ *
+ * Only the first block may have unused space in its front (after push_front), and only the last
+ * one in its back. As long as there is only one block, it grows like a vector, so that short
+ * series stay small.
+ */
+template <typename T>
+class SegmentedVector {
+public:
+    static const unsigned int BLOCK_BITS = 13;
+    static const size_t       BLOCK_SIZE = ((size_t)1) << BLOCK_BITS;
+
+    typedef T         value_type;
+    typedef size_t    size_type;
+    typedef ptrdiff_t difference_type;
+
+    /**
+     * @brief random access iterator over the elements
+     */
+    class const_iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T                               value_type;
+        typedef ptrdiff_t                       difference_type;
+        typedef const T*                        pointer;
+        typedef const T&                        reference;
+
+        const_iterator() : _v(NULL), _k(0) {}
+        const_iterator(const SegmentedVector*v, size_t k) : _v(v), _k(k) {}
+
+        reference operator*() const { return (*_v)[_k]; }
+        pointer operator->() const { return &(*_v)[_k]; }
+        reference operator[](difference_type d) const { return (*_v)[_k + d]; }
+        const_iterator& operator++() { ++_k; return *this; }
+        const_iterator& operator--() { --_k; return *this; }
+        const_iterator operator++(int) { const_iterator r(*this); ++_k; return r; }
+        const_iterator operator--(int) { const_iterator r(*this); --_k; return r; }
+        const_iterator& operator+=(difference_type d) { _k += d; return *this; }
+        const_iterator& operator-=(difference_type d) { _k -= d; return *this; }
+        const_iterator operator+(difference_type d) const { return const_iterator(_v, _k + d); }
+        const_iterator operator-(difference_type d) const { return const_iterator(_v, _k - d); }
+        difference_type operator-(const const_iterator & o) const { return (difference_type)_k - (difference_type)o._k; }
+        bool operator==(const const_iterator & o) const { return _k == o._k; }
+        bool operator!=(const const_iterator & o) const { return _k != o._k; }
+        bool operator<(const const_iterator & o) const { return _k < o._k; }
+        bool operator>(const const_iterator & o) const { return _k > o._k; }
+        bool operator<=(const const_iterator & o) const { return _k <= o._k; }
+        bool operator>=(const const_iterator & o) const { return _k >= o._k; }
+
+        /**
+         * @brief position in the SegmentedVector
+         */
+        size_t index() const { return _k; }
+
+    private:
+        const SegmentedVector*_v;
+        size_t                _k;
+    };
+
+    SegmentedVector() : _front(0), _size(0) {}
+
+    SegmentedVector(const SegmentedVector & other) : _front(0), _size(0) {
+        *this = other;
+    }
+
+    ~SegmentedVector() {
+        clear();
+    }
+
+    SegmentedVector& operator=(const SegmentedVector & other) {
+        if (this == &other) return *this;
+        clear();
+        for (typename blocklist::const_iterator it = other._blocks.begin(); it != other._blocks.end(); ++it) {
+            block*const b = new block((*it)->cap);
+            std::copy((*it)->elems, (*it)->elems + (*it)->size, b->elems);
+            b->size = (*it)->size;
+            _blocks.push_back(b);
+        }
+        _front = other._front;
+        _size = other._size;
+        return *this;
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    const T& operator[](size_t k) const {
+        const size_t g = k + _front;
+        return _blocks[g >> BLOCK_BITS]->elems[g & (BLOCK_SIZE - 1)];
+    }
+
+    T& operator[](size_t k) {
+        const size_t g = k + _front;
+        return _blocks[g >> BLOCK_BITS]->elems[g & (BLOCK_SIZE - 1)];
+    }
+
+    const T& front() const { return (*this)[0]; }
+    const T& back() const { return _blocks.back()->elems[_blocks.back()->size - 1]; }
+    T& front() { return (*this)[0]; }
+    T& back() { return _blocks.back()->elems[_blocks.back()->size - 1]; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, _size); }
+
+    /**
+     * @brief the elements from k on which are contiguous in memory
+     * @param n returns how many there are, at least one if k < size()
+     */
+    const T* segment(size_t k, size_t & n) const {
+        const size_t g = k + _front;
+        const block & b = *_blocks[g >> BLOCK_BITS];
+        const size_t o = g & (BLOCK_SIZE - 1);
+        n = b.size - o;
+        if (n > _size - k) n = _size - k;
+        return b.elems + o;
+    }
+
+    T* segment(size_t k, size_t & n) {
+        return const_cast<T*>(static_cast<const SegmentedVector*>(this)->segment(k, n));
+    }
+
+    void push_back(const T & x) {
+        block*const b = _back_with_space();
+        b->elems[b->size++] = x;
+        ++_size;
+    }
+
+    /**
+     * @brief O(1), except while there is only one block, which is then shifted like a vector
+     */
+    void push_front(const T & x) {
+        if (_front > 0) {
+            --_front;
+        } else if (!_blocks.empty() && _blocks.front()->size < BLOCK_SIZE) {
+            // the only block, and not full
+            block & b = *_blocks.front();
+            if (b.size == b.cap) b.grow(std::min(2*b.cap, BLOCK_SIZE));
+            std::copy_backward(b.elems, b.elems + b.size, b.elems + b.size + 1);
+            ++b.size;
+        } else {
+            block*const b = new block(BLOCK_SIZE);
+            b->size = BLOCK_SIZE;
+            _blocks.insert(_blocks.begin(), b);
+            _front = BLOCK_SIZE - 1;
+        }
+        _blocks.front()->elems[_front] = x;
+        ++_size;
+    }
+
+    void pop_back() {
+        --_blocks.back()->size;
+        --_size;
+        if (_blocks.back()->size == 0 || _size == 0) {
+            delete _blocks.back();
+            _blocks.pop_back();
+            if (_blocks.empty()) _front = 0;
+        }
+    }
+
+    /**
+     * @brief grows or shrinks at the back. New elements are x.
+     */
+    void resize(size_t n, const T & x = T()) {
+        while (_size > n) {
+            // drop whole blocks where possible
+            block & b = *_blocks.back();
+            const size_t inblock = (_blocks.size() == 1) ? b.size - _front : b.size;
+            if (_size - n >= inblock) {
+                _size -= inblock;
+                delete _blocks.back();
+                _blocks.pop_back();
+                if (_blocks.empty()) _front = 0;
+            } else {
+                b.size -= _size - n;
+                _size = n;
+            }
+        }
+        while (_size < n) {
+            block*const b = _back_with_space(n - _size);
+            const size_t add = std::min(b->cap - b->size, n - _size);
+            std::fill(b->elems + b->size, b->elems + b->size + add, x);
+            b->size += add;
+            _size += add;
+        }
+    }
+
+    void clear() {
+        for (typename blocklist::iterator it = _blocks.begin(); it != _blocks.end(); ++it) {
+            delete *it;
+        }
+        _blocks.clear();
+        _front = 0;
+        _size = 0;
+    }
+
+    void swap(SegmentedVector & other) {
+        _blocks.swap(other._blocks);
+        std::swap(_front, other._front);
+        std::swap(_size, other._size);
+    }
+
+    bool operator==(const SegmentedVector & other) const {
+        return _size == other._size && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const SegmentedVector & other) const {
+        return !(*this == other);
+    }
+
+private:
+    /**
+     * @brief plain array instead of std::vector, because std::vector<bool> has no T& to hand out
+     */
+    struct block {
+        T*     elems;
+        size_t size;
+        size_t cap;
+
+        explicit block(size_t c) : elems(new T[c]), size(0), cap(c) {}
+        ~block() { delete [] elems; }
+
+        void grow(size_t c) {
+            T*const e = new T[c];
+            std::copy(elems, elems + size, e);
+            delete [] elems;
+            elems = e;
+            cap = c;
+        }
+
+    private:
+        block(const block &);
+        block& operator=(const block &);
+    };
+    typedef std::vector<block*> blocklist;
+
+    /**
+     * @brief the last block, or a new one if it is full
+     * @param want how many elements are about to be added
+     */
+    block* _back_with_space(size_t want = 1) {
+        if (_blocks.empty() || _blocks.back()->size == BLOCK_SIZE) {
+            // only the first block starts small
+            const size_t c = (_blocks.empty() && want < BLOCK_SIZE) ? std::max(want, (size_t)16) : BLOCK_SIZE;
+            _blocks.push_back(new block(c));
+        } else if (_blocks.back()->size == _blocks.back()->cap) {
+            block & b = *_blocks.back();
+            b.grow(std::min(std::max(2*b.cap, b.size + want), BLOCK_SIZE));
+        }
+        return _blocks.back();
+    }
+
+    blocklist _blocks;
+    size_t    _front; ///< unused elements at the front of the first block
+    size_t    _size;
+};
+
+// std::min/max take them by reference
+template <typename T> const unsigned int SegmentedVector<T>::BLOCK_BITS;
+template <typename T> const size_t       SegmentedVector<T>::BLOCK_SIZE;
+
+#endif // SEGMENTEDVECTOR_H
@@ -0,0 +1,307 @@
+/**
+ * @file summarypyramid.h
+ * @brief Block-wise min/max/sum of a series, for statistics over any range in O(log n)
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef SUMMARYPYRAMID_H
+#define SUMMARYPYRAMID_H
+
+#include <stddef.h>
+#include <vector>
+#include <math.h>
+#include "segmentedvector.h"
+
+/**
+ * @brief summaries of a timeseries at several resolutions. Level 0 summarizes LEAF_SIZE samples
+ * per entry, and every level above FANOUT entries of the one below, up to a single entry.
+ * A range of samples is then covered by at most 2*LEAF_SIZE samples at its ends and 2*FANOUT
+ * entries per level.
+ *
+ * Each summary also says where its min and max are, the earliest one on ties.
+ *
+ * Besides, it can keep prefix sums of the values and their squares, so that the sums over any range
+ * cost O(1). They skip values which are not finite, and count the others. They are taken relative
+ * to the first finite value, which keeps the differences of large sums precise when the values
+ * have a large offset. Since they take as much memory as the samples, they are only built on
+ * request, with update_sums().
+ *
+ * The owner says which samples changed with invalidate(), and calls update() or update_sums()
+ * before reading. Only what changed is recomputed, so appending costs O(1) amortized.
+ */
+template <typename T>
+class SummaryPyramid {
+public:
+    static const unsigned int LEAF_BITS = 6;
+    static const size_t       LEAF_SIZE = ((size_t)1) << LEAF_BITS;
+    static const unsigned int FANOUT_BITS = 3;
+    static const size_t       FANOUT = ((size_t)1) << FANOUT_BITS;
+    static const size_t       NONE = (size_t)-1;
+
+    typedef struct {
+        double       min;
+        double       max;
+        size_t       k_min; ///< index of the sample with the min; NONE if there is none (no samples, or all NAN)
+        size_t       k_max; ///< index of the sample with the max
+        double       sum;
+        double       sqsum;
+        unsigned int count;
+        double       t_first;
+        double       t_last;
+    } summary_t;
+
+    SummaryPyramid() : _valid(0), _valid_sums(0), _have_ref(false), _ref(0.) {}
+
+    /**
+     * @brief summary of nothing, to start with
+     */
+    static summary_t empty() {
+        summary_t s;
+        s.min = INFINITY;
+        s.max = -INFINITY;
+        s.k_min = s.k_max = NONE;
+        s.sum = 0.;
+        s.sqsum = 0.;
+        s.count = 0;
+        s.t_first = INFINITY;
+        s.t_last = -INFINITY;
+        return s;
+    }
+
+    static void add(summary_t & s, size_t k, double t, double val) {
+        if (val < s.min || (val == s.min && k < s.k_min)) {
+            s.min = val;
+            s.k_min = k;
+        }
+        if (val > s.max || (val == s.max && k < s.k_max)) {
+            s.max = val;
+            s.k_max = k;
+        }
+        s.sum += val;
+        s.sqsum += val*val;
+        s.count++;
+        if (t < s.t_first) s.t_first = t;
+        if (t > s.t_last) s.t_last = t;
+    }
+
+    static void add(summary_t & s, const summary_t & other) {
+        if (other.min < s.min || (other.min == s.min && other.k_min < s.k_min)) {
+            s.min = other.min;
+            s.k_min = other.k_min;
+        }
+        if (other.max > s.max || (other.max == s.max && other.k_max < s.k_max)) {
+            s.max = other.max;
+            s.k_max = other.k_max;
+        }
+        s.sum += other.sum;
+        s.sqsum += other.sqsum;
+        s.count += other.count;
+        if (other.t_first < s.t_first) s.t_first = other.t_first;
+        if (other.t_last > s.t_last) s.t_last = other.t_last;
+    }
+
+    /**
+     * @brief samples from index k on have changed or moved
+     */
+    void invalidate(size_t k = 0) {
+        if (k < _valid) _valid = k;
+        if (k < _valid_sums) _valid_sums = k;
+    }
+
+    void clear() {
+        _levels.clear();
+        _prefix.clear();
+        _valid = 0;
+        _valid_sums = 0;
+        _have_ref = false;
+    }
+
+    /**
+     * @brief all times were shifted by dt
+     */
+    void shift_time(double dt) {
+        if (dt == 0.) return;
+        for (size_t l=0; l < _levels.size(); ++l) {
+            for (size_t k=0; k < _levels[l].size(); ++k) {
+                _levels[l][k].t_first += dt;
+                _levels[l][k].t_last += dt;
+            }
+        }
+    }
+
+    /**
+     * @brief recomputes what changed since the last call
+     */
+    void update(const SegmentedVector<double> & time, const SegmentedVector<T> & data) {
+        const size_t n = time.size();
+        if (_valid > n) _valid = n;
+        if (n == 0) {
+            clear();
+            return;
+        }
+        if (_valid == n && !_levels.empty() && _levels.back().size() == 1) return;
+
+        // leaves
+        if (_levels.empty()) _levels.resize(1);
+        size_t first = _valid >> LEAF_BITS;
+        size_t size = (n + LEAF_SIZE - 1) >> LEAF_BITS;
+        _levels[0].resize(size);
+        for (size_t k=first; k < size; ++k) {
+            summary_t s = empty();
+            const size_t end = std::min((k + 1) << LEAF_BITS, n);
+            for (size_t j=k << LEAF_BITS; j < end; ++j) {
+                add(s, j, time[j], (double)data[j]);
+            }
+            _levels[0][k] = s;
+        }
+
+        // levels above, until there is only one entry
+        size_t l = 0;
+        while (size > 1) {
+            first >>= FANOUT_BITS;
+            const size_t below = size;
+            size = (size + FANOUT - 1) >> FANOUT_BITS;
+            if (_levels.size() < l + 2) _levels.resize(l + 2);
+            _levels[l + 1].resize(size);
+            for (size_t k=first; k < size; ++k) {
+                summary_t s = empty();
+                const size_t end = std::min((k + 1) << FANOUT_BITS, below);
+                for (size_t j=k << FANOUT_BITS; j < end; ++j) {
+                    add(s, _levels[l][j]);
+                }
+                _levels[l + 1][k] = s;
+            }
+            ++l;
+        }
+        _levels.resize(l + 1);
+        _valid = n;
+    }
+
+    /**
+     * @brief brings the prefix sums up to date, see sums()
+     */
+    void update_sums(const SegmentedVector<T> & data) {
+        const size_t n = data.size();
+        if (_valid_sums > n) _valid_sums = n;
+        if (_valid_sums == n && _prefix.size() == n + 1) return;
+
+        if (_valid_sums == 0) {
+            _have_ref = false;
+            _ref = 0.;
+        }
+        _prefix.resize(n + 1);
+        _prefix[0] = prefix_t();
+        for (size_t k=_valid_sums; k < n; ++k) {
+            prefix_t p = _prefix[k];
+            const double val = (double)data[k];
+            if (!isnan(val) && !isinf(val)) {
+                // all before were skipped, so the sums are still zero when the reference is set
+                if (!_have_ref) {
+                    _ref = val;
+                    _have_ref = true;
+                }
+                const double d = val - _ref;
+                p.sum += d;
+                p.sqsum += d*d;
+                p.count++;
+            }
+            _prefix[k + 1] = p;
+        }
+        _valid_sums = n;
+    }
+
+    /**
+     * @brief summary of the samples [first, end), O(log n). Only valid after update().
+     */
+    summary_t summarize(const SegmentedVector<double> & time, const SegmentedVector<T> & data, size_t first, size_t end) const {
+        summary_t s = empty();
+        if (end > _valid) end = _valid;
+
+        // single samples up to the leaves
+        while (first < end && (first & (LEAF_SIZE - 1))) {
+            add(s, first, time[first], (double)data[first]);
+            ++first;
+        }
+        while (end > first && (end & (LEAF_SIZE - 1))) {
+            --end;
+            add(s, end, time[end], (double)data[end]);
+        }
+
+        // whole entries, going up as soon as there are FANOUT of them
+        size_t lo = first >> LEAF_BITS, hi = end >> LEAF_BITS;
+        for (size_t l=0; lo < hi && l < _levels.size(); ++l) {
+            while (lo < hi && (lo & (FANOUT - 1))) add(s, _levels[l][lo++]);
+            while (hi > lo && (hi & (FANOUT - 1))) add(s, _levels[l][--hi]);
+            lo >>= FANOUT_BITS;
+            hi >>= FANOUT_BITS;
+        }
+        return s;
+    }
+
+    /**
+     * @brief sums of the finite samples in [first, end) and of their squares, both minus get_ref(),
+     * and how many there are, O(1). Only valid after update_sums().
+     */
+    void sums(size_t first, size_t end, double & sum, double & sqsum, unsigned int & count) const {
+        if (end > _valid_sums) end = _valid_sums;
+        if (end <= first) {
+            sum = sqsum = 0.;
+            count = 0;
+            return;
+        }
+        sum = _prefix[end].sum - _prefix[first].sum;
+        sqsum = _prefix[end].sqsum - _prefix[first].sqsum;
+        count = _prefix[end].count - _prefix[first].count;
+    }
+
+    /**
+     * @brief what sums() is relative to
+     */
+    double get_ref() const {
+        return _ref;
+    }
+
+private:
+    /**
+     * @brief the finite samples before some index
+     */
+    struct prefix_t {
+        double       sum;   ///< of value-_ref
+        double       sqsum; ///< of (value-_ref)^2
+        unsigned int count;
+        prefix_t() : sum(0.), sqsum(0.), count(0) {}
+    };
+
+    std::vector<std::vector<summary_t> > _levels;     ///< [0] are the leaves
+    size_t                               _valid;      ///< how many samples the leaves cover correctly
+    size_t                               _valid_sums; ///< same for _prefix
+    bool                                 _have_ref;   ///< whether there was a finite value for _ref yet
+    double                               _ref;        ///< the first finite value
+    SegmentedVector<prefix_t>            _prefix;     ///< [k] is of the samples before k; empty until update_sums()
+};
+
+// std::min/max take them by reference
+template <typename T> const unsigned int SummaryPyramid<T>::LEAF_BITS;
+template <typename T> const size_t       SummaryPyramid<T>::LEAF_SIZE;
+template <typename T> const unsigned int SummaryPyramid<T>::FANOUT_BITS;
+template <typename T> const size_t       SummaryPyramid<T>::FANOUT;
+template <typename T> const size_t       SummaryPyramid<T>::NONE;
+
+#endif // SUMMARYPYRAMID_H
@@ -0,0 +1,185 @@
+/**
+ * @file texttokenizer.cpp
+ * @brief Splits a text (log)file into lines and fields without copying them
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "texttokenizer.h"
+
+using namespace std;
+
+// exactly representable as double
+static const double POW10[] = {1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9, 1E10,
+                               1E11, 1E12, 1E13, 1E14, 1E15};
+static const int MAX_EXACT_DIGITS = 15; ///< mantissa stays below 2^53
+
+// like isspace() in the C locale, but without a library call per character
+static inline bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+void TextTokenizer::reset(ByteSource *src) {
+    _src = src;
+    _span = NULL;
+    _span_len = _span_pos = 0;
+    _carry.clear();
+}
+
+bool TextTokenizer::at_end(void) const {
+    if (!_src || !_src->valid) return true;
+    return _span_pos >= _span_len && _src->get_position() >= _src->get_size();
+}
+
+const char* TextTokenizer::_read_line(size_t &len) {
+    _carry.clear(); // the previous line is not needed anymore
+    if (!_src || !_src->valid) return NULL;
+
+    for (;;) {
+        if (_span_pos < _span_len) {
+            const char*const start = (const char*) _span + _span_pos;
+            const size_t avail = _span_len - _span_pos;
+            const char*const eol = (const char*) memchr(start, _line_sep, avail);
+            if (eol) {
+                const size_t n = eol - start;
+                _span_pos += n + 1;
+                if (_carry.empty()) {
+                    // usual case, and always with mmap: the whole line in the current span
+                    len = n;
+                    return start;
+                }
+                _carry.insert(_carry.end(), start, eol);
+                len = _carry.size();
+                return &_carry[0];
+            }
+            _carry.insert(_carry.end(), start, start + avail);
+            _span_pos = _span_len;
+        }
+        if (!_src->next_span(_span, _span_len)) {
+            _span_len = _span_pos = 0;
+            if (_carry.empty()) return NULL;
+            // last line without line end
+            len = _carry.size();
+            return &_carry[0];
+        }
+        _span_pos = 0;
+    }
+}
+
+void TextTokenizer::_split(const char *line, size_t len, std::vector<field_t> &fields) const {
+    fields.clear();
+    const char*p = line;
+    const char*const end = line + len;
+    for (;;) {
+        const char*const sep = (const char*) memchr(p, _field_sep, end - p);
+        field_t f;
+        f.str = p;
+        f.len = (unsigned int)((sep ? sep : end) - p);
+        fields.push_back(f);
+        if (!sep) break;
+        p = sep + 1;
+    }
+}
+
+bool TextTokenizer::next_line(std::vector<field_t> &fields) {
+    size_t len;
+    const char*line;
+    while (NULL != (line = _read_line(len))) {
+        if (len > 0 && line[len - 1] == '\r') --len;
+        if (len == 0) continue;
+        _split(line, len, fields);
+        return true;
+    }
+    fields.clear();
+    return false;
+}
+
+TextTokenizer::field_t TextTokenizer::trim(const field_t &f) {
+    field_t r = f;
+    while (r.len > 0 && is_space(r.str[0])) {
+        ++r.str;
+        --r.len;
+    }
+    while (r.len > 0 && is_space(r.str[r.len - 1])) --r.len;
+    return r;
+}
+
+bool TextTokenizer::equals(const field_t &f, const char *s) {
+    const size_t n = strlen(s);
+    return n == f.len && 0 == memcmp(f.str, s, n);
+}
+
+double TextTokenizer::to_double(const field_t &f) {
+    const char*p = f.str;
+    const char*const end = f.str + f.len;
+    while (p < end && is_space(*p)) ++p;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        ++p;
+    }
+    uint64_t mant = 0;
+    int digits = 0;
+    int decimals = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        mant = mant*10 + (*p++ - '0');
+        ++digits;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            mant = mant*10 + (*p++ - '0');
+            ++digits;
+            ++decimals;
+        }
+    }
+    while (p < end && is_space(*p)) ++p;
+    if (p == end && digits > 0 && digits <= MAX_EXACT_DIGITS) {
+        // both exact, so the quotient is rounded correctly, just like strtod() does
+        const double v = ((double) mant) / POW10[decimals];
+        return neg ? -v : v;
+    }
+
+    // exponents, nan, very long numbers, garbage...
+    char buf[64];
+    if (f.len < sizeof(buf)) {
+        memcpy(buf, f.str, f.len);
+        buf[f.len] = 0;
+        return strtod(buf, NULL);
+    }
+    return strtod(to_string(f).c_str(), NULL);
+}
+
+int64_t TextTokenizer::to_int(const field_t &f) {
+    const char*p = f.str;
+    const char*const end = f.str + f.len;
+    while (p < end && is_space(*p)) ++p;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        ++p;
+    }
+    uint64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v*10 + (*p++ - '0');
+    }
+    return neg ? -(int64_t) v : (int64_t) v;
+}
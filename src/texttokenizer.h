@@ -0,0 +1,105 @@
+/**
+ * @file texttokenizer.h
+ * @brief Splits a text (log)file into lines and fields without copying them
+ * @author Martin Becker <becker@rcs.ei.tum.de>
+ * @date 18.10.2026
+
+    This file is part of MavLogAnalyzer, Copyright 2014 by Martin Becker.
+
+    MavLogAnalyzer is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef TEXTTOKENIZER_H
+#define TEXTTOKENIZER_H
+
+#include <stddef.h>
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include "bytesource.h"
+
+/**
+ * @brief reads a ByteSource line by line and splits each line at a separator.
+ * The fields point right into the source (always the case with mmap), or into an
+ * internal buffer if a line crosses the end of a span. Nothing is allocated per line
+ * once the field vector has grown to the widest line.
+ * There is no quoting; a trailing CR is removed from each line, and empty lines are skipped.
+ */
+class TextTokenizer {
+public:
+    /**
+     * @brief a view on a piece of a line; not terminated
+     */
+    typedef struct {
+        const char*  str;
+        unsigned int len;
+    } field_t;
+
+    TextTokenizer(char field_sep = ',', char line_sep = '\n') :
+        _field_sep(field_sep), _line_sep(line_sep), _src(NULL), _span(NULL), _span_len(0), _span_pos(0) {}
+
+    /**
+     * @brief start at the beginning of the given source; does not take ownership
+     */
+    void reset(ByteSource*src);
+
+    /**
+     * @brief split the next line
+     * @param fields overwritten; valid until the next call
+     * @return false if there are no more lines
+     */
+    bool next_line(std::vector<field_t> & fields);
+
+    bool at_end(void) const;
+
+    /*******************
+     * FIELD HELPERS
+     *******************/
+    /**
+     * @brief without leading and trailing whitespace
+     */
+    static field_t trim(const field_t & f);
+
+    static bool equals(const field_t & f, const char*s);
+
+    static std::string to_string(const field_t & f) { return std::string(f.str, f.len); }
+
+    /**
+     * @brief like atof(), but without copying the field. Plain decimals are converted
+     * exactly in place; everything else goes through strtod().
+     */
+    static double to_double(const field_t & f);
+
+    /**
+     * @brief like atoll(): leading whitespace and sign, then digits up to the first non-digit
+     */
+    static int64_t to_int(const field_t & f);
+
+    static uint64_t to_uint(const field_t & f) { return (uint64_t) to_int(f); }
+
+private:
+    const char* _read_line(size_t & len);
+    void _split(const char*line, size_t len, std::vector<field_t> & fields) const;
+
+    char                _field_sep;
+    char                _line_sep;
+    ByteSource*         _src;
+    const uint8_t*      _span;
+    size_t              _span_len;
+    size_t              _span_pos;
+    std::vector<char>   _carry; ///< for lines crossing the end of a span
+};
+
+#endif // TEXTTOKENIZER_H
@@ -440,8 +440,12 @@ double get_time_secs(void) {
 
 struct tm epoch_to_tm(double epoch_sec) {
     time_t epoch_sec_t = (time_t) round(epoch_sec);
-    struct tm * ltime = localtime(&epoch_sec_t);///< not thread safe
-    struct tm ret  = *ltime; // deep copy
+    struct tm ret;
+#if defined(WIN32) || defined(__WIN32) || defined(__WIN32__)
+    ret = *localtime(&epoch_sec_t); // msvcrt keeps the buffer per thread
+#else
+    localtime_r(&epoch_sec_t, &ret); // reentrant, parsers can run in threads
+#endif
     return ret;
 }
 